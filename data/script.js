@@ -6,6 +6,17 @@
 // State
 let currentConfig = {};
 let statusInterval = null;
+let liveSocket = null;
+let liveFrame = null;
+
+// Status is polled less often while runs are pushed over the live socket
+const STATUS_POLL_MS = 5000;
+const STATUS_POLL_LIVE_MS = 30000;
+const LIVE_RECONNECT_MS = 5000;
+const LIVE_FRAME_MAGIC = 0x3156494C;    // "LIV1", LiveFrameHeader in web_server.h
+const LIVE_HEADER_BYTES = 96;
+const LIVE_AXIS_COLORS = ['#ef4444', '#22c55e', '#3b82f6'];
+const TRIGGER_NAMES = ['external', 'threshold', 'change'];
 
 // DOM Elements
 const elements = {
@@ -21,6 +32,13 @@ const elements = {
     influxStatus: document.getElementById('influx-status'),
     freeHeap: document.getElementById('free-heap'),
 
+    // Live view
+    liveStatus: document.getElementById('live-status'),
+    liveRun: document.getElementById('live-run'),
+    liveChart: document.getElementById('live-chart'),
+    liveLog: document.getElementById('live-log'),
+    liveFeatures: document.getElementById('live-features'),
+
     // WiFi
     wifiSsid: document.getElementById('wifi-ssid'),
     wifiPassword: document.getElementById('wifi-password'),
@@ -30,6 +48,8 @@ const elements = {
     influxToken: document.getElementById('influx-token'),
     influxOrg: document.getElementById('influx-org'),
     influxBucket: document.getElementById('influx-bucket'),
+    influxGzip: document.getElementById('influx-gzip'),
+    spectrumFormat: document.getElementById('spectrum-format'),
 
     // Operation
     operationId: document.getElementById('operation-id'),
@@ -37,6 +57,9 @@ const elements = {
     // Hardware
     plcTriggerPin: document.getElementById('plc-trigger-pin'),
     spiCsPin: document.getElementById('spi-cs-pin'),
+    adxlIntPin: document.getElementById('adxl-int-pin'),
+    sensorCount: document.getElementById('sensor-count'),
+    auxCsPins: document.getElementById('aux-cs-pins'),
 
     // Sensor
     sensitivity: document.getElementById('sensitivity'),
@@ -44,8 +67,30 @@ const elements = {
     // Sampling
     sampleCount: document.getElementById('sample-count'),
     sampleRate: document.getElementById('sample-rate'),
+    decimation: document.getElementById('decimation'),
     filterCutoff: document.getElementById('filter-cutoff'),
+    filterMode: document.getElementById('filter-mode'),
+    pretrigger: document.getElementById('pretrigger'),
     sendTimeDomain: document.getElementById('send-time-domain'),
+    useFifo: document.getElementById('use-fifo'),
+    rawCapture: document.getElementById('raw-capture'),
+    welchSegment: document.getElementById('welch-segment'),
+    welchOverlap: document.getElementById('welch-overlap'),
+    zoomFactor: document.getElementById('zoom-factor'),
+    zoomCenter: document.getElementById('zoom-center'),
+    sendFeatures: document.getElementById('send-features'),
+    sendSpectrum: document.getElementById('send-spectrum'),
+    baselineAlpha: document.getElementById('baseline-alpha'),
+    changesOnly: document.getElementById('changes-only'),
+    changeThreshold: document.getElementById('change-threshold'),
+    bandEdges: document.getElementById('band-edges'),
+
+    // Monitoring
+    continuousMode: document.getElementById('continuous-mode'),
+    eventRms: document.getElementById('event-rms'),
+    eventChange: document.getElementById('event-change'),
+    heartbeat: document.getElementById('heartbeat'),
+    health: document.getElementById('health'),
 
     // Buttons
     btnSave: document.getElementById('btn-save'),
@@ -60,15 +105,160 @@ document.addEventListener('DOMContentLoaded', () => {
     updateStatus();
 
     // Update status every 5 seconds
-    statusInterval = setInterval(updateStatus, 5000);
+    setStatusPolling(STATUS_POLL_MS);
+    connectLive();
 
     // Event listeners
     elements.btnSave.addEventListener('click', saveConfig);
     elements.btnTestInflux.addEventListener('click', testInfluxConnection);
     elements.btnTrigger.addEventListener('click', manualTrigger);
     elements.btnReset.addEventListener('click', factoryReset);
+    elements.liveLog.addEventListener('change', () => drawLiveChart(liveFrame));
+    window.addEventListener('resize', () => drawLiveChart(liveFrame));
 });
 
+// (Re)start status polling
+function setStatusPolling(intervalMs) {
+    if (statusInterval) clearInterval(statusInterval);
+    statusInterval = setInterval(updateStatus, intervalMs);
+}
+
+// Live view: binary frames pushed after each run
+function connectLive() {
+    const scheme = location.protocol === 'https:' ? 'wss' : 'ws';
+    liveSocket = new WebSocket(`${scheme}://${location.host}/ws/live`);
+    liveSocket.binaryType = 'arraybuffer';
+
+    liveSocket.onopen = () => {
+        elements.liveStatus.textContent = 'Live';
+        elements.liveStatus.className = 'live-status ok';
+        setStatusPolling(STATUS_POLL_LIVE_MS);
+    };
+
+    liveSocket.onclose = () => {
+        elements.liveStatus.textContent = 'Disconnected, retrying...';
+        elements.liveStatus.className = 'live-status error';
+        setStatusPolling(STATUS_POLL_MS);
+        setTimeout(connectLive, LIVE_RECONNECT_MS);
+    };
+
+    liveSocket.onmessage = (event) => {
+        if (!(event.data instanceof ArrayBuffer)) return;
+        const frame = parseLiveFrame(event.data);
+        if (!frame) return;
+        liveFrame = frame;
+        showLiveFrame(frame);
+    };
+}
+
+// Decode a LiveFrameHeader plus the three uint16 magnitude arrays
+function parseLiveFrame(buffer) {
+    if (buffer.byteLength < LIVE_HEADER_BYTES) return null;
+    const view = new DataView(buffer);
+    if (view.getUint32(0, true) !== LIVE_FRAME_MAGIC) return null;
+
+    const bins = view.getUint16(10, true);
+    if (buffer.byteLength < LIVE_HEADER_BYTES + 3 * bins * 2) return null;
+
+    const frame = {
+        sequence: view.getUint32(4, true),
+        sensor: view.getUint8(8),
+        reason: view.getUint8(9),
+        bins,
+        startHz: view.getFloat32(12, true),
+        binHz: view.getFloat32(16, true),
+        odrHz: view.getFloat32(20, true),
+        features: [],
+        spectra: []
+    };
+
+    for (let a = 0; a < 3; a++) {
+        const f = [];
+        for (let k = 0; k < 5; k++) {
+            f.push(view.getFloat32(24 + (a * 5 + k) * 4, true));
+        }
+        frame.features.push(f);
+
+        const scale = view.getFloat32(84 + a * 4, true);
+        const values = new Float32Array(bins);
+        const offset = LIVE_HEADER_BYTES + a * bins * 2;
+        for (let i = 0; i < bins; i++) {
+            values[i] = view.getUint16(offset + i * 2, true) * scale;
+        }
+        frame.spectra.push(values);
+    }
+    return frame;
+}
+
+function showLiveFrame(frame) {
+    const trigger = TRIGGER_NAMES[frame.reason] || 'unknown';
+    elements.liveRun.textContent =
+        `Run ${frame.sequence}, sensor ${frame.sensor}, ${trigger}, ${frame.odrHz.toFixed(1)} Hz`;
+
+    elements.liveFeatures.innerHTML = '';
+    ['X', 'Y', 'Z'].forEach((axis, a) => {
+        const f = frame.features[a];
+        const row = document.createElement('tr');
+        row.innerHTML = `<th style="color:${LIVE_AXIS_COLORS[a]}">${axis}</th>` +
+            `<td>${f[0].toFixed(4)}</td><td>${f[1].toFixed(4)}</td><td>${f[2].toFixed(2)}</td>` +
+            `<td>${f[3].toFixed(2)}</td><td>${f[4].toFixed(2)}</td>`;
+        elements.liveFeatures.appendChild(row);
+    });
+
+    drawLiveChart(frame);
+}
+
+function drawLiveChart(frame) {
+    const canvas = elements.liveChart;
+    const ctx = canvas.getContext('2d');
+
+    // Match the backing store to the displayed size
+    const ratio = window.devicePixelRatio || 1;
+    canvas.width = canvas.clientWidth * ratio;
+    canvas.height = canvas.clientHeight * ratio;
+    ctx.setTransform(ratio, 0, 0, ratio, 0, 0);
+
+    const width = canvas.clientWidth;
+    const height = canvas.clientHeight;
+    const pad = { left: 8, right: 8, top: 8, bottom: 18 };
+    ctx.clearRect(0, 0, width, height);
+    if (!frame || frame.bins === 0) return;
+
+    const logScale = elements.liveLog.checked;
+    let peak = 0;
+    frame.spectra.forEach(values => values.forEach(v => { if (v > peak) peak = v; }));
+    if (peak <= 0) return;
+
+    // Log scale spans 80 dB below the peak
+    const floor = peak * 1e-4;
+    const yOf = (v) => {
+        const t = logScale ? Math.log10(Math.max(v, floor) / floor) / 4 : v / peak;
+        return pad.top + (1 - t) * (height - pad.top - pad.bottom);
+    };
+    const xOf = (i) => pad.left + i / Math.max(frame.bins - 1, 1) * (width - pad.left - pad.right);
+
+    frame.spectra.forEach((values, a) => {
+        ctx.strokeStyle = LIVE_AXIS_COLORS[a];
+        ctx.lineWidth = 1;
+        ctx.beginPath();
+        for (let i = 0; i < frame.bins; i++) {
+            if (i === 0) ctx.moveTo(xOf(i), yOf(values[i]));
+            else ctx.lineTo(xOf(i), yOf(values[i]));
+        }
+        ctx.stroke();
+    });
+
+    // Frequency axis labels
+    const lastHz = frame.startHz + (frame.bins - 1) * frame.binHz;
+    ctx.fillStyle = '#64748b';
+    ctx.font = '10px sans-serif';
+    ctx.textAlign = 'left';
+    ctx.fillText(`${frame.startHz.toFixed(1)} Hz`, pad.left, height - 4);
+    ctx.textAlign = 'right';
+    ctx.fillText(`${lastHz.toFixed(1)} Hz`, width - pad.right, height - 4);
+    ctx.fillText(`peak ${peak.toExponential(2)} g`, width - pad.right, pad.top + 10);
+}
+
 // Show status banner
 function showBanner(message, type = 'info') {
     elements.statusBanner.className = `status-banner ${type}`;
@@ -114,18 +304,51 @@ function populateForm(config) {
     // Token not returned from API for security
     elements.influxOrg.value = config.influx_org || '';
     elements.influxBucket.value = config.influx_bucket || '';
+    elements.influxGzip.checked = config.influx_gzip || false;
+    elements.spectrumFormat.value = config.spectrum_format || 0;
 
     elements.operationId.value = config.operation_id || '';
 
     elements.plcTriggerPin.value = config.plc_trigger_pin || 4;
     elements.spiCsPin.value = config.spi_cs_pin || 5;
+    elements.adxlIntPin.value = config.adxl_int_pin ?? 16;
+    if (config.max_sensors) {
+        elements.sensorCount.max = config.max_sensors;
+    }
+    elements.sensorCount.value = config.sensor_count || 1;
+    if (Array.isArray(config.aux_cs_pins)) {
+        elements.auxCsPins.value = config.aux_cs_pins.join(',');
+    }
 
     elements.sensitivity.value = config.sensitivity || 2;
 
     elements.sampleCount.value = config.sample_count || 4000;
     elements.sampleRate.value = config.sample_rate_hz || 3200;
+    elements.decimation.value = config.decimation || 1;
     elements.filterCutoff.value = config.filter_cutoff_hz || 1600;
+    elements.filterMode.value = config.filter_mode || 0;
+    elements.pretrigger.value = config.pretrigger_pct || 0;
     elements.sendTimeDomain.checked = config.send_time_domain || false;
+    elements.useFifo.checked = config.use_fifo ?? true;
+    elements.rawCapture.checked = config.raw_capture || false;
+    elements.welchSegment.value = config.welch_segment || 0;
+    elements.welchOverlap.value = config.welch_overlap_pct ?? 50;
+    elements.zoomFactor.value = config.zoom_factor || 0;
+    elements.zoomCenter.value = config.zoom_center_hz || 0;
+    elements.sendFeatures.checked = config.send_features ?? true;
+    elements.sendSpectrum.checked = config.send_spectrum ?? true;
+    elements.baselineAlpha.value = config.baseline_alpha_pct || 0;
+    elements.changesOnly.checked = config.changes_only || false;
+    elements.changeThreshold.value = config.change_threshold_pct ?? 25;
+    if (Array.isArray(config.band_edges_hz)) {
+        elements.bandEdges.value = config.band_edges_hz.filter((e, i, a) => i === 0 || e > a[i - 1]).join(',');
+    }
+
+    elements.continuousMode.checked = config.continuous_mode || false;
+    elements.eventRms.value = config.event_rms_mg || 0;
+    elements.eventChange.value = config.event_change_pct ?? 50;
+    elements.heartbeat.value = config.heartbeat_s ?? 300;
+    elements.health.value = config.health_s ?? 300;
 }
 
 // Update status display
@@ -200,18 +423,48 @@ async function saveConfig() {
         influx_token: elements.influxToken.value,
         influx_org: elements.influxOrg.value,
         influx_bucket: elements.influxBucket.value,
+        influx_gzip: elements.influxGzip.checked,
+        spectrum_format: parseInt(elements.spectrumFormat.value),
 
         operation_id: elements.operationId.value,
 
         plc_trigger_pin: parseInt(elements.plcTriggerPin.value),
         spi_cs_pin: parseInt(elements.spiCsPin.value),
+        adxl_int_pin: parseInt(elements.adxlIntPin.value),
+        sensor_count: parseInt(elements.sensorCount.value),
+        aux_cs_pins: elements.auxCsPins.value.split(',')
+            .map(v => parseInt(v.trim()))
+            .filter(v => !isNaN(v)),
 
         sensitivity: parseInt(elements.sensitivity.value),
 
         sample_count: parseInt(elements.sampleCount.value),
         sample_rate_hz: parseInt(elements.sampleRate.value),
+        decimation: parseInt(elements.decimation.value),
         filter_cutoff_hz: parseInt(elements.filterCutoff.value),
-        send_time_domain: elements.sendTimeDomain.checked
+        filter_mode: parseInt(elements.filterMode.value),
+        pretrigger_pct: parseInt(elements.pretrigger.value),
+        send_time_domain: elements.sendTimeDomain.checked,
+        use_fifo: elements.useFifo.checked,
+        raw_capture: elements.rawCapture.checked,
+        welch_segment: parseInt(elements.welchSegment.value),
+        welch_overlap_pct: parseInt(elements.welchOverlap.value),
+        zoom_factor: parseInt(elements.zoomFactor.value),
+        zoom_center_hz: parseInt(elements.zoomCenter.value),
+        send_features: elements.sendFeatures.checked,
+        send_spectrum: elements.sendSpectrum.checked,
+        baseline_alpha_pct: parseInt(elements.baselineAlpha.value),
+        changes_only: elements.changesOnly.checked,
+        change_threshold_pct: parseInt(elements.changeThreshold.value),
+        band_edges_hz: elements.bandEdges.value.split(',')
+            .map(v => parseInt(v.trim()))
+            .filter(v => !isNaN(v)),
+
+        continuous_mode: elements.continuousMode.checked,
+        event_rms_mg: parseInt(elements.eventRms.value),
+        event_change_pct: parseInt(elements.eventChange.value),
+        heartbeat_s: parseInt(elements.heartbeat.value),
+        health_s: parseInt(elements.health.value)
     };
 
     elements.btnSave.disabled = true;
@@ -0,0 +1,91 @@
+#!/usr/bin/env python3
+"""Compare two benchmark reports and flag regressions.
+
+Reads the "BENCH {json}" lines of two serial logs from the bench
+environments (anything else in the logs is ignored) and prints each
+measurement of the baseline next to the candidate. Exits with status 1
+if any measurement got worse by more than --threshold percent.
+
+    pio run -e bench -t upload -t monitor | tee new.txt
+    python3 scripts/bench_compare.py old.txt new.txt --threshold 5
+"""
+
+import argparse
+import json
+import sys
+
+# Metric compared per suite and whether a lower value is better
+METRICS = {
+    "spi": ("us_per_frame", True),
+    "filter": ("min_cycles", True),
+    "fft": ("min_cycles", True),
+    "encode": ("mean_us", True),
+    "upload": ("kbit_per_s", False),
+    "heap": ("min_free", False),
+}
+
+# Fields that identify a measurement within its suite
+KEYS = ("op", "mode", "stage", "n", "gzip")
+
+
+def _key_value(entry, field):
+    value = entry.get(field, "")
+    if isinstance(value, bool):
+        return field if value else "plain"
+    return str(value)
+
+
+def load(path):
+    results = {}
+    with open(path, errors="replace") as f:
+        for line in f:
+            start = line.find("BENCH {")
+            if start < 0:
+                continue
+            try:
+                entry = json.loads(line[start + len("BENCH "):])
+            except json.JSONDecodeError:
+                continue
+            suite = entry.get("suite")
+            if suite not in METRICS or "skipped" in entry:
+                continue
+            key = (suite,) + tuple(_key_value(entry, k) for k in KEYS)
+            results[key] = entry
+    return results
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("baseline")
+    parser.add_argument("candidate")
+    parser.add_argument("--threshold", type=float, default=5.0,
+                        help="allowed regression in percent")
+    args = parser.parse_args()
+
+    old = load(args.baseline)
+    new = load(args.candidate)
+    regressions = 0
+
+    for key in sorted(old.keys() & new.keys()):
+        suite = key[0]
+        metric, lower_is_better = METRICS[suite]
+        a = old[key].get(metric)
+        b = new[key].get(metric)
+        if not a or b is None:
+            continue
+        change = (b - a) / a * 100.0
+        worse = change > args.threshold if lower_is_better else -change > args.threshold
+        regressions += worse
+        label = " ".join(k for k in key[1:] if k)
+        print(f"{'REGRESSION' if worse else 'ok':10} {suite:7} {label:24} "
+              f"{metric} {a} -> {b} ({change:+.1f}%)")
+
+    for key in sorted(old.keys() - new.keys()):
+        print(f"{'missing':10} {key[0]:7} {' '.join(k for k in key[1:] if k)}")
+
+    print(f"{regressions} regression(s) over {args.threshold}%")
+    return 1 if regressions else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
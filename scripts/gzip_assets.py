@@ -0,0 +1,129 @@
+#!/usr/bin/env python3
+"""Gzip the web UI for the LittleFS image and the firmware fallback page.
+
+Each file in data/ is written gzipped to the output directory, with an
+ETag (content hash) listed in etags.txt for the web server. References
+from index.html to the other files get a ?v=<hash> suffix, so those can
+be cached for good while index.html is revalidated against its ETag.
+web/fallback.html, served when no filesystem was uploaded, is compressed
+into src/fallback_page.h.
+
+Runs as a PlatformIO pre-script (extra_scripts in platformio.ini), which
+points the LittleFS image at the gzipped copy, or by hand:
+
+    python3 scripts/gzip_assets.py [--out .pio/data_gz]
+"""
+
+import argparse
+import gzip
+import hashlib
+import os
+import re
+import shutil
+
+# Text assets compressed for the browser; anything else is copied
+COMPRESS = (".html", ".js", ".css", ".svg", ".json")
+
+
+def _etag(data):
+    return hashlib.sha256(data).hexdigest()[:8]
+
+
+def _gzip(data):
+    # Fixed mtime, so unchanged files give identical images
+    return gzip.compress(data, compresslevel=9, mtime=0)
+
+
+def build_assets(data_dir, out_dir):
+    if os.path.isdir(out_dir):
+        shutil.rmtree(out_dir)
+    os.makedirs(out_dir)
+
+    names = sorted(f for f in os.listdir(data_dir)
+                   if os.path.isfile(os.path.join(data_dir, f)))
+    pages = [n for n in names if n.endswith(".html")]
+    others = [n for n in names if n not in pages]
+    etags = {}
+    total_in = total_out = 0
+
+    # Pages last, so their rewritten references hash into their ETag
+    for name in others + pages:
+        with open(os.path.join(data_dir, name), "rb") as f:
+            data = f.read()
+
+        if name in pages:
+            for ref, tag in etags.items():
+                data = re.sub(rb'((?:src|href)=")' + re.escape(ref.encode()) + rb'"',
+                              rb"\g<1>" + ref.encode() + b"?v=" + tag.encode() + b'"', data)
+
+        if not name.endswith(COMPRESS):
+            shutil.copyfile(os.path.join(data_dir, name), os.path.join(out_dir, name))
+            continue
+
+        packed = _gzip(data)
+        with open(os.path.join(out_dir, name + ".gz"), "wb") as f:
+            f.write(packed)
+        etags[name] = _etag(data)
+        total_in += len(data)
+        total_out += len(packed)
+
+    with open(os.path.join(out_dir, "etags.txt"), "w") as f:
+        for name in sorted(etags):
+            f.write(f"/{name} {etags[name]}\n")
+
+    print(f"gzip_assets: {len(etags)} file(s), {total_in} -> {total_out} bytes in {out_dir}")
+
+
+def build_fallback(source, header):
+    with open(source, "rb") as f:
+        data = f.read()
+    packed = _gzip(data)
+
+    rows = []
+    for i in range(0, len(packed), 16):
+        rows.append("    " + ", ".join(f"0x{b:02x}" for b in packed[i:i + 16]) + ",")
+    text = (
+        "// Generated by scripts/gzip_assets.py from web/fallback.html; do not edit.\n"
+        "#ifndef FALLBACK_PAGE_H\n"
+        "#define FALLBACK_PAGE_H\n\n"
+        "#include <Arduino.h>\n\n"
+        f"// Setup page served when no filesystem image was uploaded ({len(data)} bytes)\n"
+        "static const uint8_t FALLBACK_PAGE_GZ[] PROGMEM = {\n"
+        + "\n".join(rows) + "\n"
+        "};\n\n"
+        f'#define FALLBACK_PAGE_ETAG "{_etag(data)}"\n\n'
+        "#endif // FALLBACK_PAGE_H\n"
+    )
+
+    # Left alone when unchanged, so the firmware is not rebuilt
+    if os.path.exists(header):
+        with open(header) as f:
+            if f.read() == text:
+                return
+    with open(header, "w") as f:
+        f.write(text)
+    print(f"gzip_assets: {header} regenerated, {len(data)} -> {len(packed)} bytes")
+
+
+def run(project_dir, out_dir):
+    build_assets(os.path.join(project_dir, "data"), out_dir)
+    build_fallback(os.path.join(project_dir, "web", "fallback.html"),
+                   os.path.join(project_dir, "src", "fallback_page.h"))
+
+
+try:
+    Import("env")  # noqa: F821 - provided by PlatformIO (SCons)
+except NameError:
+    env = None
+
+if env is not None:
+    out = os.path.join(env.subst("$BUILD_DIR"), "data_gz")
+    run(env.subst("$PROJECT_DIR"), out)
+    env.Replace(PROJECT_DATA_DIR=out)
+elif __name__ == "__main__":
+    project = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--out", default=os.path.join(project, ".pio", "data_gz"),
+                        help="directory for the filesystem image contents")
+    args = parser.parse_args()
+    run(project, os.path.abspath(args.out))
@@ -0,0 +1,106 @@
+#!/usr/bin/env python3
+"""Minimal InfluxDB 2.x write endpoint for the upload benchmark.
+
+Accepts POST /api/v2/write (chunked or Content-Length, optionally gzip),
+answers GET /health, and discards the points. Each write is logged with
+its body size, line count and receive time, so device-side upload rates
+can be checked against what actually arrived.
+
+    python3 scripts/mock_influx.py --port 8086 [--latency-ms 20]
+"""
+
+import argparse
+import gzip
+import http.server
+import json
+import socketserver
+import time
+
+
+class Handler(http.server.BaseHTTPRequestHandler):
+    protocol_version = "HTTP/1.1"   # Keep-alive, as the firmware's sessions expect
+    latency_s = 0.0
+
+    def log_message(self, fmt, *args):
+        pass
+
+    def _read_body(self):
+        if self.headers.get("Transfer-Encoding", "").lower() == "chunked":
+            body = bytearray()
+            while True:
+                size = int(self.rfile.readline().split(b";")[0].strip(), 16)
+                if size == 0:
+                    self.rfile.readline()   # Trailer terminator
+                    return bytes(body)
+                body += self.rfile.read(size)
+                self.rfile.readline()
+        return self.rfile.read(int(self.headers.get("Content-Length", 0)))
+
+    def _reply(self, status, payload=b"", content_type="application/json"):
+        self.send_response(status)
+        self.send_header("Content-Type", content_type)
+        self.send_header("Content-Length", str(len(payload)))
+        self.end_headers()
+        self.wfile.write(payload)
+
+    def do_GET(self):
+        if self.path.startswith("/health"):
+            self._reply(200, json.dumps({"status": "pass", "name": "mock"}).encode())
+        else:
+            self._reply(404)
+
+    def do_POST(self):
+        if not self.path.startswith("/api/v2/write"):
+            self._reply(404)
+            return
+
+        start = time.monotonic()
+        wire = self._read_body()
+        elapsed_ms = (time.monotonic() - start) * 1000.0
+        body = wire
+        if self.headers.get("Content-Encoding", "").lower() == "gzip":
+            try:
+                body = gzip.decompress(wire)
+            except OSError as err:
+                self._reply(400, json.dumps({"message": f"bad gzip: {err}"}).encode())
+                return
+
+        lines = body.count(b"\n")
+        rate = len(wire) * 8 / elapsed_ms if elapsed_ms > 0 else 0.0
+        print(json.dumps({
+            "client": self.client_address[0],
+            "bytes_sent": len(wire),
+            "bytes": len(body),
+            "lines": lines,
+            "receive_ms": round(elapsed_ms, 1),
+            "kbit_per_s": round(rate, 1),
+        }), flush=True)
+
+        if self.latency_s > 0:
+            time.sleep(self.latency_s)
+        self._reply(204)
+
+
+class Server(socketserver.ThreadingMixIn, http.server.HTTPServer):
+    daemon_threads = True
+    allow_reuse_address = True
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--port", type=int, default=8086)
+    parser.add_argument("--latency-ms", type=float, default=0.0,
+                        help="delay before each write response")
+    args = parser.parse_args()
+
+    Handler.latency_s = args.latency_ms / 1000.0
+    with Server(("", args.port), Handler) as server:
+        print(f"mock InfluxDB listening on :{args.port}", flush=True)
+        try:
+            server.serve_forever()
+        except KeyboardInterrupt:
+            pass
+
+
+if __name__ == "__main__":
+    main()
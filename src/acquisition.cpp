@@ -0,0 +1,816 @@
+#include "acquisition.h"
+#include "config_manager.h"
+#include "metrics.h"
+#include <WiFi.h>
+#include <math.h>
+
+// Global instance
+Acquisition acquisition;
+
+bool Acquisition::begin(size_t framesPerRun, ADXL313* const* sensors, size_t sensorCount) {
+    _framesPerRun = framesPerRun;
+    _sensorCount = sensorCount > MAX_SENSORS ? MAX_SENSORS : sensorCount;
+    if (_sensorCount == 0) {
+        Serial.println("[Acq] No sensors!");
+        return false;
+    }
+
+    // Room for one run queued behind the one being processed, plus slack
+    // so the producer never waits on the consumer mid-run.
+    size_t capacity = framesPerRun * ACQ_QUEUED_RUNS + ACQ_RING_SLACK_FRAMES;
+    for (size_t s = 0; s < _sensorCount; s++) {
+        _channels[s].sensor = sensors[s];
+        if (!_channels[s].ring.allocate(capacity)) {
+            Serial.printf("[Acq] Ring allocation failed for sensor %d!\n", s);
+            return false;
+        }
+    }
+
+    // One run per sensor and trigger
+    if (!_runQueue) {
+        _runQueue = xQueueCreate((ACQ_QUEUED_RUNS + 1) * _sensorCount, sizeof(RunInfo));
+        if (!_runQueue) {
+            Serial.println("[Acq] Run queue allocation failed!");
+            return false;
+        }
+    }
+
+    const DeviceConfig& cfg = configManager.getConfig();
+    _decimation = constrain(cfg.decimation, 1, DECIMATION_MAX);
+    _sensorRateHz = ADXL313::rateHzForCode(ADXL313::rateCodeForHz(cfg.sample_rate_hz));
+
+    // Always-armed history for the pre-trigger share of each run, plus
+    // room for the frames drained before the task sees the trigger.
+    // Histories hold sensor frames, before decimation.
+    uint8_t prePct = cfg.pretrigger_pct > PRETRIGGER_MAX_PCT ? PRETRIGGER_MAX_PCT : cfg.pretrigger_pct;
+    _preFrames = framesPerRun * _decimation * prePct / 100;
+    if (_preFrames > 0) {
+        _historySize = _preFrames + PRETRIGGER_MARGIN_FRAMES;
+        for (size_t s = 0; s < _sensorCount && _preFrames > 0; s++) {
+            if (!_channels[s].history) {
+                _channels[s].history = (RawFrame*)malloc(_historySize * sizeof(RawFrame));
+            }
+            if (!_channels[s].history) {
+                Serial.println("[Acq] Pre-trigger history allocation failed, pre-trigger off");
+                _preFrames = 0;
+            }
+        }
+    }
+
+    if (!_timingQueue) {
+        _timingQueue = xQueueCreate((ACQ_QUEUED_RUNS + 1) * _sensorCount, sizeof(RunTiming));
+        if (!_timingQueue) {
+            Serial.println("[Acq] Timing queue allocation failed!");
+            return false;
+        }
+    }
+
+    if (!_heartbeatQueue) {
+        _heartbeatQueue = xQueueCreate(1, sizeof(MonitorSummary));
+        if (!_heartbeatQueue) {
+            Serial.println("[Acq] Heartbeat queue allocation failed!");
+            return false;
+        }
+    }
+
+    if (!_task) {
+        BaseType_t ok = xTaskCreatePinnedToCore(_taskEntry, "acq", ACQ_TASK_STACK, this,
+                                                ACQ_TASK_PRIORITY, &_task, ACQ_TASK_CORE);
+        if (ok != pdPASS) {
+            Serial.println("[Acq] Task creation failed!");
+            _task = nullptr;
+            return false;
+        }
+    }
+
+    Serial.printf("[Acq] %d sensor(s), ring: %d frames (%d bytes) each, task on core %d\n",
+                  _sensorCount, capacity, capacity * sizeof(RawFrame), ACQ_TASK_CORE);
+    if (_decimation > 1) {
+        Serial.printf("[Acq] Decimating by %d\n", _decimation);
+    }
+    return true;
+}
+
+void Acquisition::setTriggerSource(bool (*takeTrigger)()) {
+    _takeTrigger = takeTrigger;
+}
+
+void IRAM_ATTR Acquisition::markTrigger() {
+    _edgeUs = esp_timer_get_time();
+}
+
+void Acquisition::wake() {
+    if (_task) {
+        xTaskNotifyGive(_task);
+    }
+}
+
+void IRAM_ATTR Acquisition::wakeFromISR() {
+    if (_task) {
+        BaseType_t woken = pdFALSE;
+        vTaskNotifyGiveFromISR(_task, &woken);
+        if (woken) {
+            portYIELD_FROM_ISR();
+        }
+    }
+}
+
+bool Acquisition::waitForRun(RunInfo& run, uint32_t timeoutMs) {
+    _consumer = xTaskGetCurrentTaskHandle();
+    if (!_runQueue) {
+        vTaskDelay(pdMS_TO_TICKS(timeoutMs));
+        return false;
+    }
+    return xQueueReceive(_runQueue, &run, pdMS_TO_TICKS(timeoutMs)) == pdTRUE;
+}
+
+size_t Acquisition::peekFrames(uint8_t sensor, const RawFrame** frames, uint32_t timeoutMs) {
+    if (sensor >= _sensorCount) {
+        return 0;
+    }
+    SpscRing<RawFrame>& ring = _channels[sensor].ring;
+    size_t n = ring.readRegion(frames);
+    if (n == 0) {
+        // Producer notifies after every commit
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(timeoutMs));
+        n = ring.readRegion(frames);
+    }
+    return n;
+}
+
+void Acquisition::consumeFrames(uint8_t sensor, size_t count) {
+    if (sensor < _sensorCount) {
+        _channels[sensor].ring.consume(count);
+    }
+}
+
+bool Acquisition::takeTiming(const RunInfo& run, RunTiming& timing, uint32_t timeoutMs) {
+    if (!_timingQueue) {
+        return false;
+    }
+    TickType_t deadline = xTaskGetTickCount() + pdMS_TO_TICKS(timeoutMs);
+    for (;;) {
+        TickType_t now = xTaskGetTickCount();
+        TickType_t wait = (int32_t)(deadline - now) > 0 ? deadline - now : 0;
+        if (xQueueReceive(_timingQueue, &timing, wait) != pdTRUE) {
+            return false;
+        }
+        if (timing.sequence == run.sequence && timing.sensor == run.sensor) {
+            return true;
+        }
+    }
+}
+
+bool Acquisition::takeHeartbeat(MonitorSummary& summary) {
+    return _heartbeatQueue && xQueueReceive(_heartbeatQueue, &summary, 0) == pdTRUE;
+}
+
+const char* Acquisition::reasonName(uint8_t reason) {
+    switch (reason) {
+        case TRIGGER_THRESHOLD: return "threshold";
+        case TRIGGER_CHANGE:    return "change";
+        default:                return "external";
+    }
+}
+
+uint32_t Acquisition::getDroppedTriggers() const {
+    return _droppedTriggers;
+}
+
+bool Acquisition::isCapturing() const {
+    return _capturing;
+}
+
+void Acquisition::_notifyConsumer() {
+    if (_consumer) {
+        xTaskNotifyGive(_consumer);
+    }
+}
+
+void Acquisition::_taskEntry(void* arg) {
+    static_cast<Acquisition*>(arg)->_run();
+}
+
+void Acquisition::_run() {
+    for (;;) {
+        DeviceConfig& cfg = configManager.getConfig();
+        uint8_t reason = TRIGGER_EXTERNAL;
+        int64_t edgeUs = 0;
+        bool streaming = _streaming(cfg);
+
+        if (streaming) {
+            if (!_stream(cfg, reason, edgeUs)) {
+                continue;
+            }
+        } else {
+            // Time out now and then so switching continuous mode on takes effect
+            ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(1000));
+            if (!_takeTrigger || !_takeTrigger()) {
+                continue;
+            }
+            edgeUs = _edgeUs;
+        }
+
+        // A run is only started if all of its frames fit, so the consumer
+        // always sees complete runs of exactly frameCount frames.
+        bool fits = true;
+        for (size_t s = 0; s < _sensorCount; s++) {
+            fits &= _channels[s].ring.freeSpace() >= _framesPerRun;
+        }
+        if (!fits || uxQueueSpacesAvailable(_runQueue) < _sensorCount) {
+            _droppedTriggers++;
+            metrics.count(METRIC_DROPPED_TRIGGERS);
+            Serial.printf("[Acq] Busy, trigger dropped (%lu total)\n",
+                          (unsigned long)_droppedTriggers);
+            if (streaming) _stopFifos();
+            continue;
+        }
+
+        if (_decimation > 1) {
+            // Cached after the first run
+            _antiAlias.designButterworth(DECIMATION_PASSBAND * _sensorRateHz / (2.0f * _decimation),
+                                         _sensorRateHz, 4);
+        }
+
+        // Every sensor places the edge on its own clock
+        RunInfo runs[MAX_SENSORS];
+        uint64_t starts[MAX_SENSORS] = {};
+        _sequence++;
+        for (size_t s = 0; s < _sensorCount; s++) {
+            Channel& ch = _channels[s];
+            RunInfo& run = runs[s];
+            run.sequence = _sequence;
+            run.sensor = (uint8_t)s;
+            run.triggerMillis = millis();
+            run.frameCount = _framesPerRun;
+            run.scale = ch.sensor->getScale() / (_decimation > 1 ? DECIMATION_GAIN : 1);
+            run.reason = reason;
+            run.preTriggerFrames = 0;
+            if (streaming && _preFrames > 0) {
+                starts[s] = _historyStart(ch, _frameAt(ch, edgeUs), run.preTriggerFrames);
+                run.preTriggerFrames /= _decimation;
+            }
+            xQueueSend(_runQueue, &run, 0);
+        }
+
+        _capturing = true;
+        for (size_t s = 0; s < _sensorCount; s++) {
+            Channel& ch = _channels[s];
+            _beginTiming(ch);
+            ch.captured = 0;
+            ch.target = _framesPerRun * _decimation;
+            ch.decimPhase = 0;
+            ch.decimPrimed = false;
+            if (streaming && _preFrames > 0) {
+                // The last stream drain is a stamp of this run as well
+                if (ch.streamFrames > starts[s]) {
+                    _stampChunk(ch, (uint32_t)(ch.streamFrames - 1 - starts[s]), ch.drainUs);
+                }
+                ch.captured = _pushHistory(ch, starts[s]);
+            }
+        }
+        if (edgeUs > 0) {
+            int64_t latencyUs = esp_timer_get_time() - edgeUs;
+            if (latencyUs >= 0) {
+                metrics.record(METRIC_TRIGGER_LATENCY_US,
+                               latencyUs > UINT32_MAX ? UINT32_MAX : (uint32_t)latencyUs);
+            }
+        }
+        _capture(cfg, streaming);
+        for (size_t s = 0; s < _sensorCount; s++) {
+            _finishTiming(_channels[s], runs[s], edgeUs);
+        }
+        _capturing = false;
+    }
+}
+
+bool Acquisition::_streaming(const DeviceConfig& cfg) const {
+    return cfg.continuous_mode || _preFrames > 0;
+}
+
+void Acquisition::_beginFifos(const DeviceConfig& cfg) {
+    // Sensor 0 paces the round-robin; the others are drained on its watermark
+    for (size_t s = 0; s < _sensorCount; s++) {
+        _channels[s].sensor->beginFifoStream(ADXL313_FIFO_WATERMARK,
+                                            s == 0 ? cfg.adxl_int_pin : ADXL_INT_NONE);
+    }
+}
+
+void Acquisition::_stopFifos() {
+    for (size_t s = 0; s < _sensorCount; s++) {
+        _channels[s].sensor->stopFifo();
+    }
+}
+
+bool Acquisition::_stream(const DeviceConfig& cfg, uint8_t& reason, int64_t& edgeUs) {
+    _odrHz = _sensorRateHz;
+    uint32_t chunkMs = (uint32_t)(ADXL313_FIFO_WATERMARK * 1000.0f / _odrHz) + 1;
+    float scale = _channels[0].sensor->getScale();
+    bool fired = false;
+
+    _blockFill = 0;
+    _blockStart = 0;
+    if (_periodStartMs == 0) {
+        _periodStartMs = millis();
+    }
+
+    _beginFifos(cfg);
+    for (size_t s = 0; s < _sensorCount; s++) {
+        _channels[s].streamFrames = 0;
+        _channels[s].drainUs = esp_timer_get_time();
+    }
+
+    while (_streaming(cfg) && !fired) {
+        size_t primary = 0;
+        for (size_t s = 0; s < _sensorCount; s++) {
+            Channel& ch = _channels[s];
+            int64_t now = esp_timer_get_time();
+            size_t n = ch.sensor->readFifo(reinterpret_cast<int16_t*>(_chunk), ADXL313_FIFO_DEPTH);
+            if (n > 0) {
+                ch.drainUs = now;
+            }
+
+            // History: circular, indexed by stream position
+            for (size_t i = 0; ch.history && i < n; ) {
+                size_t pos = (size_t)(ch.streamFrames % _historySize);
+                size_t run = _historySize - pos;
+                if (run > n - i) run = n - i;
+                memcpy(ch.history + pos, _chunk + i, run * sizeof(RawFrame));
+                ch.streamFrames += run;
+                i += run;
+            }
+            if (!ch.history) {
+                ch.streamFrames += n;
+            }
+
+            if (s > 0) {
+                continue;
+            }
+            primary = n;
+
+            // Detector blocks
+            for (size_t i = 0; cfg.continuous_mode && i < n && !fired; ) {
+                size_t take = MONITOR_BLOCK_FRAMES - _blockFill;
+                if (take > n - i) take = n - i;
+                memcpy(_block + _blockFill, _chunk + i, take * sizeof(RawFrame));
+                _blockFill += take;
+                i += take;
+
+                if (_blockFill == MONITOR_BLOCK_FRAMES) {
+                    fired = _checkBlock(cfg, scale, reason);
+                    edgeUs = _timeAt(ch, _blockStart);
+                    _blockFill = 0;
+                    _blockStart = ch.streamFrames - (n - i);
+                }
+            }
+        }
+
+        // External triggers; the FIFO only wakes this task through its
+        // own semaphore, so poll the notification
+        if (!fired && ulTaskNotifyTake(pdTRUE, 0) > 0 && _takeTrigger && _takeTrigger()) {
+            reason = TRIGGER_EXTERNAL;
+            edgeUs = _edgeUs;
+            fired = true;
+        }
+
+        if (!fired && primary < ADXL313_FIFO_WATERMARK) {
+            _channels[0].sensor->waitForWatermark(2 * chunkMs);
+        }
+    }
+
+    if (!fired) {
+        _stopFifos();
+    }
+    return fired;
+}
+
+uint64_t Acquisition::_frameAt(const Channel& ch, int64_t us) const {
+    // The newest drained frame was sampled just before drainUs; an edge
+    // after the last drain belongs to the next frame
+    int64_t ageUs = ch.drainUs - us;
+    if (ageUs < 0 || ch.streamFrames == 0) {
+        return ch.streamFrames;
+    }
+    uint64_t age = (uint64_t)(ageUs * (double)_odrHz / 1000000.0);
+    return age + 1 > ch.streamFrames ? 0 : ch.streamFrames - 1 - age;
+}
+
+int64_t Acquisition::_timeAt(const Channel& ch, uint64_t frame) const {
+    int64_t age = (int64_t)(ch.streamFrames - 1) - (int64_t)frame;
+    return ch.drainUs - (int64_t)(age * 1000000.0 / _odrHz);
+}
+
+uint64_t Acquisition::_historyStart(const Channel& ch, uint64_t edge, uint32_t& preFrames) const {
+    uint64_t oldest = ch.streamFrames > _historySize ? ch.streamFrames - _historySize : 0;
+    uint64_t start = edge > _preFrames ? edge - _preFrames : 0;
+    if (start < oldest) {
+        Serial.println("[Acq] Trigger older than the history, pre-trigger shortened");
+        start = oldest;
+    }
+    if (edge < start) {
+        edge = start;
+    }
+    preFrames = (uint32_t)(edge - start);
+    return start;
+}
+
+size_t Acquisition::_pushHistory(Channel& ch, uint64_t start) {
+    uint64_t end = ch.streamFrames;
+    if (end - start > ch.target) {
+        end = start + ch.target;
+    }
+
+    for (uint64_t i = start; i < end; ) {
+        size_t pos = (size_t)(i % _historySize);
+        size_t run = _historySize - pos;
+        if (run > end - i) run = (size_t)(end - i);
+        _store(ch, ch.history + pos, run);
+        i += run;
+    }
+    _notifyConsumer();
+    return (size_t)(end - start);
+}
+
+bool Acquisition::_checkBlock(const DeviceConfig& cfg, float scale, uint8_t& reason) {
+    // AC RMS of the vector, so gravity and sensor offset do not count
+    int32_t sum[3] = {0, 0, 0};
+    for (size_t i = 0; i < MONITOR_BLOCK_FRAMES; i++) {
+        sum[0] += _block[i].x;
+        sum[1] += _block[i].y;
+        sum[2] += _block[i].z;
+    }
+    float mean[3];
+    for (int a = 0; a < 3; a++) {
+        mean[a] = (float)sum[a] / MONITOR_BLOCK_FRAMES;
+    }
+
+    float power = 0.0f;
+    for (size_t i = 0; i < MONITOR_BLOCK_FRAMES; i++) {
+        float dx = _block[i].x - mean[0];
+        float dy = _block[i].y - mean[1];
+        float dz = _block[i].z - mean[2];
+        power += dx * dx + dy * dy + dz * dz;
+    }
+    float rms = sqrtf(power / MONITOR_BLOCK_FRAMES) * scale;
+
+    _updateHeartbeat(cfg, rms);
+
+    uint32_t now = millis();
+    bool holdoff = _hadEvent && now - _lastEventMs < MONITOR_HOLDOFF_MS;
+    bool armed = _baselineBlocks >= MONITOR_WARMUP_BLOCKS;
+    bool fired = false;
+
+    if (!holdoff) {
+        if (cfg.event_rms_mg > 0 && rms * 1000.0f >= cfg.event_rms_mg) {
+            reason = TRIGGER_THRESHOLD;
+            fired = true;
+        } else if (cfg.event_change_pct > 0 && armed &&
+                   rms > _baseline * (1.0f + cfg.event_change_pct / 100.0f)) {
+            reason = TRIGGER_CHANGE;
+            fired = true;
+        }
+    }
+
+    if (fired) {
+        _hadEvent = true;
+        _lastEventMs = now;
+        _period.events++;
+        Serial.printf("[Acq] Event: block RMS %.1f mg (baseline %.1f mg, %s)\n",
+                      rms * 1000.0f, _baseline * 1000.0f, reasonName(reason));
+    } else {
+        // Only quiet blocks feed the baseline, so a slow ramp still
+        // fires eventually instead of being absorbed
+        _baseline = _baselineBlocks == 0
+                        ? rms
+                        : _baseline + MONITOR_EWMA_ALPHA * (rms - _baseline);
+        _baselineBlocks++;
+    }
+    return fired;
+}
+
+void Acquisition::_updateHeartbeat(const DeviceConfig& cfg, float rms) {
+    _period.blocks++;
+    _rmsSum += rms;
+    if (rms > _period.rmsMax) {
+        _period.rmsMax = rms;
+    }
+
+    uint32_t now = millis();
+    if (cfg.heartbeat_s == 0 || now - _periodStartMs < cfg.heartbeat_s * 1000UL) {
+        return;
+    }
+
+    _period.periodMs = now - _periodStartMs;
+    _period.rmsMean = _rmsSum / _period.blocks;
+    _period.baseline = _baseline;
+
+    // Only the latest period matters if the consumer is busy
+    xQueueOverwrite(_heartbeatQueue, &_period);
+
+    _period = {};
+    _rmsSum = 0.0f;
+    _periodStartMs = now;
+}
+
+void Acquisition::_beginTiming(Channel& ch) {
+    ch.stampCount = 0;
+    ch.stampTotal = 0;
+    ch.sumX = ch.sumY = ch.sumXX = ch.sumXY = 0;
+}
+
+void Acquisition::_stampChunk(Channel& ch, uint32_t frame, int64_t us) {
+    if (ch.stampTotal == 0) {
+        ch.stampBaseUs = us;
+    }
+    // Relative values keep the sums well inside double precision
+    double x = frame;
+    double y = (double)(us - ch.stampBaseUs);
+    ch.sumX += x;
+    ch.sumY += y;
+    ch.sumXX += x * x;
+    ch.sumXY += x * y;
+    ch.stampTotal++;
+
+    if (ch.stampCount < ACQ_MAX_CHUNK_STAMPS) {
+        ch.stamps[ch.stampCount].frame = frame;
+        ch.stamps[ch.stampCount].us = (int32_t)(us - ch.stampBaseUs);
+        ch.stampCount++;
+    }
+}
+
+void Acquisition::_finishTiming(Channel& ch, const RunInfo& run, int64_t edgeUs) {
+    RunTiming timing = {};
+    timing.sequence = run.sequence;
+    timing.sensor = run.sensor;
+    timing.chunks = ch.stampTotal;
+
+    // Nominal rate unless the stamps span enough frames to measure it
+    float nominalHz = _sensorRateHz;
+    double usPerFrame = 1000000.0 / nominalHz;
+    double offsetUs = 0.0;
+
+    double n = ch.stampTotal;
+    double det = n * ch.sumXX - ch.sumX * ch.sumX;
+    if (ch.stampTotal >= 2 && det > 0.0) {
+        double slope = (n * ch.sumXY - ch.sumX * ch.sumY) / det;
+        // Reject fits off by more than the sensor's 10 % clock tolerance
+        if (slope > 0.9 * usPerFrame && slope < 1.1 * usPerFrame) {
+            usPerFrame = slope;
+        }
+        offsetUs = (ch.sumY - usPerFrame * ch.sumX) / n;
+    } else if (ch.stampTotal == 1) {
+        offsetUs = ch.sumY - usPerFrame * ch.sumX;
+    }
+
+    // A stamp is taken just before the read, up to one period after the
+    // newest frame was sampled
+    offsetUs -= 0.5 * usPerFrame;
+
+    for (size_t i = 0; i < ch.stampCount; i++) {
+        double fit = offsetUs + 0.5 * usPerFrame + usPerFrame * ch.stamps[i].frame;
+        double dev = fabs(ch.stamps[i].us - fit);
+        if (dev > timing.jitterUs) {
+            timing.jitterUs = (uint32_t)dev;
+        }
+    }
+
+    // Stamps count sensor frames; a stored frame is the last of its
+    // group of _decimation (the filter delay is not removed)
+    offsetUs += (_decimation - 1) * usPerFrame;
+    usPerFrame *= _decimation;
+
+    timing.odrHz = (float)(1000000.0 / usPerFrame);
+    timing.startUs = ch.stampTotal > 0 ? ch.stampBaseUs + (int64_t)offsetUs : esp_timer_get_time();
+    timing.edgeUs = edgeUs != 0 ? edgeUs
+                                : timing.startUs + (int64_t)(run.preTriggerFrames * usPerFrame);
+
+    Serial.printf("[Acq] Sensor %d timing: ODR %.2f Hz from %lu stamps, jitter %lu us\n",
+                  run.sensor, timing.odrHz, (unsigned long)timing.chunks,
+                  (unsigned long)timing.jitterUs);
+
+    if (xQueueSend(_timingQueue, &timing, 0) != pdTRUE) {
+        Serial.println("[Acq] Timing queue full, run timing dropped");
+    }
+}
+
+void Acquisition::_capture(const DeviceConfig& cfg, bool streaming) {
+    Serial.println("\n========================================");
+    Serial.println("[Acq] Trigger received - starting measurement");
+    Serial.println("========================================");
+
+    unsigned long startTime = micros();
+    size_t frames = _channels[0].target - _channels[0].captured;   // Sensor frames
+    for (size_t s = 0; s < _sensorCount; s++) {
+        _channels[s].sensor->resetSpiStats();
+    }
+
+    if (cfg.use_fifo || streaming) {
+        _captureFifo(cfg, streaming);
+    } else {
+        _capturePolled();
+    }
+
+    unsigned long endTime = micros();
+    float actualDuration = (endTime - startTime) / 1000000.0f;
+    float actualRate = frames / actualDuration;
+
+    Serial.printf("[Acq] Sampling complete: %d samples in %.3f seconds\n",
+                  frames, actualDuration);
+    Serial.printf("[Acq] Actual sampling rate: %.1f Hz\n", actualRate);
+    
+    // Against the rate the frames should have arrived at
+    float nominalHz = _sensorRateHz;
+    if (frames > 0 && nominalHz > 0.0f) {
+        metrics.record(METRIC_CAPTURE_RATIO_PM,
+                       (uint32_t)(actualDuration * nominalHz * 1000.0f / frames + 0.5f));
+    }
+
+    for (size_t s = 0; s < _sensorCount; s++) {
+        ADXL313::SpiStats spi = _channels[s].sensor->getSpiStats();
+        Serial.printf("[Acq] SPI %d: %lu transactions, %lu us bus time, %lu bursts (last %lu frames in %lu us, max %lu us)\n",
+                      s, (unsigned long)spi.transactions, (unsigned long)spi.busTimeUs,
+                      (unsigned long)spi.bursts, (unsigned long)spi.lastBurstFrames,
+                      (unsigned long)spi.lastBurstUs, (unsigned long)spi.maxBurstUs);
+    }
+}
+
+void Acquisition::_capturePolled() {
+    // Sample interval in microseconds, at the ODR the sensor was set to:
+    // polling any faster would read the same sample twice
+    uint32_t sampleIntervalUs = (uint32_t)(1000000.0f / _sensorRateHz + 0.5f);
+    uint32_t nextSampleTime = micros();
+    size_t frames = _framesPerRun * _decimation;
+
+    // Disable WiFi interrupts for consistent timing
+    WiFi.setSleep(true);
+
+    // Sampling loop; all sensors are read at each tick
+    for (size_t i = 0; i < frames; i++) {
+        // Wait for next sample time
+        while (micros() < nextSampleTime) {
+            // Busy wait for timing accuracy
+        }
+        nextSampleTime += sampleIntervalUs;
+
+        for (size_t s = 0; s < _sensorCount; s++) {
+            Channel& ch = _channels[s];
+
+            // Read accelerometer
+            RawFrame frame = {0, 0, 0};
+            int64_t now = esp_timer_get_time();
+            ch.sensor->readRaw(frame.x, frame.y, frame.z);
+            _store(ch, &frame, 1);
+
+            if ((i & 0x3F) == 0x3F) {
+                _stampChunk(ch, (uint32_t)i, now);
+            }
+        }
+
+        // Let the consumer ingest in sizeable blocks
+        if ((i & 0x3F) == 0x3F) {
+            _notifyConsumer();
+        }
+    }
+    _notifyConsumer();
+
+    // Re-enable WiFi
+    WiFi.setSleep(false);
+}
+
+void Acquisition::_captureFifo(const DeviceConfig& cfg, bool streaming) {
+    // Timing comes from the sensor ODR; the task sleeps between watermarks.
+    float odrHz = _sensorRateHz;
+    uint32_t chunkMs = (uint32_t)(ADXL313_FIFO_WATERMARK * 1000.0f / odrHz) + 1;
+    uint32_t stallLimitMs = 50 * chunkMs + 100;
+
+    // Runs started from the stream continue with its FIFO contents
+    if (!streaming) {
+        _beginFifos(cfg);
+    }
+    for (size_t s = 0; s < _sensorCount; s++) {
+        _channels[s].lastDataMs = millis();
+    }
+
+    for (;;) {
+        // Round-robin: one batched drain per sensor, straight into its ring
+        bool done = true;
+        size_t primary = ADXL313_FIFO_WATERMARK;
+        for (size_t s = 0; s < _sensorCount; s++) {
+            Channel& ch = _channels[s];
+            if (ch.captured >= ch.target) {
+                continue;
+            }
+
+            // Without decimation the drain goes straight into the ring
+            RawFrame* region = _chunk;
+            size_t wanted = ADXL313_FIFO_DEPTH;
+            if (_decimation == 1) {
+                wanted = ch.ring.writeRegion(&region);
+            }
+            if (wanted > ch.target - ch.captured) wanted = ch.target - ch.captured;
+            if (wanted > ADXL313_FIFO_DEPTH) wanted = ADXL313_FIFO_DEPTH;
+
+            int64_t now = esp_timer_get_time();
+            size_t n = ch.sensor->readFifo(reinterpret_cast<int16_t*>(region), wanted);
+            if (n > 0) {
+                _stampChunk(ch, (uint32_t)(ch.captured + n - 1), now);
+                if (_decimation == 1) {
+                    ch.ring.commit(n);
+                } else {
+                    _store(ch, _chunk, n);
+                }
+                ch.captured += n;
+                ch.lastDataMs = millis();
+                _notifyConsumer();
+            } else if (millis() - ch.lastDataMs > stallLimitMs) {
+                Serial.printf("[Acq] Sensor %d FIFO stalled after %d samples, zero-filling\n",
+                              s, ch.captured);
+                metrics.count(METRIC_ZERO_FILLED_FRAMES, ch.target - ch.captured);
+                _fillZeros(ch, ch.target - ch.captured);
+                ch.captured = ch.target;
+            }
+
+            if (s == 0) {
+                primary = n;
+            }
+            done &= ch.captured >= ch.target;
+        }
+
+        if (done) {
+            break;
+        }
+        if (_channels[0].captured < _channels[0].target) {
+            if (primary < ADXL313_FIFO_WATERMARK) {
+                _channels[0].sensor->waitForWatermark(2 * chunkMs);
+            }
+        } else {
+            // Sensor 0 finished first; the rest are a frame or two behind
+            vTaskDelay(pdMS_TO_TICKS(chunkMs));
+        }
+    }
+
+    _stopFifos();
+
+    for (size_t s = 0; s < _sensorCount; s++) {
+        Channel& ch = _channels[s];
+        uint32_t overruns = ch.sensor->getFifoOverruns();
+        metrics.count(METRIC_FIFO_OVERRUNS, overruns - ch.overrunsSeen);
+        ch.overrunsSeen = overruns;
+        if (overruns > 0) {
+            Serial.printf("[Acq] Sensor %d FIFO full events so far: %lu\n",
+                          s, (unsigned long)overruns);
+        }
+    }
+}
+
+void Acquisition::_store(Channel& ch, const RawFrame* frames, size_t count) {
+    if (_decimation == 1) {
+        ch.ring.push(frames, count);
+        return;
+    }
+
+    // Steady state for the first frame, so gravity does not ring
+    if (!ch.decimPrimed) {
+        _antiAlias.initFilterState(ch.decimState[0], frames[0].x * (float)DECIMATION_GAIN);
+        _antiAlias.initFilterState(ch.decimState[1], frames[0].y * (float)DECIMATION_GAIN);
+        _antiAlias.initFilterState(ch.decimState[2], frames[0].z * (float)DECIMATION_GAIN);
+        ch.decimPrimed = true;
+    }
+
+    while (count > 0) {
+        size_t n = count < ADXL313_FIFO_DEPTH ? count : ADXL313_FIFO_DEPTH;
+        const int16_t* counts = reinterpret_cast<const int16_t*>(frames);
+
+        // Filter each axis over the block, then keep every Nth output
+        size_t kept = 0;
+        for (int axis = 0; axis < 3; axis++) {
+            _antiAlias.applyFilter(counts + axis, 3, (float)DECIMATION_GAIN,
+                                   _decimAxis, n, ch.decimState[axis]);
+            uint8_t phase = ch.decimPhase;
+            kept = 0;
+            for (size_t i = 0; i < n; i++) {
+                if (++phase < _decimation) continue;
+                phase = 0;
+                float v = roundf(_decimAxis[i]);
+                int16_t* out = reinterpret_cast<int16_t*>(_decimOut + kept++);
+                out[axis] = (int16_t)constrain(v, -32768.0f, 32767.0f);
+            }
+        }
+        ch.decimPhase = (uint8_t)((ch.decimPhase + n) % _decimation);
+        ch.ring.push(_decimOut, kept);
+
+        frames += n;
+        count -= n;
+    }
+}
+
+void Acquisition::_fillZeros(Channel& ch, size_t frames) {
+    // Through the decimation stage, so the run keeps its stored length
+    memset(_chunk, 0, sizeof(_chunk));
+    while (frames > 0) {
+        size_t n = frames < ADXL313_FIFO_DEPTH ? frames : ADXL313_FIFO_DEPTH;
+        _store(ch, _chunk, n);
+        frames -= n;
+    }
+    _notifyConsumer();
+}
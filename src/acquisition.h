@@ -0,0 +1,417 @@
+#ifndef ACQUISITION_H
+#define ACQUISITION_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "ring_buffer.h"
+#include "adxl313.h"
+#include "dsp.h"
+#include <esp_timer.h>
+
+/**
+ * @brief One raw accelerometer frame as read from the ADXL313 (counts)
+ */
+struct RawFrame {
+    int16_t x;
+    int16_t y;
+    int16_t z;
+};
+
+/**
+ * @brief What started a capture
+ */
+enum TriggerReason : uint8_t {
+    TRIGGER_EXTERNAL = 0,       // PLC input or /api/trigger
+    TRIGGER_THRESHOLD,          // Block RMS above event_rms_mg
+    TRIGGER_CHANGE              // Block RMS rose over the baseline
+};
+
+/**
+ * @brief Continuous-monitoring summary for one heartbeat period
+ */
+struct MonitorSummary {
+    uint32_t periodMs;          // Time covered
+    uint32_t blocks;            // Detector blocks evaluated
+    uint32_t events;            // Captures triggered by the detector
+    float rmsMean;              // g, mean of block RMS
+    float rmsMax;               // g, largest block RMS
+    float baseline;             // g, EWMA baseline at the end of the period
+};
+
+/**
+ * @brief Descriptor for one triggered capture
+ *
+ * Posted when capture starts, one per sensor; the frames follow through
+ * that sensor's ring and exactly frameCount of them belong to this run.
+ */
+struct RunInfo {
+    uint32_t sequence;          // Capture counter since boot, shared by all sensors
+    uint8_t sensor;             // Index of the sensor these frames come from
+    uint32_t triggerMillis;     // millis() when the trigger was taken
+    size_t frameCount;          // Frames the producer will push
+    float scale;                // g per LSB for these frames
+    uint8_t reason;             // TriggerReason
+    uint32_t preTriggerFrames;  // Frames before the trigger edge
+};
+
+/**
+ * @brief Sample timing of one run, measured from the sensor clock
+ *
+ * Each FIFO drain (every 64 frames when polling) stamps the index of its
+ * newest frame with esp_timer; a least-squares line through the stamps
+ * gives the effective ODR and the time of frame 0, free of task jitter.
+ */
+struct RunTiming {
+    uint32_t sequence;          // RunInfo::sequence this belongs to
+    uint8_t sensor;             // RunInfo::sensor
+    int64_t startUs;            // esp_timer time of frame 0
+    int64_t edgeUs;             // esp_timer time of the trigger edge
+    float odrHz;                // Measured output data rate
+    uint32_t jitterUs;          // Largest stamp deviation from the fit
+    uint32_t chunks;            // Stamps in the fit
+};
+
+/**
+ * @brief Sensor acquisition task feeding lock-free frame rings
+ *
+ * Runs the ADXL313 capture loop in its own FreeRTOS task pinned to
+ * core 1 at high priority. Raw frames go into a single-producer/
+ * single-consumer ring per sensor so a processing task on the other
+ * core can consume one run while the next is already being captured.
+ *
+ * Up to MAX_SENSORS sensors share the SPI bus. Their FIFOs are drained
+ * round-robin, each drain one queued DMA batch, paced by the watermark
+ * interrupt of sensor 0; the others are polled at the same ODR. Every
+ * trigger produces one run per sensor, posted in sensor order.
+ *
+ * In continuous mode the task streams the FIFOs between captures and
+ * checks each MONITOR_BLOCK_FRAMES block's RMS of sensor 0; a capture
+ * starts when it crosses the absolute threshold or rises over the EWMA
+ * baseline, as well as on external triggers. Blocks are not stored.
+ *
+ * With a pre-trigger share configured the FIFOs are streamed the same
+ * way into circular histories. The trigger ISR stamps the edge time,
+ * which is mapped to a frame index of each sensor from its drain
+ * timestamps, so each run holds preTriggerFrames frames before the edge
+ * regardless of how long the task took to notice it.
+ *
+ * With a decimation factor configured, frames are low-pass filtered
+ * per axis and sensor and only every Nth one enters the ring, so runs,
+ * frame counts and the measured ODR are at the reduced rate. The
+ * stored counts carry DECIMATION_GAIN extra resolution (RunInfo::scale
+ * accounts for it). Streaming histories and the detector stay at the
+ * sensor rate.
+ */
+class Acquisition {
+public:
+    /**
+     * @brief Allocate the rings and start the acquisition task
+     * @param framesPerRun Frames captured per trigger and sensor
+     * @param sensors Initialized sensors; sensor 0 owns the watermark pin
+     * @param sensorCount Number of sensors (1..MAX_SENSORS)
+     * @return true if task and buffers were created
+     */
+    bool begin(size_t framesPerRun, ADXL313* const* sensors, size_t sensorCount);
+
+    /**
+     * @brief Number of sensors captured per trigger
+     */
+    size_t sensorCount() const { return _sensorCount; }
+
+    /**
+     * @brief Nominal sensor ODR: the configured rate snapped to a BW_RATE step
+     */
+    float sensorRateHz() const { return _sensorRateHz; }
+
+    /**
+     * @brief Decimation factor of the stored frames
+     */
+    uint8_t decimation() const { return _decimation; }
+
+    /**
+     * @brief Nominal rate of the stored frames (sensor ODR / decimation)
+     *
+     * Fixed at begin(), like the ODR programmed into the sensors, so
+     * processing sees the rate the data was captured at even after the
+     * config has changed.
+     */
+    float storedRateHz() const { return _sensorRateHz / _decimation; }
+
+    /**
+     * @brief Set the function that consumes a pending trigger
+     *
+     * Called from the acquisition task after every wake-up; returns
+     * true if a trigger was pending (and clears it).
+     * @param takeTrigger Trigger check function
+     */
+    void setTriggerSource(bool (*takeTrigger)());
+
+    /**
+     * @brief Wake the acquisition task to check for a trigger
+     */
+    void wake();
+
+    /**
+     * @brief Wake the acquisition task from an ISR
+     */
+    void IRAM_ATTR wakeFromISR();
+
+    /**
+     * @brief Record the time of a trigger edge (ISR safe)
+     *
+     * Call before waking the task; the edge time places the trigger
+     * within the pre-trigger history.
+     */
+    void IRAM_ATTR markTrigger();
+
+    /**
+     * @brief Wait for the next capture to start (consumer side)
+     * @param run Output: run descriptor
+     * @param timeoutMs Maximum time to wait
+     * @return true if a run was received
+     */
+    bool waitForRun(RunInfo& run, uint32_t timeoutMs);
+
+    /**
+     * @brief Get contiguous captured frames without copying (consumer side)
+     *
+     * Blocks until at least one frame is available or the timeout expires.
+     * @param sensor Sensor index (RunInfo::sensor)
+     * @param frames Output: pointer to the oldest frame
+     * @param timeoutMs Maximum time to wait
+     * @return Number of contiguous frames (0 on timeout)
+     */
+    size_t peekFrames(uint8_t sensor, const RawFrame** frames, uint32_t timeoutMs);
+
+    /**
+     * @brief Release frames obtained from peekFrames() (consumer side)
+     * @param sensor Sensor index (RunInfo::sensor)
+     * @param count Number of frames consumed
+     */
+    void consumeFrames(uint8_t sensor, size_t count);
+
+    /**
+     * @brief Wait for the timing of a run (consumer side)
+     *
+     * Posted when the capture completes; older entries are skipped.
+     * @param run Run to wait for
+     * @param timing Output
+     * @param timeoutMs Maximum time to wait
+     * @return true if the timing of that run was received
+     */
+    bool takeTiming(const RunInfo& run, RunTiming& timing, uint32_t timeoutMs);
+
+    /**
+     * @brief Take the latest heartbeat summary (consumer side)
+     * @param summary Output
+     * @return true if a period completed since the last call
+     */
+    bool takeHeartbeat(MonitorSummary& summary);
+
+    /**
+     * @brief Name of a TriggerReason for uploads
+     */
+    static const char* reasonName(uint8_t reason);
+
+    /**
+     * @brief Number of triggers rejected because the ring was busy
+     */
+    uint32_t getDroppedTriggers() const;
+
+    /**
+     * @brief Whether a capture is currently in progress
+     */
+    bool isCapturing() const;
+
+    /**
+     * @brief Handle of the acquisition task, nullptr before begin()
+     */
+    TaskHandle_t taskHandle() const { return _task; }
+
+private:
+    // Chunk stamp relative to the first one of the run
+    struct ChunkStamp {
+        uint32_t frame;             // Run index of the newest frame drained
+        int32_t us;
+    };
+
+    // Per-sensor state (acquisition task only, except the ring)
+    struct Channel {
+        ADXL313* sensor = nullptr;
+        SpscRing<RawFrame> ring;
+
+        // FIFO streaming between runs
+        uint64_t streamFrames = 0;  // Frames drained since the stream started
+        int64_t drainUs = 0;        // esp_timer time before the last drain
+        RawFrame* history = nullptr;
+
+        // Capture of the current run, in sensor frames
+        size_t captured = 0;
+        size_t target = 0;
+        uint32_t lastDataMs = 0;
+        uint32_t overrunsSeen = 0;  // FIFO overruns already counted in metrics
+
+        // Anti-alias filter of the decimation stage
+        DSP::FilterState decimState[3];
+        uint8_t decimPhase = 0;
+        bool decimPrimed = false;
+
+        // Timing fit of the current run
+        ChunkStamp stamps[ACQ_MAX_CHUNK_STAMPS];
+        size_t stampCount = 0;
+        uint32_t stampTotal = 0;
+        int64_t stampBaseUs = 0;
+        double sumX = 0, sumY = 0, sumXX = 0, sumXY = 0;
+    };
+
+    Channel _channels[MAX_SENSORS];
+    size_t _sensorCount = 0;
+    size_t _framesPerRun = 0;
+    uint32_t _sequence = 0;
+    volatile uint32_t _droppedTriggers = 0;
+    volatile bool _capturing = false;
+
+    TaskHandle_t _task = nullptr;
+    TaskHandle_t _consumer = nullptr;
+    QueueHandle_t _runQueue = nullptr;
+    QueueHandle_t _heartbeatQueue = nullptr;
+    QueueHandle_t _timingQueue = nullptr;
+    bool (*_takeTrigger)() = nullptr;
+
+    // Drain scratch, processed before the next sensor is read
+    RawFrame _chunk[ADXL313_FIFO_DEPTH];
+    RawFrame _decimOut[ADXL313_FIFO_DEPTH];
+    float _decimAxis[ADXL313_FIFO_DEPTH];
+
+    // Decimation stage; its own filter instance, as the shared DSP
+    // design belongs to the processing task
+    uint8_t _decimation = 1;
+    float _sensorRateHz = DEFAULT_SAMPLE_RATE_HZ;
+    DSP _antiAlias;
+    float _odrHz = 0.0f;
+    volatile int64_t _edgeUs = 0;   // esp_timer time of the last trigger edge
+
+    // Pre-trigger history
+    size_t _historySize = 0;
+    size_t _preFrames = 0;
+
+    // Continuous-monitoring state of sensor 0
+    RawFrame _block[MONITOR_BLOCK_FRAMES];
+    size_t _blockFill = 0;
+    uint64_t _blockStart = 0;
+    float _baseline = 0.0f;
+    uint32_t _baselineBlocks = 0;
+    uint32_t _lastEventMs = 0;
+    bool _hadEvent = false;
+    MonitorSummary _period = {};
+    uint32_t _periodStartMs = 0;
+    float _rmsSum = 0.0f;
+
+    static void _taskEntry(void* arg);
+    void _run();
+
+    /**
+     * @brief Whether the FIFOs are streamed between runs
+     */
+    bool _streaming(const DeviceConfig& cfg) const;
+
+    /**
+     * @brief Start or stop FIFO streaming on every sensor
+     */
+    void _beginFifos(const DeviceConfig& cfg);
+    void _stopFifos();
+
+    /**
+     * @brief Stream the FIFOs through histories and detector until a capture is due
+     *
+     * The FIFOs are left running when a capture is due.
+     * @param cfg Active configuration
+     * @param reason Output: what fired
+     * @param edgeUs Output: esp_timer time of the trigger
+     * @return false if streaming was switched off meanwhile
+     */
+    bool _stream(const DeviceConfig& cfg, uint8_t& reason, int64_t& edgeUs);
+
+    /**
+     * @brief Stream index of a sensor's frame sampled at an esp_timer time
+     */
+    uint64_t _frameAt(const Channel& ch, int64_t us) const;
+
+    /**
+     * @brief esp_timer time of a sensor's stream frame
+     */
+    int64_t _timeAt(const Channel& ch, uint64_t frame) const;
+
+    /**
+     * @brief First history frame of a run
+     * @param ch Sensor channel
+     * @param edge Stream index of the trigger
+     * @param preFrames Output: frames before the edge still in the history
+     * @return Stream index the run starts at
+     */
+    uint64_t _historyStart(const Channel& ch, uint64_t edge, uint32_t& preFrames) const;
+
+    /**
+     * @brief Push a run's frames from the history into the ring
+     * @param start Stream index returned by _historyStart()
+     * @return Frames pushed (at most one run)
+     */
+    size_t _pushHistory(Channel& ch, uint64_t start);
+
+    /**
+     * @brief Evaluate one full block
+     * @return true if the detector fired
+     */
+    bool _checkBlock(const DeviceConfig& cfg, float scale, uint8_t& reason);
+
+    void _updateHeartbeat(const DeviceConfig& cfg, float rms);
+
+    /**
+     * @brief Reset the timing fit for a new run
+     */
+    void _beginTiming(Channel& ch);
+
+    /**
+     * @brief Add a chunk stamp
+     * @param frame Run index of the newest frame of the chunk
+     * @param us esp_timer time taken just before it was read
+     */
+    void _stampChunk(Channel& ch, uint32_t frame, int64_t us);
+
+    /**
+     * @brief Fit the stamps and post the run's timing
+     * @param run The run just captured
+     * @param edgeUs Trigger time, or 0 to place it at preTriggerFrames
+     */
+    void _finishTiming(Channel& ch, const RunInfo& run, int64_t edgeUs);
+
+    /**
+     * @brief Capture the rest of one run from every sensor into the rings
+     * @param cfg Active configuration
+     * @param streaming true if the FIFOs are already running (forces FIFO)
+     */
+    void _capture(const DeviceConfig& cfg, bool streaming);
+    void _captureFifo(const DeviceConfig& cfg, bool streaming);
+    void _capturePolled();
+
+    /**
+     * @brief Pass sensor frames into a ring through the decimation stage
+     * @param ch Sensor channel
+     * @param frames Sensor frames in stream order
+     * @param count Number of frames
+     */
+    void _store(Channel& ch, const RawFrame* frames, size_t count);
+
+    /**
+     * @brief Push zero frames to complete a run after a sensor stall
+     * @param frames Number of sensor frames missing
+     */
+    void _fillZeros(Channel& ch, size_t frames);
+
+    void _notifyConsumer();
+};
+
+// Global instance
+extern Acquisition acquisition;
+
+#endif // ACQUISITION_H
@@ -1,19 +1,73 @@
 #include "adxl313.h"
+#include <esp_heap_caps.h>
+#include <esp_timer.h>
 
 // Global instance
 ADXL313 adxl313;
 
+// VSPI on the ESP32-WROOM, FSPI (IO_MUX pins) on the ESP32-S3
+#if CONFIG_IDF_TARGET_ESP32S3
+static const spi_host_device_t ADXL313_SPI_HOST = SPI2_HOST;
+#else
+static const spi_host_device_t ADXL313_SPI_HOST = SPI3_HOST;
+#endif
+
 bool ADXL313::begin(uint8_t csPin, uint32_t spiSpeed) {
     _csPin = csPin;
-    _spiSettings = SPISettings(spiSpeed, MSBFIRST, SPI_MODE3);
     
-    // Initialize CS pin
-    pinMode(_csPin, OUTPUT);
-    digitalWrite(_csPin, HIGH);
+    // Initialize the bus once; a second sensor on the same bus reuses it
+    spi_bus_config_t busCfg = {};
+    busCfg.mosi_io_num = DEFAULT_SPI_MOSI;
+    busCfg.miso_io_num = DEFAULT_SPI_MISO;
+    busCfg.sclk_io_num = DEFAULT_SPI_CLK;
+    busCfg.quadwp_io_num = -1;
+    busCfg.quadhd_io_num = -1;
+    busCfg.max_transfer_sz = ADXL313_FIFO_DEPTH * FRAME_STRIDE;
+    
+    esp_err_t err = spi_bus_initialize(ADXL313_SPI_HOST, &busCfg, SPI_DMA_CH_AUTO);
+    if (err != ESP_OK && err != ESP_ERR_INVALID_STATE) {
+        Serial.printf("[ADXL313] SPI bus init failed: %s\n", esp_err_to_name(err));
+        return false;
+    }
+    
+    if (!_spi) {
+        spi_device_interface_config_t devCfg = {};
+        devCfg.mode = 3;                        // CPOL=1, CPHA=1
+        devCfg.clock_speed_hz = spiSpeed;
+        devCfg.spics_io_num = _csPin;           // Hardware CS
+        devCfg.queue_size = ADXL313_FIFO_DEPTH; // Whole FIFO in one batch
+        // Hold CS a little after each frame; together with the driver's
+        // inter-transaction gap this covers the 5 us FIFO pop time.
+        devCfg.cs_ena_posttrans = 16;
+        
+        err = spi_bus_add_device(ADXL313_SPI_HOST, &devCfg, &_spi);
+        if (err != ESP_OK) {
+            Serial.printf("[ADXL313] SPI device add failed: %s\n", esp_err_to_name(err));
+            return false;
+        }
+    }
     
-    // Initialize SPI
-    SPI.begin();
-    delay(10);
+    // DMA-capable frame buffers and the transactions that point into them
+    if (!_dmaTx) {
+        _dmaTx = (uint8_t*)heap_caps_malloc(ADXL313_FIFO_DEPTH * FRAME_STRIDE, MALLOC_CAP_DMA);
+        _dmaRx = (uint8_t*)heap_caps_malloc(ADXL313_FIFO_DEPTH * FRAME_STRIDE, MALLOC_CAP_DMA);
+        if (!_dmaTx || !_dmaRx) {
+            Serial.println("[ADXL313] DMA buffer allocation failed!");
+            return false;
+        }
+        
+        for (size_t i = 0; i < ADXL313_FIFO_DEPTH; i++) {
+            uint8_t* tx = _dmaTx + i * FRAME_STRIDE;
+            memset(tx, 0, FRAME_STRIDE);
+            // Read + Multi-byte: bits 7 and 6 set
+            tx[0] = ADXL313_DATAX0 | ADXL313_READ_BIT | ADXL313_MULTI_BIT;
+            
+            memset(&_fifoTrans[i], 0, sizeof(spi_transaction_t));
+            _fifoTrans[i].length = 7 * 8;
+            _fifoTrans[i].tx_buffer = tx;
+            _fifoTrans[i].rx_buffer = _dmaRx + i * FRAME_STRIDE;
+        }
+    }
     
     // Verify device ID
     uint8_t devId = readDeviceId();
@@ -65,6 +119,26 @@ void ADXL313::setDataRate(uint8_t rate) {
     Serial.printf("[ADXL313] Data rate register set to 0x%02X\n", rate);
 }
 
+uint8_t ADXL313::rateCodeForHz(uint16_t rateHz) {
+    // BW_RATE codes double the ODR per step: 0x0F = 3200 Hz, 0x06 = 6.25 Hz
+    uint8_t code = 0x0F;
+    float odr = 3200.0f;
+    while (code > 0x06 && odr > rateHz) {
+        code--;
+        odr /= 2.0f;
+    }
+    return code;
+}
+
+float ADXL313::rateHzForCode(uint8_t rate) {
+    if (rate > 0x0F) rate = 0x0F;
+    return 3200.0f / (float)(1 << (0x0F - rate));
+}
+
+float ADXL313::getScale() const {
+    return _scale;
+}
+
 bool ADXL313::readRaw(int16_t& x, int16_t& y, int16_t& z) {
     uint8_t buffer[6];
     
@@ -102,41 +176,228 @@ bool ADXL313::isConnected() {
     return readDeviceId() == 0xAD;
 }
 
-void ADXL313::_writeReg(uint8_t reg, uint8_t value) {
-    SPI.beginTransaction(_spiSettings);
-    digitalWrite(_csPin, LOW);
+bool ADXL313::_transmit(spi_transaction_t* trans) {
+    if (!_spi) {
+        return false;
+    }
+    
+    int64_t start = esp_timer_get_time();
+    esp_err_t err = spi_device_polling_transmit(_spi, trans);
+    uint32_t elapsed = (uint32_t)(esp_timer_get_time() - start);
     
-    SPI.transfer(reg & 0x3F);  // Write: bit 7 = 0
-    SPI.transfer(value);
+    _stats.transactions++;
+    _stats.busTimeUs += elapsed;
+    _stats.lastTransactionUs = elapsed;
     
-    digitalWrite(_csPin, HIGH);
-    SPI.endTransaction();
+    return err == ESP_OK;
 }
 
-uint8_t ADXL313::_readReg(uint8_t reg) {
-    SPI.beginTransaction(_spiSettings);
-    digitalWrite(_csPin, LOW);
-    
-    SPI.transfer(reg | ADXL313_READ_BIT);  // Read: bit 7 = 1
-    uint8_t value = SPI.transfer(0x00);
+void ADXL313::_writeReg(uint8_t reg, uint8_t value) {
+    spi_transaction_t t = {};
+    t.flags = SPI_TRANS_USE_TXDATA;
+    t.length = 16;
+    t.tx_data[0] = reg & 0x3F;  // Write: bit 7 = 0
+    t.tx_data[1] = value;
     
-    digitalWrite(_csPin, HIGH);
-    SPI.endTransaction();
+    _transmit(&t);
+}
+
+uint8_t ADXL313::_readReg(uint8_t reg) {
+    spi_transaction_t t = {};
+    t.flags = SPI_TRANS_USE_TXDATA | SPI_TRANS_USE_RXDATA;
+    t.length = 16;
+    t.tx_data[0] = reg | ADXL313_READ_BIT;  // Read: bit 7 = 1
     
-    return value;
+    if (!_transmit(&t)) {
+        return 0;
+    }
+    return t.rx_data[1];
 }
 
 void ADXL313::_readBurst(uint8_t reg, uint8_t* buffer, uint8_t len) {
-    SPI.beginTransaction(_spiSettings);
-    digitalWrite(_csPin, LOW);
+    // Single transaction through frame slot 0 of the DMA buffers
+    if (len > FRAME_STRIDE - 1) len = FRAME_STRIDE - 1;
+    if (!_dmaTx) {
+        memset(buffer, 0, len);
+        return;
+    }
+    
+    uint8_t* tx = _dmaTx;
+    uint8_t* rx = _dmaRx;
+    memset(tx, 0, FRAME_STRIDE);
     
     // Read + Multi-byte: bits 7 and 6 set
-    SPI.transfer(reg | ADXL313_READ_BIT | ADXL313_MULTI_BIT);
+    tx[0] = reg | ADXL313_READ_BIT | ADXL313_MULTI_BIT;
+    
+    spi_transaction_t t = {};
+    t.length = (len + 1) * 8;
+    t.tx_buffer = tx;
+    t.rx_buffer = rx;
+    
+    if (_transmit(&t)) {
+        memcpy(buffer, rx + 1, len);
+    } else {
+        memset(buffer, 0, len);
+    }
+    
+    // Restore the FIFO drain command in slot 0
+    tx[0] = ADXL313_DATAX0 | ADXL313_READ_BIT | ADXL313_MULTI_BIT;
+}
+
+bool ADXL313::_drainFrames(size_t count) {
+    bool ok = true;
+    int64_t start = esp_timer_get_time();
+    
+    // Hold the bus for the whole burst instead of arbitrating per frame
+    spi_device_acquire_bus(_spi, portMAX_DELAY);
+    
+    if (_transferMode == TransferMode::QUEUED) {
+        // Hand every frame to the driver at once; the DMA ISR chains them
+        // and this task sleeps until results come back.
+        size_t queued = 0;
+        for (; queued < count; queued++) {
+            if (spi_device_queue_trans(_spi, &_fifoTrans[queued], portMAX_DELAY) != ESP_OK) {
+                ok = false;
+                break;
+            }
+        }
+        for (size_t i = 0; i < queued; i++) {
+            spi_transaction_t* done;
+            if (spi_device_get_trans_result(_spi, &done, portMAX_DELAY) != ESP_OK) {
+                ok = false;
+            }
+        }
+    } else {
+        for (size_t i = 0; i < count; i++) {
+            if (spi_device_polling_transmit(_spi, &_fifoTrans[i]) != ESP_OK) {
+                ok = false;
+                break;
+            }
+        }
+    }
+    
+    spi_device_release_bus(_spi);
+    
+    uint32_t elapsed = (uint32_t)(esp_timer_get_time() - start);
+    _stats.transactions += count;
+    _stats.bursts++;
+    _stats.busTimeUs += elapsed;
+    _stats.lastBurstUs = elapsed;
+    _stats.lastBurstFrames = count;
+    if (elapsed > _stats.maxBurstUs) {
+        _stats.maxBurstUs = elapsed;
+    }
+    
+    return ok;
+}
+
+void ADXL313::setTransferMode(TransferMode mode) {
+    _transferMode = mode;
+}
+
+ADXL313::SpiStats ADXL313::getSpiStats() const {
+    return _stats;
+}
+
+void ADXL313::resetSpiStats() {
+    _stats = {};
+}
+
+// ============================================================================
+// FIFO Stream Acquisition
+// ============================================================================
+void IRAM_ATTR ADXL313::_watermarkISR(void* arg) {
+    ADXL313* self = static_cast<ADXL313*>(arg);
+    BaseType_t woken = pdFALSE;
+    xSemaphoreGiveFromISR(self->_fifoSem, &woken);
+    if (woken) {
+        portYIELD_FROM_ISR();
+    }
+}
+
+bool ADXL313::beginFifoStream(uint8_t watermark, uint8_t intPin) {
+    if (watermark < 1) watermark = 1;
+    if (watermark >= ADXL313_FIFO_DEPTH) watermark = ADXL313_FIFO_DEPTH - 1;
+    
+    if (!_fifoSem) {
+        _fifoSem = xSemaphoreCreateBinary();
+        if (!_fifoSem) {
+            Serial.println("[ADXL313] FIFO semaphore allocation failed!");
+            return false;
+        }
+    }
+    
+    // Bypass mode discards anything left over from a previous capture
+    _writeReg(ADXL313_INT_ENABLE, 0x00);
+    _writeReg(ADXL313_FIFO_CTL, ADXL313_FIFO_BYPASS);
+    xSemaphoreTake(_fifoSem, 0);
+    
+    // Watermark on INT1 (INT_MAP bit clear), active high
+    _writeReg(ADXL313_INT_MAP, 0x00);
+    
+    _intPin = intPin;
+    if (_intPin != ADXL_INT_NONE) {
+        pinMode(_intPin, INPUT);
+        attachInterruptArg(digitalPinToInterrupt(_intPin), _watermarkISR, this, RISING);
+    }
+    
+    _writeReg(ADXL313_FIFO_CTL, ADXL313_FIFO_STREAM | (watermark & 0x1F));
+    _writeReg(ADXL313_INT_ENABLE, ADXL313_INT_WATERMARK);
+    
+    return true;
+}
+
+void ADXL313::stopFifo() {
+    _writeReg(ADXL313_INT_ENABLE, 0x00);
+    _writeReg(ADXL313_FIFO_CTL, ADXL313_FIFO_BYPASS);
+    
+    if (_intPin != ADXL_INT_NONE) {
+        detachInterrupt(digitalPinToInterrupt(_intPin));
+        _intPin = ADXL_INT_NONE;
+    }
+}
+
+bool ADXL313::waitForWatermark(uint32_t timeoutMs) {
+    if (_intPin == ADXL_INT_NONE || !_fifoSem) {
+        vTaskDelay(pdMS_TO_TICKS(timeoutMs));
+        return false;
+    }
+    return xSemaphoreTake(_fifoSem, pdMS_TO_TICKS(timeoutMs)) == pdTRUE;
+}
+
+uint8_t ADXL313::fifoEntries() {
+    return _readReg(ADXL313_FIFO_STATUS) & 0x3F;
+}
+
+size_t ADXL313::readFifo(int16_t* xyz, size_t maxFrames) {
+    if (!_spi) {
+        return 0;
+    }
+    
+    size_t entries = fifoEntries();
+    if (entries >= ADXL313_FIFO_DEPTH) {
+        _fifoOverruns++;
+    }
+    if (entries > maxFrames) {
+        entries = maxFrames;
+    }
+    
+    // Each 6-byte read of DATAX0..DATAZ1 pops one FIFO entry, so every
+    // frame is its own CS-framed transaction within one submitted burst.
+    if (entries == 0 || !_drainFrames(entries)) {
+        return 0;
+    }
     
-    for (uint8_t i = 0; i < len; i++) {
-        buffer[i] = SPI.transfer(0x00);
+    for (size_t i = 0; i < entries; i++) {
+        const uint8_t* buffer = _dmaRx + i * FRAME_STRIDE + 1;
+        xyz[i * 3 + 0] = (int16_t)((buffer[1] << 8) | buffer[0]);
+        xyz[i * 3 + 1] = (int16_t)((buffer[3] << 8) | buffer[2]);
+        xyz[i * 3 + 2] = (int16_t)((buffer[5] << 8) | buffer[4]);
     }
     
-    digitalWrite(_csPin, HIGH);
-    SPI.endTransaction();
+    return entries;
+}
+
+uint32_t ADXL313::getFifoOverruns() const {
+    return _fifoOverruns;
 }
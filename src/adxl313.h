@@ -2,7 +2,7 @@
 #define ADXL313_H
 
 #include <Arduino.h>
-#include <SPI.h>
+#include <driver/spi_master.h>
 #include "config.h"
 
 /**
@@ -10,9 +10,34 @@
  * 
  * Ported from Python implementation with high-speed sampling support
  * using hardware timers for consistent 3200 Hz data acquisition.
+ * 
+ * Built directly on the ESP-IDF spi_master driver: the device owns a
+ * dedicated handle with hardware CS, and FIFO drains are submitted as a
+ * batch of pre-built DMA transactions rather than per-byte transfers.
  */
 class ADXL313 {
 public:
+    /**
+     * @brief How FIFO drains are submitted to the SPI driver
+     */
+    enum class TransferMode {
+        POLLING,    // Busy-poll each transaction (lowest latency, CPU bound)
+        QUEUED      // Queue the whole burst, sleep until the DMA completes
+    };
+    
+    /**
+     * @brief SPI bus timing counters
+     */
+    struct SpiStats {
+        uint32_t transactions;      // SPI transactions since reset
+        uint32_t bursts;            // FIFO drains since reset
+        uint64_t busTimeUs;         // Total time spent in SPI transactions
+        uint32_t lastTransactionUs; // Duration of the last single transaction
+        uint32_t lastBurstUs;       // Duration of the last FIFO drain
+        uint32_t lastBurstFrames;   // Frames in the last FIFO drain
+        uint32_t maxBurstUs;        // Longest FIFO drain since reset
+    };
+    
     /**
      * @brief Initialize the ADXL313 sensor
      * @param csPin Chip select GPIO pin
@@ -69,11 +94,116 @@ public:
      */
     void setDataRate(uint8_t rate);
     
+    /**
+     * @brief Get BW_RATE code for the highest ODR not above a rate
+     * @param rateHz Requested output data rate in Hz
+     * @return BW_RATE register value (0x06 = 6.25 Hz ... 0x0F = 3200 Hz)
+     */
+    static uint8_t rateCodeForHz(uint16_t rateHz);
+    
+    /**
+     * @brief Get output data rate for a BW_RATE code
+     * @param rate BW_RATE register value
+     * @return Output data rate in Hz
+     */
+    static float rateHzForCode(uint8_t rate);
+    
+    /**
+     * @brief Get g-per-LSB scale for the current sensitivity
+     * @return Scale factor
+     */
+    float getScale() const;
+    
+    // ------------------------------------------------------------------------
+    // FIFO stream acquisition
+    // ------------------------------------------------------------------------
+    
+    /**
+     * @brief Start FIFO stream mode with a watermark interrupt
+     * 
+     * Clears the FIFO, sets FIFO_CTL to stream mode with the given
+     * watermark and maps the watermark interrupt to INT1. Sample timing
+     * then comes from the sensor ODR clock.
+     * @param watermark Frames buffered before INT1 asserts (1-31)
+     * @param intPin GPIO wired to INT1, or ADXL_INT_NONE to poll
+     * @return true if FIFO started
+     */
+    bool beginFifoStream(uint8_t watermark, uint8_t intPin);
+    
+    /**
+     * @brief Stop FIFO stream mode and release the interrupt pin
+     */
+    void stopFifo();
+    
+    /**
+     * @brief Block until the watermark interrupt fires
+     * 
+     * Without an interrupt pin this simply sleeps for the timeout,
+     * after which the caller drains whatever is buffered.
+     * @param timeoutMs Maximum time to wait
+     * @return true if woken by the interrupt
+     */
+    bool waitForWatermark(uint32_t timeoutMs);
+    
+    /**
+     * @brief Number of frames currently buffered in the FIFO
+     * @return FIFO entries (0-32)
+     */
+    uint8_t fifoEntries();
+    
+    /**
+     * @brief Drain buffered frames from the FIFO
+     * @param xyz Output: interleaved raw X/Y/Z counts (3 per frame)
+     * @param maxFrames Capacity of xyz in frames
+     * @return Number of frames read
+     */
+    size_t readFifo(int16_t* xyz, size_t maxFrames);
+    
+    /**
+     * @brief Number of times the FIFO was found full (possible overrun)
+     */
+    uint32_t getFifoOverruns() const;
+    
+    /**
+     * @brief Select how FIFO drains are submitted
+     * @param mode TransferMode::POLLING or TransferMode::QUEUED
+     */
+    void setTransferMode(TransferMode mode);
+    
+    /**
+     * @brief Get SPI timing counters
+     * @return Snapshot of the counters
+     */
+    SpiStats getSpiStats() const;
+    
+    /**
+     * @brief Reset SPI timing counters
+     */
+    void resetSpiStats();
+    
 private:
+    // Bytes reserved per FIFO frame in the DMA buffers: command + 6 data,
+    // padded to a word boundary
+    static constexpr size_t FRAME_STRIDE = 8;
+    
     uint8_t _csPin;
     uint8_t _sensitivity;
     float _scale;
-    SPISettings _spiSettings;
+    
+    // spi_master device and pre-built FIFO drain transactions
+    spi_device_handle_t _spi = nullptr;
+    TransferMode _transferMode = TransferMode::QUEUED;
+    spi_transaction_t _fifoTrans[ADXL313_FIFO_DEPTH];
+    uint8_t* _dmaTx = nullptr;
+    uint8_t* _dmaRx = nullptr;
+    SpiStats _stats = {};
+    
+    // FIFO state
+    uint8_t _intPin = ADXL_INT_NONE;
+    SemaphoreHandle_t _fifoSem = nullptr;
+    uint32_t _fifoOverruns = 0;
+    
+    static void IRAM_ATTR _watermarkISR(void* arg);
     
     /**
      * @brief Write to a register
@@ -96,6 +226,20 @@ private:
      * @param len Number of bytes to read
      */
     void _readBurst(uint8_t reg, uint8_t* buffer, uint8_t len);
+    
+    /**
+     * @brief Run one transaction to completion and account its bus time
+     * @param trans Transaction to execute
+     * @return true if the driver reported success
+     */
+    bool _transmit(spi_transaction_t* trans);
+    
+    /**
+     * @brief Submit frames 0..count-1 of the pre-built FIFO transactions
+     * @param count Number of FIFO entries to pop
+     * @return true if all transactions completed
+     */
+    bool _drainFrames(size_t count);
 };
 
 // Global instance
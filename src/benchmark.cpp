@@ -0,0 +1,370 @@
+/**
+ * ESP32 Vibration Monitoring System - On-target benchmark suite
+ *
+ * Built by the bench environments in place of main.cpp. Runs each stage
+ * of the pipeline on synthetic data once after boot and prints one
+ * "BENCH {json}" line per measurement, followed by "BENCH_DONE":
+ *
+ * - spi:    ADXL313 single-frame reads and FIFO drains per transfer mode
+ * - filter: applyFiltFilt() for 512..8192 samples
+ * - fft:    computeFFT() for 512..8192 samples
+ * - encode: accelfreq line protocol, plain and gzip
+ * - upload: accelfreq writes over HTTP (see scripts/mock_influx.py)
+ * - heap:   free/largest/min-free after each stage
+ *
+ * Cycle counts are the minimum and mean over BENCH_REPEATS runs. The
+ * sensor, WiFi and InfluxDB settings are the stored configuration;
+ * BENCH_INFLUX_URL overrides the write endpoint.
+ */
+
+#include <Arduino.h>
+#include "config.h"
+#include "config_manager.h"
+#include "wifi_manager.h"
+#include "adxl313.h"
+#include "dsp.h"
+#include "influxdb_client.h"
+#include "line_protocol.h"
+#include "gzip_stream.h"
+#include <esp_heap_caps.h>
+#include <esp_timer.h>
+#include <stdarg.h>
+
+#define BENCH_REPEATS           10
+#define BENCH_MIN_SIZE          512
+#define BENCH_MAX_SIZE          8192
+#define BENCH_SAMPLE_RATE_HZ    3200.0f
+#define BENCH_SPI_FRAMES        1000     // Single-frame reads
+#define BENCH_SPI_BURSTS        50       // Full FIFO drains per mode
+#define BENCH_ENCODE_PASSES     5
+#define BENCH_UPLOAD_WRITES     3
+#define BENCH_WIFI_TIMEOUT_MS   20000
+
+// Capture-sized test buffers (allocated once)
+static float* signalBuffer = nullptr;
+static float* workData = nullptr;
+static float* spectrum[3] = { nullptr, nullptr, nullptr };
+static float* freqBins = nullptr;
+
+// ============================================================================
+// Report
+// ============================================================================
+// One machine-readable line: BENCH {"suite":"<suite>",<fields>}
+static void report(const char* suite, const char* fmt, ...) {
+    char fields[224];
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(fields, sizeof(fields), fmt, args);
+    va_end(args);
+    Serial.printf("BENCH {\"suite\":\"%s\",%s}\n", suite, fields);
+}
+
+static void reportHeap(const char* stage) {
+    report("heap", "\"stage\":\"%s\",\"free\":%u,\"largest\":%u,\"min_free\":%u",
+           stage,
+           (unsigned)heap_caps_get_free_size(MALLOC_CAP_8BIT),
+           (unsigned)heap_caps_get_largest_free_block(MALLOC_CAP_8BIT),
+           (unsigned)heap_caps_get_minimum_free_size(MALLOC_CAP_8BIT));
+}
+
+// Min/mean cycles and mean time of BENCH_REPEATS runs of fn
+struct Timing {
+    uint32_t minCycles;
+    uint32_t meanCycles;
+    float meanUs;
+};
+
+template <typename Fn>
+static Timing measure(Fn fn) {
+    Timing t = { UINT32_MAX, 0, 0.0f };
+    uint64_t totalCycles = 0;
+    int64_t startUs = esp_timer_get_time();
+    for (int r = 0; r < BENCH_REPEATS; r++) {
+        uint32_t c0 = ESP.getCycleCount();
+        fn();
+        uint32_t cycles = ESP.getCycleCount() - c0;
+        totalCycles += cycles;
+        if (cycles < t.minCycles) t.minCycles = cycles;
+    }
+    t.meanUs = (float)(esp_timer_get_time() - startUs) / BENCH_REPEATS;
+    t.meanCycles = (uint32_t)(totalCycles / BENCH_REPEATS);
+    return t;
+}
+
+// 80 Hz and 733 Hz tones plus white noise, in g
+static void fillSignal(float* out, size_t len) {
+    randomSeed(1);
+    for (size_t i = 0; i < len; i++) {
+        float t = i / BENCH_SAMPLE_RATE_HZ;
+        float noise = (random(-1000, 1001) / 1000.0f) * 0.01f;
+        out[i] = 0.1f * sinf(2.0f * PI * 80.0f * t) + 0.03f * sinf(2.0f * PI * 733.0f * t) + noise;
+    }
+}
+
+// ============================================================================
+// SPI
+// ============================================================================
+static void benchSpi(const DeviceConfig& cfg) {
+    if (!adxl313.begin(cfg.spi_cs_pin)) {
+        report("spi", "\"skipped\":\"sensor not found\"");
+        return;
+    }
+    adxl313.setSensitivity(cfg.sensitivity);
+    adxl313.setDataRate(ADXL313::rateCodeForHz(3200));
+
+    // Single-frame register reads
+    int16_t x, y, z;
+    int64_t startUs = esp_timer_get_time();
+    for (int i = 0; i < BENCH_SPI_FRAMES; i++) {
+        adxl313.readRaw(x, y, z);
+    }
+    float usPerFrame = (float)(esp_timer_get_time() - startUs) / BENCH_SPI_FRAMES;
+    report("spi", "\"mode\":\"single\",\"frames\":%d,\"us_per_frame\":%.2f,\"bytes_per_s\":%.0f",
+           BENCH_SPI_FRAMES, usPerFrame, 6.0f * 1e6f / usPerFrame);
+
+    // Full FIFO drains; bus time comes from the driver's counters
+    static int16_t frames[ADXL313_FIFO_DEPTH * 3];
+    const ADXL313::TransferMode modes[2] = { ADXL313::TransferMode::POLLING,
+                                             ADXL313::TransferMode::QUEUED };
+    const char* names[2] = { "fifo_polling", "fifo_queued" };
+    for (int m = 0; m < 2; m++) {
+        adxl313.setTransferMode(modes[m]);
+        if (!adxl313.beginFifoStream(ADXL313_FIFO_WATERMARK, ADXL_INT_NONE)) {
+            report("spi", "\"mode\":\"%s\",\"skipped\":\"fifo start failed\"", names[m]);
+            continue;
+        }
+        adxl313.resetSpiStats();
+        size_t total = 0;
+        for (int b = 0; b < BENCH_SPI_BURSTS; b++) {
+            // Let the FIFO fill so every drain is a full burst
+            uint32_t waitStart = millis();
+            while (adxl313.fifoEntries() < ADXL313_FIFO_DEPTH - 1 && millis() - waitStart < 50) {
+                delay(1);
+            }
+            total += adxl313.readFifo(frames, ADXL313_FIFO_DEPTH);
+        }
+        ADXL313::SpiStats stats = adxl313.getSpiStats();
+        adxl313.stopFifo();
+
+        float busUs = total > 0 ? (float)stats.busTimeUs / total : 0.0f;
+        report("spi", "\"mode\":\"%s\",\"frames\":%u,\"bursts\":%lu,\"us_per_frame\":%.2f,"
+                      "\"max_burst_us\":%lu,\"bytes_per_s\":%.0f",
+               names[m], (unsigned)total, (unsigned long)stats.bursts, busUs,
+               (unsigned long)stats.maxBurstUs, busUs > 0.0f ? 6.0f * 1e6f / busUs : 0.0f);
+    }
+    adxl313.setTransferMode(ADXL313::TransferMode::QUEUED);
+}
+
+// ============================================================================
+// DSP
+// ============================================================================
+static void benchFilter() {
+    dsp.designButterworth(1000.0f, BENCH_SAMPLE_RATE_HZ, 4);
+    for (size_t n = BENCH_MIN_SIZE; n <= BENCH_MAX_SIZE; n *= 2) {
+        Timing t = measure([&]() {
+            memcpy(workData, signalBuffer, n * sizeof(float));
+            dsp.applyFiltFilt(workData, n);
+        });
+        report("filter", "\"op\":\"filtfilt\",\"n\":%u,\"min_cycles\":%lu,\"mean_cycles\":%lu,"
+                         "\"mean_us\":%.1f,\"cycles_per_sample\":%.1f",
+               (unsigned)n, (unsigned long)t.minCycles, (unsigned long)t.meanCycles,
+               t.meanUs, (float)t.minCycles / n);
+    }
+}
+
+static void benchFFT() {
+    for (size_t n = BENCH_MIN_SIZE; n <= BENCH_MAX_SIZE; n *= 2) {
+        Timing t = measure([&]() {
+            dsp.computeFFT(signalBuffer, spectrum[0], n);
+        });
+        report("fft", "\"op\":\"rfft_hann\",\"n\":%u,\"min_cycles\":%lu,\"mean_cycles\":%lu,"
+                      "\"mean_us\":%.1f",
+               (unsigned)n, (unsigned long)t.minCycles, (unsigned long)t.meanCycles, t.meanUs);
+    }
+}
+
+// ============================================================================
+// Encoding
+// ============================================================================
+static LineProtocolEncoder encoder;
+static GzipStream gzip;
+
+static bool countSink(void* ctx, const char* data, size_t len) {
+    *(size_t*)ctx += len;
+    return true;
+}
+
+static bool gzipOutSink(void* ctx, const uint8_t* data, size_t len) {
+    *(size_t*)ctx += len;
+    return true;
+}
+
+static bool gzipInSink(void* ctx, const char* data, size_t len) {
+    return gzip.write((const uint8_t*)data, len);
+}
+
+// accelfreq lines as InfluxDBClient::writeFrequencyData() encodes them
+static void encodeSpectrum(size_t numBins) {
+    encoder.setMeasurement("accelfreq");
+    encoder.addTag("operation", "BENCH");
+    encoder.addTag("device_id", "BENCH");
+    encoder.addTag("run_id", "BENCH-1739356800-1");
+    for (size_t i = 1; i < numBins; i++) {
+        encoder.beginLine();
+        encoder.field("frequencies", freqBins[i]);
+        encoder.field("x_freq", spectrum[0][i]);
+        encoder.field("y_freq", spectrum[1][i]);
+        encoder.field("z_freq", spectrum[2][i]);
+        encoder.endLine(1739356800000000000ULL + i * 1000000ULL);
+    }
+    encoder.flush();
+}
+
+static void benchEncode(size_t numBins) {
+    size_t lines = numBins - 1;
+
+    size_t bytes = 0;
+    int64_t startUs = esp_timer_get_time();
+    for (int p = 0; p < BENCH_ENCODE_PASSES; p++) {
+        encoder.begin(countSink, &bytes);
+        encodeSpectrum(numBins);
+    }
+    float us = (float)(esp_timer_get_time() - startUs) / BENCH_ENCODE_PASSES;
+    bytes /= BENCH_ENCODE_PASSES;
+    report("encode", "\"op\":\"line_protocol\",\"lines\":%u,\"bytes\":%u,\"mean_us\":%.0f,"
+                     "\"lines_per_s\":%.0f,\"bytes_per_s\":%.0f",
+           (unsigned)lines, (unsigned)bytes, us, lines * 1e6f / us, bytes * 1e6f / us);
+
+    if (!gzip.allocate()) {
+        report("encode", "\"op\":\"gzip\",\"skipped\":\"out of memory\"");
+        return;
+    }
+    size_t packed = 0;
+    startUs = esp_timer_get_time();
+    for (int p = 0; p < BENCH_ENCODE_PASSES; p++) {
+        gzip.begin(gzipOutSink, &packed);
+        encoder.begin(gzipInSink, nullptr);
+        encodeSpectrum(numBins);
+        gzip.finish();
+    }
+    us = (float)(esp_timer_get_time() - startUs) / BENCH_ENCODE_PASSES;
+    packed /= BENCH_ENCODE_PASSES;
+    report("encode", "\"op\":\"gzip\",\"lines\":%u,\"bytes\":%u,\"bytes_out\":%u,\"mean_us\":%.0f,"
+                     "\"bytes_per_s\":%.0f,\"ratio\":%.2f",
+           (unsigned)lines, (unsigned)bytes, (unsigned)packed, us,
+           bytes * 1e6f / us, packed > 0 ? (float)bytes / packed : 0.0f);
+}
+
+// ============================================================================
+// Upload
+// ============================================================================
+static void benchUpload(const DeviceConfig& cfg, size_t numBins) {
+#ifdef BENCH_INFLUX_URL
+    influxClient.begin(BENCH_INFLUX_URL, "bench", "bench", "bench");
+#else
+    influxClient.begin(cfg.influx_url, cfg.influx_token, cfg.influx_org, cfg.influx_bucket);
+#endif
+    if (!influxClient.isConfigured()) {
+        report("upload", "\"skipped\":\"no endpoint\"");
+        return;
+    }
+
+    if (strlen(cfg.wifi_ssid) > 0) {
+        wifiManager.begin();
+        uint32_t start = millis();
+        while (!wifiManager.isConnected() && millis() - start < BENCH_WIFI_TIMEOUT_MS) {
+            wifiManager.loop();
+            delay(10);
+        }
+    }
+    if (!wifiManager.isConnected()) {
+        report("upload", "\"skipped\":\"wifi not connected\"");
+        return;
+    }
+
+    for (int compress = 0; compress < 2; compress++) {
+        influxClient.setCompression(compress != 0);
+        if (!influxClient.beginSession()) {
+            report("upload", "\"gzip\":%s,\"skipped\":\"connect failed\"", compress ? "true" : "false");
+            continue;
+        }
+        int ok = 0;
+        int64_t startUs = esp_timer_get_time();
+        for (int w = 0; w < BENCH_UPLOAD_WRITES; w++) {
+            ok += influxClient.writeFrequencyData("BENCH", "BENCH", "BENCH-1739356800-1",
+                                                  freqBins, spectrum[0], spectrum[1], spectrum[2],
+                                                  numBins, 1739356800000000000ULL);
+        }
+        float ms = (esp_timer_get_time() - startUs) / 1000.0f;
+        uint32_t wire = influxClient.sessionWireBytes();
+        uint32_t body = influxClient.sessionBytes();
+        influxClient.endSession();
+
+        report("upload", "\"gzip\":%s,\"writes\":%d,\"ok\":%d,\"bytes\":%lu,\"bytes_sent\":%lu,"
+                         "\"ms\":%.0f,\"kbit_per_s\":%.0f,\"rssi\":%d",
+               compress ? "true" : "false", BENCH_UPLOAD_WRITES, ok,
+               (unsigned long)body, (unsigned long)wire, ms,
+               ms > 0.0f ? wire * 8.0f / ms : 0.0f, wifiManager.getRSSI());
+    }
+}
+
+// ============================================================================
+// Setup
+// ============================================================================
+void setup() {
+    Serial.begin(115200);
+    delay(1000);
+
+    Serial.println("\n[Bench] ESP32 Vibration Monitor benchmark suite");
+    configManager.begin();
+    DeviceConfig& cfg = configManager.getConfig();
+
+    report("info", "\"fw\":\"%s\",\"chip\":\"%s\",\"cpu_mhz\":%lu,\"repeats\":%d",
+           FW_VERSION, ESP.getChipModel(), (unsigned long)ESP.getCpuFreqMHz(), BENCH_REPEATS);
+    reportHeap("boot");
+
+    size_t numBins = BENCH_MAX_SIZE / 2 + 1;
+    signalBuffer = (float*)malloc(BENCH_MAX_SIZE * sizeof(float));
+    workData = (float*)malloc(BENCH_MAX_SIZE * sizeof(float));
+    freqBins = (float*)malloc(numBins * sizeof(float));
+    for (int a = 0; a < 3; a++) {
+        spectrum[a] = (float*)malloc(numBins * sizeof(float));
+    }
+    if (!signalBuffer || !workData || !freqBins || !spectrum[0] || !spectrum[1] || !spectrum[2] ||
+        !dsp.begin() || !dsp.allocateWorkspace(BENCH_MAX_SIZE)) {
+        report("info", "\"error\":\"allocation failed\"");
+        Serial.println("BENCH_DONE");
+        return;
+    }
+    fillSignal(signalBuffer, BENCH_MAX_SIZE);
+    reportHeap("buffers");
+
+    benchSpi(cfg);
+    reportHeap("spi");
+
+    benchFilter();
+    reportHeap("filter");
+
+    benchFFT();
+    reportHeap("fft");
+
+    // Realistic spectra for the encoders and the upload
+    for (int a = 0; a < 3; a++) {
+        dsp.computeFFT(signalBuffer, spectrum[a], BENCH_MAX_SIZE);
+    }
+    for (size_t i = 0; i < numBins; i++) {
+        freqBins[i] = DSP::binToFrequency(i, BENCH_MAX_SIZE, BENCH_SAMPLE_RATE_HZ);
+    }
+
+    benchEncode(numBins);
+    reportHeap("encode");
+
+    benchUpload(cfg, numBins);
+    reportHeap("upload");
+
+    Serial.println("BENCH_DONE");
+}
+
+void loop() {
+    delay(1000);
+}
@@ -3,14 +3,42 @@
 
 #include <Arduino.h>
 
+// Reported in accelrunmeta and journal records
+#define FW_VERSION          "1.1.0"
+
 // ============================================================================
-// Default Pin Mappings (ESP32-WROOM-32 VSPI)
+// Default Pin Mappings
 // ============================================================================
+#if CONFIG_IDF_TARGET_ESP32S3
+// ESP32-S3: FSPI IO_MUX pins (GPIO 19/20 are USB, 22-25 do not exist)
+#define DEFAULT_SPI_MOSI    11
+#define DEFAULT_SPI_MISO    13
+#define DEFAULT_SPI_CLK     12
+#define DEFAULT_SPI_CS      10
+#define DEFAULT_AUX_CS_1    14   // Further sensors on the same bus
+#define DEFAULT_AUX_CS_2    15
+#define DEFAULT_AUX_CS_3    17
+#else
+// ESP32-WROOM-32: VSPI
 #define DEFAULT_SPI_MOSI    23
 #define DEFAULT_SPI_MISO    19
 #define DEFAULT_SPI_CLK     18
 #define DEFAULT_SPI_CS      5
+#define DEFAULT_AUX_CS_1    17   // Further sensors on the same bus
+#define DEFAULT_AUX_CS_2    21
+#define DEFAULT_AUX_CS_3    22
+#endif
 #define DEFAULT_PLC_TRIGGER 4
+#define DEFAULT_ADXL_INT    16   // ADXL313 INT1 (FIFO watermark)
+#define ADXL_INT_NONE       0xFF // INT1 not wired: FIFO is polled on timeout
+#define MAX_SENSORS         4    // ADXL313s sharing the SPI bus (config layout size)
+// Sensors the SPI host can address: each needs a hardware CS line, and
+// VSPI on the classic ESP32 has three (FSPI on the S3 has six)
+#if CONFIG_IDF_TARGET_ESP32S3
+#define SPI_MAX_SENSORS     4
+#else
+#define SPI_MAX_SENSORS     3
+#endif
 
 // ============================================================================
 // ADXL313 Registers
@@ -19,10 +47,25 @@
 #define ADXL313_POWER_CTL   0x2D
 #define ADXL313_DATA_FORMAT 0x31
 #define ADXL313_BW_RATE     0x2C
+#define ADXL313_INT_ENABLE  0x2E
+#define ADXL313_INT_MAP     0x2F
+#define ADXL313_INT_SOURCE  0x30
 #define ADXL313_DATAX0      0x32
+#define ADXL313_FIFO_CTL    0x38
+#define ADXL313_FIFO_STATUS 0x39
 #define ADXL313_READ_BIT    0x80
 #define ADXL313_MULTI_BIT   0x40
 
+// INT_ENABLE / INT_MAP / INT_SOURCE bits
+#define ADXL313_INT_DATA_READY 0x80
+#define ADXL313_INT_WATERMARK  0x02
+#define ADXL313_INT_OVERRUN    0x01
+
+// FIFO_CTL modes (bits 7:6), watermark in bits 4:0
+#define ADXL313_FIFO_BYPASS    0x00
+#define ADXL313_FIFO_STREAM    0x80
+#define ADXL313_FIFO_DEPTH     32
+
 // Sensitivity ranges
 #define ADXL313_RANGE_0_5G  0  // ±0.5g
 #define ADXL313_RANGE_1G    1  // ±1g
@@ -43,11 +86,46 @@ constexpr float ADXL313_SCALE[] = {
 #define DEFAULT_SAMPLE_COUNT     4096    // Power-of-2 window for FFT consistency
 #define DEFAULT_SAMPLE_RATE_HZ   3200    // Maximum ADXL313 rate
 #define DEFAULT_FILTER_CUTOFF_HZ 1600    // Nyquist / 2 for anti-aliasing
+#define ADXL313_FIFO_WATERMARK   16      // Frames per watermark interrupt (of 32)
+
+// Low-pass filter modes (DeviceConfig::filter_mode)
+#define FILTER_MODE_ZERO_PHASE   0       // filtfilt after the capture
+#define FILTER_MODE_STREAMING    1       // Causal, applied per chunk during ingest
 
 // Maximum values (for buffer allocation)
 #define MAX_SAMPLE_COUNT         8000
+#define MAX_RAW_SAMPLE_COUNT     16384   // Raw capture keeps 6 bytes/frame
 #define MAX_OPERATION_ID_LEN     32
 
+// ============================================================================
+// Task Configuration
+// ============================================================================
+#define ACQ_TASK_CORE            1       // Sensor capture, isolated from WiFi
+#define ACQ_TASK_PRIORITY        (configMAX_PRIORITIES - 2)
+#define ACQ_TASK_STACK           4096
+#define PROC_TASK_CORE           0       // DSP and upload, alongside WiFi
+#define PROC_TASK_PRIORITY       2
+#define PROC_TASK_STACK          12288
+
+// Pre-trigger history
+#define PRETRIGGER_MAX_PCT       90      // Largest pre-trigger share of a run
+#define PRETRIGGER_MARGIN_FRAMES 256     // History beyond the pre-trigger share
+
+// Continuous monitoring: per-block RMS check between captures
+#define MONITOR_BLOCK_FRAMES     256     // Frames per detector block (80 ms at 3200 Hz)
+#define MONITOR_EWMA_ALPHA       0.05f   // Baseline adaptation per block
+#define MONITOR_WARMUP_BLOCKS    32      // Blocks before the change detector arms
+#define MONITOR_HOLDOFF_MS       30000   // Minimum time between detected events
+
+// Frame ring between the tasks: runs that can wait behind the one being
+// processed, plus slack so capture never waits on the consumer
+#define ACQ_QUEUED_RUNS          1
+#define ACQ_RING_SLACK_FRAMES    512
+
+// Sample timing: chunk stamps kept per run and sensor (all of them enter
+// the ODR fit, the first ACQ_MAX_CHUNK_STAMPS also the jitter figure)
+#define ACQ_MAX_CHUNK_STAMPS     256
+
 // ============================================================================
 // WiFi Configuration
 // ============================================================================
@@ -61,6 +139,84 @@ constexpr float ADXL313_SCALE[] = {
 #define INFLUX_WRITE_BATCH_SIZE  500     // Points per HTTP request
 #define INFLUX_RETRY_COUNT       3
 #define INFLUX_TIMEOUT_MS        10000
+#define INFLUX_CHUNK_BYTES       1400    // Encoder chunk, about one TCP segment
+#define INFLUX_PREWARM           1       // Connect at capture start, before the upload
+
+// Spectrum upload formats (DeviceConfig::spectrum_format)
+#define SPECTRUM_FORMAT_LINES    0       // One accelfreq point per bin
+#define SPECTRUM_FORMAT_PACKED   1       // One accelspectrum point, uint16 base64 arrays
+
+// ============================================================================
+// Welch Averaging
+// ============================================================================
+#define WELCH_MIN_SEGMENT        256     // Smallest segment (power of 2)
+#define WELCH_MAX_OVERLAP_PCT    75
+
+// ============================================================================
+// Decimation
+// ============================================================================
+#define DECIMATION_MAX           16      // Largest integer factor
+#define DECIMATION_PASSBAND      0.8f    // Anti-alias cutoff, share of the new Nyquist
+#define DECIMATION_GAIN          4       // Stored counts per sensor LSB after filtering
+
+// ============================================================================
+// Zoom FFT
+// ============================================================================
+#define ZOOM_MAX_FACTOR          64      // Largest decimation (power of 2)
+#define ZOOM_MIN_BINS            64      // Smallest zoomed transform
+
+// ============================================================================
+// Feature Extraction
+// ============================================================================
+#define FEATURE_BANDS            4       // Band energies per axis
+#define FEATURE_VELOCITY_MIN_HZ  10.0f   // Lower limit of velocity RMS (ISO 10816)
+#define FEATURE_VELOCITY_MAX_HZ  1000.0f // Upper limit, clipped to Nyquist
+
+// ============================================================================
+// Run Journal (store-and-forward on LittleFS)
+// ============================================================================
+#define JOURNAL_DIR              "/journal"
+#define JOURNAL_MAX_BYTES        (1024 * 1024)   // Upper limit, lowered to fit the partition
+#define JOURNAL_FS_RESERVE       (64 * 1024)     // Web files and LittleFS metadata
+#define JOURNAL_MAX_RECORDS      64
+#define JOURNAL_DRAIN_INTERVAL_MS 5000           // Idle time between replays
+
+// ============================================================================
+// Spectral Baseline (run-over-run diff on LittleFS)
+// ============================================================================
+#define BASELINE_DIR             "/baseline"
+#define BASELINE_TOP_K           8       // Changed bins reported per run
+#define BASELINE_BLOCK_BINS      128     // Bins per file read/write
+// Largest baseline footprint: one file per sensor for the longest (raw
+// capture) spectrum, 12 bytes per bin, plus the copy made while updating
+#define BASELINE_MAX_BYTES       ((SPI_MAX_SENSORS + 1) * (MAX_RAW_SAMPLE_COUNT / 2 + 1) * 12)
+
+// ============================================================================
+// Runtime Metrics (/api/metrics, devicehealth point)
+// ============================================================================
+#define METRICS_BUCKETS          96      // Log2 histogram buckets, values up to 2^25
+#define METRICS_MAX_TASKS        4       // Tasks with a tracked stack high-water mark
+
+// ============================================================================
+// Web UI Assets (gzipped by scripts/gzip_assets.py)
+// ============================================================================
+#define WEB_ETAG_FILE            "/etags.txt"
+#define WEB_MAX_ASSETS           8       // Files listed in WEB_ETAG_FILE
+#define WEB_ASSET_CACHE_CONTROL  "public, max-age=31536000, immutable"  // Versioned (?v=<etag>)
+
+// ============================================================================
+// Live View (WebSocket push of each run)
+// ============================================================================
+#define LIVE_WS_PATH             "/ws/live"
+#define LIVE_SPECTRUM_BINS       256     // Most magnitudes per axis and frame
+#define LIVE_MAX_CLIENTS         2       // Further connections are closed
+#define LIVE_FRAME_MAGIC         0x3156494C  // "LIV1"
+
+// ============================================================================
+// Run Download (/api/run/latest.bin, .csv)
+// ============================================================================
+#define RUN_DOWNLOAD_WAIT_MS     2000    // Next run waits this long for downloads
+#define RUN_DOWNLOAD_BLOCK_FRAMES 64     // Frames read from the journal at a time
 
 // ============================================================================
 // Device Configuration Structure
@@ -96,10 +252,70 @@ struct DeviceConfig {
     
     // Runtime flags
     bool send_time_domain;      // Whether to send time-domain data to InfluxDB
+    
+    // ------------------------------------------------------------------------
+    // Fields below were added after the first stored layout. Keep this struct
+    // append-only so ConfigManager can migrate older NVS blobs.
+    // ------------------------------------------------------------------------
+    
+    // FIFO acquisition (layout v1)
+    uint8_t adxl_int_pin;       // ADXL313 INT1 GPIO, ADXL_INT_NONE if not wired
+    bool use_fifo;              // Stream through the sensor FIFO instead of polling
+    
+    // Raw capture (layout v2)
+    bool raw_capture;           // Keep int16 counts, scale in the DSP stage
+    
+    // Upload compression (layout v3)
+    bool influx_gzip;           // Send write bodies with Content-Encoding: gzip
+    
+    // Spectrum encoding (layout v4)
+    uint8_t spectrum_format;    // SPECTRUM_FORMAT_LINES or SPECTRUM_FORMAT_PACKED
+    
+    // Feature extraction (layout v5)
+    bool send_features;         // Upload one accelfeatures point per run
+    bool send_spectrum;         // Upload the spectra (accelfreq/accelspectrum)
+    uint16_t band_edges_hz[FEATURE_BANDS + 1];  // Ascending; band i is [i, i+1)
+    
+    // Welch averaging (layout v6)
+    uint16_t welch_segment;     // Segment length (power of 2), 0 = one FFT over the capture
+    uint8_t welch_overlap_pct;  // Segment overlap, 0..WELCH_MAX_OVERLAP_PCT
+    
+    // Filter mode (layout v7)
+    uint8_t filter_mode;        // FILTER_MODE_ZERO_PHASE or FILTER_MODE_STREAMING
+    
+    // Continuous monitoring (layout v8)
+    bool continuous_mode;       // Trigger captures from the signal itself
+    uint16_t event_rms_mg;      // Absolute block RMS threshold in mg, 0 = off
+    uint8_t event_change_pct;   // Rise over the EWMA baseline in %, 0 = off
+    uint16_t heartbeat_s;       // Summary upload interval, 0 = off
+    
+    // Pre-trigger capture (layout v9)
+    uint8_t pretrigger_pct;     // Share of each run before the trigger edge, 0 = off
+    
+    // Multiple sensors (layout v10)
+    uint8_t sensor_count;       // 1..MAX_SENSORS; sensor 0 uses spi_cs_pin
+    uint8_t aux_cs_pins[MAX_SENSORS - 1];   // CS of sensors 1..3
+    
+    // Zoom FFT (layout v11)
+    uint16_t zoom_center_hz;    // Center of the zoomed band
+    uint8_t zoom_factor;        // Decimation 2..ZOOM_MAX_FACTOR (power of 2), 0 = full spectrum
+    
+    // Decimation stage (layout v12)
+    uint8_t decimation;         // Sensor frames per stored frame, 1 = off
+    
+    // Spectral baseline (layout v13)
+    uint8_t baseline_alpha_pct; // Weight of each run in the baseline, 0 = off
+    bool changes_only;          // Skip spectra while the deviation stays small
+    uint8_t change_threshold_pct;   // Deviation score that counts as a change
+    
+    // Device health (layout v14)
+    uint16_t health_s;          // devicehealth upload interval, 0 = off
 };
 
-// Magic number for config validation
-#define CONFIG_MAGIC 0xADC31300
+// Magic number for config validation; low byte is the layout version
+#define CONFIG_MAGIC_BASE 0xADC31300
+#define CONFIG_VERSION    14
+#define CONFIG_MAGIC      (CONFIG_MAGIC_BASE | CONFIG_VERSION)
 
 // Default configuration
 inline DeviceConfig getDefaultConfig() {
@@ -134,6 +350,60 @@ inline DeviceConfig getDefaultConfig() {
     // Time-domain data disabled by default to save memory/bandwidth
     cfg.send_time_domain = false;
     
+    // FIFO acquisition
+    cfg.adxl_int_pin = DEFAULT_ADXL_INT;
+    cfg.use_fifo = true;
+    
+    // Float buffers by default; raw capture halves the capture footprint
+    cfg.raw_capture = false;
+    cfg.influx_gzip = false;
+    
+    // Per-bin lines stay the default for existing dashboards
+    cfg.spectrum_format = SPECTRUM_FORMAT_LINES;
+    
+    // Features on top of the spectra; bands split the default 1600 Hz cutoff
+    cfg.send_features = true;
+    cfg.send_spectrum = true;
+    static const uint16_t defaultEdges[FEATURE_BANDS + 1] = { 10, 100, 500, 1000, 1600 };
+    memcpy(cfg.band_edges_hz, defaultEdges, sizeof(cfg.band_edges_hz));
+    
+    // Single FFT by default; Welch uses the usual 50% overlap
+    cfg.welch_segment = 0;
+    cfg.welch_overlap_pct = 50;
+    
+    // Zero-phase filtering matches the original scipy processing
+    cfg.filter_mode = FILTER_MODE_ZERO_PHASE;
+    
+    // Triggered by PLC/API unless continuous monitoring is enabled
+    cfg.continuous_mode = false;
+    cfg.event_rms_mg = 0;
+    cfg.event_change_pct = 50;
+    cfg.heartbeat_s = 300;
+    
+    // Capture starts at the trigger edge
+    cfg.pretrigger_pct = 0;
+    
+    // One sensor; the others only count once sensor_count is raised
+    cfg.sensor_count = 1;
+    cfg.aux_cs_pins[0] = DEFAULT_AUX_CS_1;
+    cfg.aux_cs_pins[1] = DEFAULT_AUX_CS_2;
+    cfg.aux_cs_pins[2] = DEFAULT_AUX_CS_3;
+    
+    // Full spectrum; zooming needs a band chosen for the machine
+    cfg.zoom_center_hz = 0;
+    cfg.zoom_factor = 0;
+    
+    // Runs are stored at the sensor rate
+    cfg.decimation = 1;
+    
+    // No baseline; spectra are uploaded every run
+    cfg.baseline_alpha_pct = 0;
+    cfg.changes_only = false;
+    cfg.change_threshold_pct = 25;
+    
+    // Self-telemetry at the heartbeat rate
+    cfg.health_s = 300;
+    
     return cfg;
 }
 
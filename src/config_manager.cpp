@@ -1,11 +1,36 @@
 #include "config_manager.h"
 #include <Preferences.h>
 #include <WiFi.h>
+#include <stddef.h>
 
 // NVS namespace and key
 static const char* NVS_NAMESPACE = "vibsensor";
 static const char* NVS_KEY = "config";
 
+// Unpadded end of each stored DeviceConfig layout, indexed by version
+// (low byte of the magic). Older blobs are migrated by copying this prefix
+// over the defaults, so newly appended fields pick up their default values.
+static const size_t LAYOUT_END[] = {
+    offsetof(DeviceConfig, send_time_domain) + sizeof(bool),   // v0
+    offsetof(DeviceConfig, use_fifo) + sizeof(bool),           // v1
+    offsetof(DeviceConfig, raw_capture) + sizeof(bool),        // v2
+    offsetof(DeviceConfig, influx_gzip) + sizeof(bool),        // v3
+    offsetof(DeviceConfig, spectrum_format) + sizeof(uint8_t), // v4
+    offsetof(DeviceConfig, band_edges_hz) + sizeof(DeviceConfig::band_edges_hz), // v5
+    offsetof(DeviceConfig, welch_overlap_pct) + sizeof(uint8_t), // v6
+    offsetof(DeviceConfig, filter_mode) + sizeof(uint8_t),     // v7
+    offsetof(DeviceConfig, heartbeat_s) + sizeof(uint16_t),    // v8
+    offsetof(DeviceConfig, pretrigger_pct) + sizeof(uint8_t),  // v9
+    offsetof(DeviceConfig, aux_cs_pins) + sizeof(DeviceConfig::aux_cs_pins), // v10
+    offsetof(DeviceConfig, zoom_factor) + sizeof(uint8_t),     // v11
+    offsetof(DeviceConfig, decimation) + sizeof(uint8_t),      // v12
+    offsetof(DeviceConfig, change_threshold_pct) + sizeof(uint8_t),    // v13
+    offsetof(DeviceConfig, health_s) + sizeof(uint16_t),       // v14
+};
+static const size_t NUM_LAYOUTS = sizeof(LAYOUT_END) / sizeof(LAYOUT_END[0]);
+
+static_assert(NUM_LAYOUTS == CONFIG_VERSION + 1, "Add a LAYOUT_END entry for the new config version");
+
 // Global instance
 ConfigManager configManager;
 
@@ -24,16 +49,35 @@ bool ConfigManager::load() {
         return false;
     }
     
-    size_t len = prefs.getBytes(NVS_KEY, &_config, sizeof(DeviceConfig));
+    DeviceConfig stored;
+    size_t len = prefs.getBytes(NVS_KEY, &stored, sizeof(DeviceConfig));
     prefs.end();
     
-    // Validate magic number
-    if (len != sizeof(DeviceConfig) || _config.magic != CONFIG_MAGIC) {
+    // Validate magic number (version byte selects the stored layout)
+    uint32_t version = stored.magic & 0xFF;
+    if (len < LAYOUT_END[0] || (stored.magic & ~0xFFu) != CONFIG_MAGIC_BASE ||
+        version >= NUM_LAYOUTS || len < LAYOUT_END[version]) {
         Serial.println("[Config] Invalid or missing config, loading defaults");
         resetToDefaults();
         return false;
     }
     
+    if (version != CONFIG_VERSION) {
+        _config = getDefaultConfig();
+        memcpy(&_config, &stored, LAYOUT_END[version]);
+        _config.magic = CONFIG_MAGIC;
+        Serial.printf("[Config] Migrated config layout v%u -> v%u\n",
+                      (unsigned)version, (unsigned)CONFIG_VERSION);
+    } else {
+        _config = stored;
+    }
+    
+    // A count saved for another target may exceed this SPI host's CS lines
+    if (_config.sensor_count < 1 || _config.sensor_count > SPI_MAX_SENSORS) {
+        _config.sensor_count = constrain(_config.sensor_count, 1, SPI_MAX_SENSORS);
+        Serial.printf("[Config] Sensor count limited to %u\n", (unsigned)_config.sensor_count);
+    }
+    
     Serial.println("[Config] Loaded configuration from NVS");
     Serial.printf("[Config] Operation ID: %s\n", _config.operation_id);
     Serial.printf("[Config] Sensitivity: %d\n", _config.sensitivity);
@@ -62,9 +106,17 @@ bool ConfigManager::save() {
     }
     
     Serial.println("[Config] Configuration saved to NVS");
+    
+    if (_saveCallback) {
+        _saveCallback();
+    }
     return true;
 }
 
+void ConfigManager::setSaveCallback(void (*callback)()) {
+    _saveCallback = callback;
+}
+
 void ConfigManager::resetToDefaults() {
     _config = getDefaultConfig();
     Serial.println("[Config] Reset to default configuration");
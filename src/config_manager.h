@@ -29,6 +29,14 @@ public:
      */
     bool save();
     
+    /**
+     * @brief Set a function to call after the config was saved
+     * 
+     * Used to invalidate state derived from the config (DSP caches).
+     * @param callback Function to call after a successful save
+     */
+    void setSaveCallback(void (*callback)());
+    
     /**
      * @brief Reset configuration to factory defaults
      */
@@ -68,6 +76,7 @@ private:
     DeviceConfig _config;
     bool _initialized = false;
     String _deviceId;
+    void (*_saveCallback)() = nullptr;
     
     void _generateDeviceId();
 };
@@ -1,10 +1,50 @@
 #include "dsp.h"
 #include <math.h>
+#include <esp_heap_caps.h>
 
 // ESP-DSP library for hardware-accelerated FFT
 #include "esp_dsp.h"
 #include "dsps_fft2r.h"
 #include "dsps_wind_hann.h"
+#include "dsps_wind_flat_top.h"
+
+// ============================================================================
+// Kernel Selection
+// ============================================================================
+// Build flags (set per environment in platformio.ini):
+//   DSP_FFT_RADIX4=1     complex FFT through dsps_fft4r_fc32
+//   DSP_BIQUAD_KERNEL=1  SOS cascade through dsps_biquad_f32
+// ESP-DSP maps these entry points to its ae32 (ESP32) or aes3 (ESP32-S3
+// SIMD) implementation for the build target, as it already does for
+// dsps_fft2r_fc32. Without the flags the radix-2 FFT and the scalar
+// Direct Form II Transposed loop are used.
+#ifndef DSP_FFT_RADIX4
+#define DSP_FFT_RADIX4 0
+#endif
+#ifndef DSP_BIQUAD_KERNEL
+#define DSP_BIQUAD_KERNEL 0
+#endif
+
+#if DSP_FFT_RADIX4
+#include "dsps_fft4r.h"
+#endif
+#if DSP_BIQUAD_KERNEL
+#include "dsps_biquad.h"
+#endif
+
+// In-place complex FFT with bit reversal; n complex points
+static void complexFFT(float* data, size_t n) {
+#if DSP_FFT_RADIX4
+    // Radix-4 needs an even power of two; other lengths use radix-2
+    if ((__builtin_ctz(n) & 1) == 0) {
+        dsps_fft4r_fc32(data, n);
+        dsps_bit_rev4r_fc32(data, n);
+        return;
+    }
+#endif
+    dsps_fft2r_fc32(data, n);
+    dsps_bit_rev_fc32(data, n);
+}
 
 // Global instance
 DSP dsp;
@@ -17,11 +57,144 @@ bool DSP::begin() {
         return false;
     }
     
+#if DSP_FFT_RADIX4
+    ret = dsps_fft4r_init_fc32(NULL, CONFIG_DSP_MAX_FFT_SIZE);
+    if (ret != ESP_OK) {
+        Serial.printf("[DSP] Radix-4 FFT init failed: %d\n", ret);
+        return false;
+    }
+#endif
+    
+    Serial.printf("[DSP] Kernels: FFT %s, filter %s\n",
+                  DSP_FFT_RADIX4 ? "radix-4" : "radix-2",
+                  DSP_BIQUAD_KERNEL ? "dsps_biquad_f32" : "scalar SOS");
     Serial.println("[DSP] Initialized successfully");
     return true;
 }
 
+void DSP::_freeWorkspace() {
+    if (_fftBuffer) { heap_caps_free(_fftBuffer); _fftBuffer = nullptr; }
+    if (_twiddle) { heap_caps_free(_twiddle); _twiddle = nullptr; }
+    _twiddleLen = 0;
+    for (int i = 0; i < WINDOW_CACHE_SLOTS; i++) {
+        if (_windows[i].table) heap_caps_free(_windows[i].table);
+        _windows[i] = {};
+    }
+    _fftCapacity = 0;
+}
+
+bool DSP::allocateWorkspace(size_t sampleCount) {
+    size_t fftLen = nextPowerOf2(sampleCount);
+    if (fftLen < 4) fftLen = 4;
+    if (_fftBuffer && _twiddle && _windows[0].table && fftLen <= _fftCapacity) {
+        return true;
+    }
+    
+    _freeWorkspace();
+    
+    // 16-byte alignment keeps the buffers usable by the SIMD kernels.
+    // Only the first window slot is allocated up front; the second is
+    // allocated the first time a second window type/length is used.
+    _fftBuffer = (float*)heap_caps_aligned_alloc(16, fftLen * sizeof(float), MALLOC_CAP_8BIT);
+    _twiddle = (float*)heap_caps_aligned_alloc(16, (fftLen / 4 + 1) * sizeof(float), MALLOC_CAP_8BIT);
+    _windows[0].table = (float*)heap_caps_aligned_alloc(16, fftLen * sizeof(float), MALLOC_CAP_8BIT);
+    
+    if (!_fftBuffer || !_twiddle || !_windows[0].table) {
+        Serial.println("[DSP] Workspace allocation failed!");
+        _freeWorkspace();
+        return false;
+    }
+    
+    _fftCapacity = fftLen;
+    
+    Serial.printf("[DSP] Workspace allocated: FFT length %d (%d bytes)\n",
+                  fftLen, getWorkspaceBytes());
+    return true;
+}
+
+size_t DSP::getWorkspaceBytes() const {
+    size_t floats = _fftCapacity + (_twiddle ? _fftCapacity / 4 + 1 : 0);
+    for (int i = 0; i < WINDOW_CACHE_SLOTS; i++) {
+        if (_windows[i].table) floats += _fftCapacity;
+    }
+    return floats * sizeof(float);
+}
+
+void DSP::invalidateCaches() {
+    _cachesStale = true;
+}
+
+void DSP::_flushStaleCaches() {
+    if (!_cachesStale) return;
+    _cachesStale = false;
+    
+    for (int i = 0; i < WINDOW_CACHE_SLOTS; i++) {
+        _windows[i].len = 0;
+    }
+    for (int i = 0; i < SOS_CACHE_SLOTS; i++) {
+        _sosCache[i].order = 0;
+    }
+    Serial.println("[DSP] Caches invalidated");
+}
+
+const float* DSP::_getWindow(WindowType type, size_t len) {
+    _flushStaleCaches();
+    _cacheClock++;
+    
+    int victim = 0;
+    for (int i = 0; i < WINDOW_CACHE_SLOTS; i++) {
+        WindowSlot& slot = _windows[i];
+        if (slot.len == len && slot.type == type && slot.table) {
+            slot.lastUse = _cacheClock;
+            return slot.table;
+        }
+        if (slot.lastUse < _windows[victim].lastUse) {
+            victim = i;
+        }
+    }
+    
+    // Miss: rebuild the least recently used slot
+    WindowSlot& slot = _windows[victim];
+    if (!slot.table) {
+        slot.table = (float*)heap_caps_aligned_alloc(16, _fftCapacity * sizeof(float), MALLOC_CAP_8BIT);
+        if (!slot.table) {
+            Serial.println("[DSP] Window table allocation failed!");
+            return nullptr;
+        }
+    }
+    
+    if (type == WindowType::FLAT_TOP) {
+        dsps_wind_flat_top_f32(slot.table, len);
+    } else {
+        dsps_wind_hann_f32(slot.table, len);
+    }
+    slot.len = len;
+    slot.type = type;
+    slot.lastUse = _cacheClock;
+    return slot.table;
+}
+
 void DSP::designButterworth(float cutoffHz, float sampleRateHz, uint8_t order) {
+    _flushStaleCaches();
+    _cacheClock++;
+    
+    // Reuse a cached design if the parameters match
+    int victim = 0;
+    for (int i = 0; i < SOS_CACHE_SLOTS; i++) {
+        SosSlot& slot = _sosCache[i];
+        if (slot.order == order && slot.cutoffHz == cutoffHz &&
+            slot.sampleRateHz == sampleRateHz) {
+            slot.lastUse = _cacheClock;
+            memcpy(_sos, slot.sos, sizeof(_sos));
+            _numSections = slot.numSections;
+            _resetState();
+            return;
+        }
+        if (slot.lastUse < _sosCache[victim].lastUse) {
+            victim = i;
+        }
+    }
+    
     // Normalize cutoff frequency
     float nyquist = sampleRateHz / 2.0f;
     float wn = cutoffHz / nyquist;
@@ -70,6 +243,15 @@ void DSP::designButterworth(float cutoffHz, float sampleRateHz, uint8_t order) {
     
     _resetState();
     
+    // Store in the least recently used cache slot
+    SosSlot& slot = _sosCache[victim];
+    slot.cutoffHz = cutoffHz;
+    slot.sampleRateHz = sampleRateHz;
+    slot.order = order;
+    slot.numSections = _numSections;
+    memcpy(slot.sos, _sos, sizeof(_sos));
+    slot.lastUse = _cacheClock;
+    
     Serial.printf("[DSP] Butterworth filter designed: %.1f Hz cutoff, order %d, %d sections\n",
                   cutoffHz, order, _numSections);
 }
@@ -81,10 +263,9 @@ void DSP::_resetState() {
     }
 }
 
-float DSP::_processSample(float x, int section) {
+float DSP::_processSample(float x, float* z, int section) {
     // Direct Form II Transposed
     float* b = _sos[section];
-    float* z = _state[section];
     
     float y = b[0] * x + z[0];
     z[0] = b[1] * x - b[3] * y + z[1];
@@ -93,22 +274,92 @@ float DSP::_processSample(float x, int section) {
     return y;
 }
 
+float DSP::_processCascade(float x, float (*state)[2]) {
+    for (int s = 0; s < _numSections; s++) {
+        x = _processSample(x, state[s], s);
+    }
+    return x;
+}
+
+void DSP::_filterBlock(float* data, size_t len, float (*state)[2]) {
+#if DSP_BIQUAD_KERNEL
+    // Section-major: each SOS runs over the whole block in the ESP-DSP
+    // kernel (Direct Form II, works in place). From zero state this
+    // matches the per-sample cascade.
+    for (int s = 0; s < _numSections; s++) {
+        dsps_biquad_f32(data, data, len, _sos[s], state[s]);
+    }
+#else
+    for (size_t i = 0; i < len; i++) {
+        data[i] = _processCascade(data[i], state);
+    }
+#endif
+}
+
 void DSP::applyFilter(float* data, size_t len) {
+    _filterBlock(data, len, _state);
+}
+
+void DSP::initFilterState(FilterState& state, float x0) {
+    float x = x0;
+    for (int s = 0; s < _numSections; s++) {
+        const float* b = _sos[s];
+        float dcGain = (b[0] + b[1] + b[2]) / (1.0f + b[3] + b[4]);
+        float y = dcGain * x;
+#if DSP_BIQUAD_KERNEL
+        // Direct Form II: both delay taps hold the steady internal signal
+        float w = x / (1.0f + b[3] + b[4]);
+        state.z[s][0] = w;
+        state.z[s][1] = w;
+#else
+        // Transposed form: the taps hold the pending partial sums
+        state.z[s][0] = y - b[0] * x;
+        state.z[s][1] = b[2] * x - b[4] * y;
+#endif
+        x = y;
+    }
+}
+
+void DSP::applyFilter(float* data, size_t len, FilterState& state) {
+    _filterBlock(data, len, state.z);
+}
+
+void DSP::applyFilter(const int16_t* input, size_t stride, float scale,
+                      float* output, size_t len, FilterState& state) {
+#if DSP_BIQUAD_KERNEL
     for (size_t i = 0; i < len; i++) {
-        float x = data[i];
-        for (int s = 0; s < _numSections; s++) {
-            x = _processSample(x, s);
-        }
-        data[i] = x;
+        output[i] = input[i * stride] * scale;
+    }
+    _filterBlock(output, len, state.z);
+#else
+    for (size_t i = 0; i < len; i++) {
+        output[i] = _processCascade(input[i * stride] * scale, state.z);
     }
+#endif
 }
 
-void DSP::_reverseArray(float* data, size_t len) {
-    for (size_t i = 0; i < len / 2; i++) {
-        float temp = data[i];
-        data[i] = data[len - 1 - i];
-        data[len - 1 - i] = temp;
+void DSP::_filterBackward(float* data, size_t len) {
+#if DSP_BIQUAD_KERNEL
+    // The kernel only runs forward: feed it blocks from the end, each
+    // reversed through a small scratch buffer, with the state carried over
+    size_t end = len;
+    while (end > 0) {
+        size_t n = end < FILTER_BLOCK ? end : FILTER_BLOCK;
+        float* src = data + end - n;
+        for (size_t i = 0; i < n; i++) {
+            _block[i] = src[n - 1 - i];
+        }
+        _filterBlock(_block, n, _state);
+        for (size_t i = 0; i < n; i++) {
+            src[n - 1 - i] = _block[i];
+        }
+        end -= n;
     }
+#else
+    for (size_t i = len; i-- > 0; ) {
+        data[i] = _processCascade(data[i], _state);
+    }
+#endif
 }
 
 void DSP::applyFiltFilt(float* data, size_t len) {
@@ -116,73 +367,321 @@ void DSP::applyFiltFilt(float* data, size_t len) {
     _resetState();
     applyFilter(data, len);
     
-    // Reverse data
-    _reverseArray(data, len);
+    // Backward pass, walking the data from the end
+    _resetState();
+    _filterBackward(data, len);
+}
+
+void DSP::applyFiltFilt(const int16_t* input, size_t stride, float scale,
+                        float* output, size_t len) {
+    // Forward pass doubles as the scaling/deinterleave pass
+    _resetState();
+#if DSP_BIQUAD_KERNEL
+    for (size_t i = 0; i < len; i++) {
+        output[i] = input[i * stride] * scale;
+    }
+    applyFilter(output, len);
+#else
+    for (size_t i = 0; i < len; i++) {
+        output[i] = _processCascade(input[i * stride] * scale, _state);
+    }
+#endif
     
     // Backward pass
     _resetState();
-    applyFilter(data, len);
+    _filterBackward(output, len);
+}
+
+void DSP::_buildTwiddle(size_t fftLen) {
+    // Quarter-wave cosine: cos(2*pi*k/N) for k = 0..N/4
+    size_t quarter = fftLen / 4;
+    for (size_t k = 0; k <= quarter; k++) {
+        _twiddle[k] = cosf(2.0f * M_PI * (float)k / (float)fftLen);
+    }
+    _twiddleLen = fftLen;
+}
+
+float DSP::windowPowerGain(size_t len, WindowType window) {
+    size_t fftLen = nextPowerOf2(len);
+    if (fftLen < 4) fftLen = 4;
     
-    // Reverse back to original order
-    _reverseArray(data, len);
+    if (!allocateWorkspace(len)) {
+        return 0.0f;
+    }
+    const float* table = _getWindow(window, fftLen);
+    if (!table) {
+        return 0.0f;
+    }
+    
+    float sum = 0.0f;
+    for (size_t i = 0; i < len && i < fftLen; i++) {
+        sum += table[i] * table[i];
+    }
+    return sum / (float)fftLen;
 }
 
-size_t DSP::computeFFT(float* input, float* output, size_t len, float sampleRateHz) {
+bool DSP::_prepareFFT(size_t len, WindowType window, size_t& fftLen, const float*& table) {
     // Ensure length is power of 2
-    size_t fftLen = nextPowerOf2(len);
+    fftLen = nextPowerOf2(len);
+    if (fftLen < 4) fftLen = 4;
     
-    // Allocate interleaved complex array (real, imag pairs)
-    float* fftData = (float*)malloc(fftLen * 2 * sizeof(float));
-    if (!fftData) {
-        Serial.println("[DSP] FFT malloc failed!");
-        return 0;
+    // The complex transform is half the real length
+    if (fftLen / 2 > CONFIG_DSP_MAX_FFT_SIZE) {
+        Serial.printf("[DSP] FFT length %d exceeds table size %d\n",
+                      fftLen, 2 * CONFIG_DSP_MAX_FFT_SIZE);
+        return false;
     }
     
-    // Copy input and zero-pad if necessary
-    for (size_t i = 0; i < fftLen; i++) {
-        if (i < len) {
-            fftData[i * 2] = input[i];      // Real part
+    // Scratch comes from the workspace; this only allocates if the
+    // workspace was never sized for this length.
+    if (!allocateWorkspace(len)) {
+        return false;
+    }
+    
+    // Window tables are cached per length and type
+    table = _getWindow(window, fftLen);
+    if (!table) {
+        return false;
+    }
+    if (_twiddleLen != fftLen) {
+        _buildTwiddle(fftLen);
+    }
+    return true;
+}
+
+void DSP::_realSpectrum(size_t fftLen, float* output, bool accumulatePower) {
+    float* z = _fftBuffer;
+    size_t half = fftLen / 2;
+    
+    // Perform N/2-point complex FFT (natural order output)
+    complexFFT(z, half);
+    
+    // Split Z into the real-input spectrum X[k], k = 0..N/2:
+    //   E[k] = (Z[k] + conj(Z[N/2-k])) / 2
+    //   O[k] = -j * (Z[k] - conj(Z[N/2-k])) / 2
+    //   X[k] = E[k] + W^k * O[k],  W = exp(-j*2*pi/N)
+    size_t quarter = fftLen / 4;
+    float scale = 2.0f / (float)fftLen;
+    
+    // DC and Nyquist are real and are not doubled
+    float dc = fabsf(z[0] + z[1]) * scale / 2.0f;
+    float nyquist = fabsf(z[0] - z[1]) * scale / 2.0f;
+    if (accumulatePower) {
+        output[0] += dc * dc;
+        output[half] += nyquist * nyquist;
+    } else {
+        output[0] = dc;
+        output[half] = nyquist;
+    }
+    
+    for (size_t k = 1; k < half; k++) {
+        float ar = z[k * 2];
+        float ai = z[k * 2 + 1];
+        float br = z[(half - k) * 2];
+        float bi = z[(half - k) * 2 + 1];
+        
+        float er = 0.5f * (ar + br);
+        float ei = 0.5f * (ai - bi);
+        float orr = 0.5f * (ai + bi);
+        float oi = -0.5f * (ar - br);
+        
+        // cos/sin(2*pi*k/N) from the quarter-wave table
+        float c, sn;
+        if (k <= quarter) {
+            c = _twiddle[k];
+            sn = _twiddle[quarter - k];
+        } else {
+            c = -_twiddle[half - k];
+            sn = _twiddle[k - quarter];
+        }
+        
+        float real = er + c * orr + sn * oi;
+        float imag = ei + c * oi - sn * orr;
+        float power = (real * real + imag * imag) * scale * scale;
+        if (accumulatePower) {
+            output[k] += power;
         } else {
-            fftData[i * 2] = 0.0f;          // Zero-padding
+            output[k] = sqrtf(power);
         }
-        fftData[i * 2 + 1] = 0.0f;          // Imaginary part
+    }
+}
+
+size_t DSP::computeFFT(const float* input, float* output, size_t len, WindowType window) {
+    size_t fftLen;
+    const float* table;
+    if (!_prepareFFT(len, window, fftLen, table)) {
+        return 0;
+    }
+    
+    // Pack the windowed real signal as N/2 complex points:
+    // z[n] = x[2n] + j*x[2n+1] (zero-padded past len)
+    float* z = _fftBuffer;
+    for (size_t i = 0; i < fftLen; i++) {
+        z[i] = i < len ? input[i] * table[i] : 0.0f;
+    }
+    
+    _realSpectrum(fftLen, output, false);
+    return fftLen / 2 + 1;
+}
+
+size_t DSP::computeZoomFFT(const float* input, float* output, size_t len, float sampleRateHz,
+                           float nominalRateHz, float centerHz, size_t factor) {
+    size_t fftLen = nextPowerOf2(len);
+    if (factor < 2 || (factor & (factor - 1)) != 0 || fftLen / factor < 4) {
+        return 0;
+    }
+    size_t bins = fftLen / factor;
+    if (bins > CONFIG_DSP_MAX_FFT_SIZE) {
+        Serial.printf("[DSP] Zoom FFT length %d exceeds table size %d\n",
+                      bins, CONFIG_DSP_MAX_FFT_SIZE);
+        return 0;
+    }
+    
+    // Complex samples need two floats each
+    if (!allocateWorkspace(2 * bins)) {
+        return 0;
+    }
+    const float* table = _getWindow(WindowType::HANN, bins);
+    if (!table) {
+        return 0;
     }
     
-    // Apply Hann window
-    float* window = (float*)malloc(fftLen * sizeof(float));
-    if (window) {
-        dsps_wind_hann_f32(window, fftLen);
-        for (size_t i = 0; i < fftLen; i++) {
-            fftData[i * 2] *= window[i];
+    // Anti-alias filter through the coefficient cache; the main design
+    // is restored afterwards
+    float mainSos[MAX_SOS][5];
+    int mainSections = _numSections;
+    memcpy(mainSos, _sos, sizeof(mainSos));
+    designButterworth(ZOOM_PASSBAND * nominalRateHz / (2.0f * factor), nominalRateHz, 4);
+    
+    // Mean removed, so gravity does not leak into a band near DC
+    float sum = 0.0f;
+    for (size_t i = 0; i < len; i++) {
+        sum += input[i];
+    }
+    float mean = sum / (float)len;
+    
+    // Mixer as a unit phasor rotated every sample instead of sin/cos per
+    // sample; renormalized now and then against rounding drift
+    float w = -2.0f * (float)M_PI * centerHz / sampleRateHz;
+    float rotR = cosf(w), rotI = sinf(w);
+    float phR = 1.0f, phI = 0.0f;
+    
+    float stateI[MAX_SOS][2] = {};
+    float stateQ[MAX_SOS][2] = {};
+    float* z = _fftBuffer;
+    size_t kept = 0;
+    for (size_t i = 0; i < len && kept < bins; i++) {
+        float x = input[i] - mean;
+        float re = _processCascade(x * phR, stateI);
+        float im = _processCascade(x * phI, stateQ);
+        if ((i & (factor - 1)) == factor - 1) {
+            z[kept * 2] = re * table[kept];
+            z[kept * 2 + 1] = im * table[kept];
+            kept++;
         }
-        free(window);
+        
+        float r = phR * rotR - phI * rotI;
+        phI = phR * rotI + phI * rotR;
+        phR = r;
+        if ((i & 0xFF) == 0xFF) {
+            float mag = sqrtf(phR * phR + phI * phI);
+            phR /= mag;
+            phI /= mag;
+        }
+    }
+    for (size_t k = kept; k < bins; k++) {
+        z[k * 2] = 0.0f;
+        z[k * 2 + 1] = 0.0f;
     }
     
-    // Perform FFT
-    dsps_fft2r_fc32(fftData, fftLen);
+    memcpy(_sos, mainSos, sizeof(_sos));
+    _numSections = mainSections;
     
-    // Bit-reverse
-    dsps_bit_rev_fc32(fftData, fftLen);
+    complexFFT(z, bins);
     
-    // Calculate magnitude spectrum (single-sided)
-    size_t numBins = fftLen / 2 + 1;
-    float scale = 2.0f / (float)fftLen;
+    // Negative offsets first; the mixer halved the amplitude, so 2 / bins
+    // matches computeFFT()'s single-sided scale
+    float scale = 2.0f / (float)bins;
+    for (size_t k = 0; k < bins; k++) {
+        size_t src = (k + bins / 2) & (bins - 1);
+        float re = z[src * 2];
+        float im = z[src * 2 + 1];
+        output[k] = sqrtf(re * re + im * im) * scale;
+    }
+    return bins;
+}
+
+template <typename T>
+bool DSP::_accumulateSegment(const T* input, size_t stride, float scale, size_t len,
+                             float* powerSum) {
+    size_t fftLen;
+    const float* table;
+    if ((len & (len - 1)) != 0 || !_prepareFFT(len, WindowType::HANN, fftLen, table)) {
+        return false;
+    }
+    
+    // Constant detrend, so gravity does not leak into the low bins
+    float sum = 0.0f;
+    for (size_t i = 0; i < len; i++) {
+        sum += (float)input[i * stride];
+    }
+    float mean = sum / (float)len;
     
-    for (size_t i = 0; i < numBins; i++) {
-        float real = fftData[i * 2];
-        float imag = fftData[i * 2 + 1];
-        output[i] = sqrtf(real * real + imag * imag) * scale;
+    float* z = _fftBuffer;
+    for (size_t i = 0; i < len; i++) {
+        z[i] = ((float)input[i * stride] - mean) * scale * table[i];
     }
     
-    // DC and Nyquist components are not doubled
-    output[0] /= 2.0f;
-    if (numBins > 1) {
-        output[numBins - 1] /= 2.0f;
+    _realSpectrum(fftLen, powerSum, true);
+    return true;
+}
+
+bool DSP::accumulateSpectrum(const float* input, size_t stride, float scale, size_t len,
+                             float* powerSum) {
+    return _accumulateSegment(input, stride, scale, len, powerSum);
+}
+
+bool DSP::accumulateSpectrum(const int16_t* input, size_t stride, float scale, size_t len,
+                             float* powerSum) {
+    return _accumulateSegment(input, stride, scale, len, powerSum);
+}
+
+void DSP::finishSpectrum(float* powerSum, size_t numBins, size_t segments,
+                         float sampleRateHz, bool filtered) {
+    if (segments == 0) {
+        return;
     }
     
-    free(fftData);
+    // Zero-phase filtering applies |H|^2 to the amplitude
+    size_t fftLen = (numBins - 1) * 2;
+    for (size_t k = 0; k < numBins; k++) {
+        float amplitude = sqrtf(powerSum[k] / (float)segments);
+        if (filtered) {
+            float h = filterGain(binToFrequency(k, fftLen, sampleRateHz), sampleRateHz);
+            amplitude *= h * h;
+        }
+        powerSum[k] = amplitude;
+    }
+}
+
+float DSP::filterGain(float freqHz, float sampleRateHz) {
+    // |H(e^jw)| of the cascade: each section is (b0 + b1 z^-1 + b2 z^-2) /
+    // (1 + a1 z^-1 + a2 z^-2) evaluated at z = e^jw
+    float w = 2.0f * (float)M_PI * freqHz / sampleRateHz;
+    float c1 = cosf(w), s1 = sinf(w);
+    float c2 = cosf(2.0f * w), s2 = sinf(2.0f * w);
     
-    return numBins;
+    float gain = 1.0f;
+    for (int s = 0; s < _numSections; s++) {
+        const float* b = _sos[s];
+        float nr = b[0] + b[1] * c1 + b[2] * c2;
+        float ni = -(b[1] * s1 + b[2] * s2);
+        float dr = 1.0f + b[3] * c1 + b[4] * c2;
+        float di = -(b[3] * s1 + b[4] * s2);
+        float den = dr * dr + di * di;
+        gain *= den > 0.0f ? sqrtf((nr * nr + ni * ni) / den) : 0.0f;
+    }
+    return gain;
 }
 
 float DSP::binToFrequency(size_t binIndex, size_t numSamples, float sampleRateHz) {
@@ -3,6 +3,14 @@
 
 #include <Arduino.h>
 
+/**
+ * @brief FFT window functions
+ */
+enum class WindowType : uint8_t {
+    HANN,       // Default; good frequency resolution
+    FLAT_TOP    // Accurate peak amplitudes, wide main lobe
+};
+
 /**
  * @brief Digital Signal Processing functions for vibration analysis
  * 
@@ -11,14 +19,52 @@
  */
 class DSP {
 public:
+    // Butterworth filter coefficients (Second Order Sections for stability)
+    static constexpr int MAX_ORDER = 4;
+    static constexpr int MAX_SOS = MAX_ORDER / 2;  // Number of second-order sections
+    
+    /**
+     * @brief Filter state carried between chunks of one signal
+     */
+    struct FilterState {
+        float z[MAX_SOS][2];
+    };
+    
     /**
      * @brief Initialize DSP module
      * @return true if initialization successful
      */
     bool begin();
     
+    /**
+     * @brief Allocate the reusable DSP workspace
+     * 
+     * Sized once for the largest capture; holds the FFT scratch buffer
+     * and the window table cache so that no allocation happens per
+     * measurement. Only grows if called with a larger size.
+     * @param sampleCount Largest number of samples that will be processed
+     * @return true if the workspace is available
+     */
+    bool allocateWorkspace(size_t sampleCount);
+    
+    /**
+     * @brief Total bytes held by the workspace
+     */
+    size_t getWorkspaceBytes() const;
+    
+    /**
+     * @brief Drop cached window tables and filter coefficients
+     * 
+     * Safe to call from any task; the caches are cleared by the next
+     * DSP call on the processing side. Called when the config is saved.
+     */
+    void invalidateCaches();
+    
     /**
      * @brief Design Butterworth low-pass filter coefficients
+     * 
+     * Coefficient sets are cached per cutoff/rate/order, so calling this
+     * every measurement only redesigns when the parameters change.
      * @param cutoffHz Cutoff frequency in Hz
      * @param sampleRateHz Sample rate in Hz
      * @param order Filter order (default 4)
@@ -32,26 +78,160 @@ public:
      */
     void applyFilter(float* data, size_t len);
     
+    /**
+     * @brief Prepare a streaming filter state
+     * 
+     * Sets the state to the steady state for a constant input x0, so a
+     * signal with a DC offset (gravity) does not start with a step
+     * transient.
+     * @param state State to initialize
+     * @param x0 First input sample
+     */
+    void initFilterState(FilterState& state, float x0);
+    
+    /**
+     * @brief Causal filtering of one chunk of a stream (in-place)
+     * 
+     * Chunks of one signal must be passed in order with the same state;
+     * the result equals filtering the whole signal at once.
+     * @param data Chunk samples (modified in place)
+     * @param len Number of samples
+     * @param state Per-signal state, see initFilterState()
+     */
+    void applyFilter(float* data, size_t len, FilterState& state);
+    
+    /**
+     * @brief Causal filtering of one chunk straight from raw sensor counts
+     * @param input Raw counts, one axis every `stride` elements
+     * @param stride Distance between consecutive samples (3 for XYZ frames)
+     * @param scale Conversion factor (g per LSB)
+     * @param output Filtered samples in g (len elements)
+     * @param len Number of samples
+     * @param state Per-signal state, see initFilterState()
+     */
+    void applyFilter(const int16_t* input, size_t stride, float scale,
+                     float* output, size_t len, FilterState& state);
+    
     /**
      * @brief Apply forward-backward filtering (like scipy filtfilt)
      * 
      * Applies filter forward then backward to achieve zero phase shift.
+     * The backward pass walks the data from the end, so the array is
+     * never reversed.
      * @param data Array of samples (modified in place)
      * @param len Number of samples
      */
     void applyFiltFilt(float* data, size_t len);
     
+    /**
+     * @brief Zero-phase filtering straight from raw sensor counts
+     * 
+     * Deinterleaves and scales raw int16 counts in the forward filter
+     * pass, so no float copy of the capture is needed beforehand.
+     * @param input Raw counts, one axis every `stride` elements
+     * @param stride Distance between consecutive samples (3 for XYZ frames)
+     * @param scale Conversion factor (g per LSB)
+     * @param output Filtered samples in g (len elements)
+     * @param len Number of samples
+     */
+    void applyFiltFilt(const int16_t* input, size_t stride, float scale,
+                       float* output, size_t len);
+    
     /**
      * @brief Compute Real FFT magnitude spectrum
      * 
      * Computes single-sided amplitude spectrum from real input data.
-     * @param input Input time-domain data (will be modified!)
+     * The real signal is packed as N/2 complex points and transformed
+     * with a half-length complex FFT followed by a split step, so
+     * lengths up to twice CONFIG_DSP_MAX_FFT_SIZE are supported.
+     * @param input Input time-domain data (not modified)
      * @param output Output frequency-domain magnitudes
      * @param len Number of input samples (zero-padded internally to next power of 2)
-     * @param sampleRateHz Sample rate for frequency calculation
+     * @param window Window applied before the transform
      * @return Number of frequency bins (len/2 + 1)
      */
-    size_t computeFFT(float* input, float* output, size_t len, float sampleRateHz);
+    size_t computeFFT(const float* input, float* output, size_t len,
+                      WindowType window = WindowType::HANN);
+    
+    /**
+     * @brief Band-limited high-resolution spectrum (zoom FFT)
+     * 
+     * The signal is mean-removed and mixed down by centerHz, low-pass
+     * filtered with a Butterworth SOS cascade at ZOOM_PASSBAND of the
+     * zoomed band's Nyquist while being decimated by factor, then
+     * Hann-windowed and transformed with a fftLen / factor point complex
+     * FFT (fftLen = len padded to a power of 2). Resolution equals a
+     * full-length FFT over the same samples, at 1/factor of the
+     * transform size and workspace. The designed main filter is kept.
+     * @param input Input time-domain data (not modified)
+     * @param output fftLen / factor magnitudes, lowest frequency first;
+     *               bin k lies at centerHz + (k - bins / 2) * sampleRateHz / fftLen
+     * @param len Number of input samples
+     * @param sampleRateHz Measured sample rate in Hz, for the mixer
+     * @param nominalRateHz Nominal sample rate in Hz, for the anti-alias
+     *                      filter, so its design stays cached across runs
+     * @param centerHz Center of the band in Hz
+     * @param factor Decimation factor (power of 2, >= 2); the band is
+     *               sampleRateHz / factor wide
+     * @return Number of bins, 0 on error
+     */
+    size_t computeZoomFFT(const float* input, float* output, size_t len, float sampleRateHz,
+                          float nominalRateHz, float centerHz, size_t factor);
+    
+    /**
+     * @brief Add one segment's power spectrum to a Welch average
+     * 
+     * The segment is detrended (mean removed), Hann-windowed and
+     * transformed; the squared amplitudes, scaled as in computeFFT(),
+     * are added to powerSum. Segments can be fed as soon as they are
+     * captured. Call finishSpectrum() after the last one.
+     * @param input First sample of the segment
+     * @param stride Distance between consecutive samples (3 for XYZ frames)
+     * @param scale Factor applied to the samples (1, or g per LSB for counts)
+     * @param len Segment length (power of 2)
+     * @param powerSum len/2 + 1 accumulators, zeroed before the first segment
+     * @return false if len is invalid or the workspace is too small
+     */
+    bool accumulateSpectrum(const float* input, size_t stride, float scale, size_t len,
+                            float* powerSum);
+    bool accumulateSpectrum(const int16_t* input, size_t stride, float scale, size_t len,
+                            float* powerSum);
+    
+    /**
+     * @brief Turn accumulated power into an averaged amplitude spectrum
+     * 
+     * Output is in the same units as computeFFT(): sqrt(mean power) per
+     * bin. With filtered set, the response of the designed low-pass is
+     * applied as filtfilt would (|H|^2), since segments are taken from
+     * the unfiltered capture.
+     * @param powerSum Accumulators, replaced by the amplitudes
+     * @param numBins Number of bins (segment length / 2 + 1)
+     * @param segments Number of segments accumulated
+     * @param sampleRateHz Sample rate in Hz
+     * @param filtered Apply the current filter's response
+     */
+    void finishSpectrum(float* powerSum, size_t numBins, size_t segments,
+                        float sampleRateHz, bool filtered);
+    
+    /**
+     * @brief Magnitude response of the designed filter (one pass)
+     * @param freqHz Frequency in Hz
+     * @param sampleRateHz Sample rate in Hz
+     * @return |H(f)|
+     */
+    float filterGain(float freqHz, float sampleRateHz);
+    
+    /**
+     * @brief Mean square of the window as applied by computeFFT()
+     * 
+     * Sum of w[n]^2 over the len input samples divided by the padded
+     * FFT length. Converts summed squared magnitudes back to signal
+     * power: rms^2 = sum(output[k]^2) / (2 * windowPowerGain()).
+     * @param len Number of input samples, as passed to computeFFT()
+     * @param window Window passed to computeFFT()
+     * @return Power gain (0.375 for an unpadded Hann window), 0 on error
+     */
+    float windowPowerGain(size_t len, WindowType window = WindowType::HANN);
     
     /**
      * @brief Get frequency value for a given FFT bin
@@ -70,20 +250,67 @@ public:
     static size_t nextPowerOf2(size_t n);
     
 private:
-    // Butterworth filter coefficients (Second Order Sections for stability)
-    static constexpr int MAX_ORDER = 4;
-    static constexpr int MAX_SOS = MAX_ORDER / 2;  // Number of second-order sections
-    
     // SOS coefficients: each section has [b0, b1, b2, a1, a2] (a0 = 1)
     float _sos[MAX_SOS][5];
     int _numSections;
     
-    // Filter state for each section
+    // Filter state for each section (filtfilt passes)
     float _state[MAX_SOS][2];
     
+    // Scratch for the block-reversed backward pass of the biquad kernel
+    static constexpr size_t FILTER_BLOCK = 256;
+    float _block[FILTER_BLOCK];
+    
+    // Zoom FFT anti-alias cutoff, as a share of the zoomed band's Nyquist
+    static constexpr float ZOOM_PASSBAND = 0.8f;
+    
+    // Workspace (see allocateWorkspace)
+    float* _fftBuffer = nullptr;    // Interleaved complex, _fftCapacity / 2 points
+    float* _twiddle = nullptr;      // Quarter-wave cosine, _fftCapacity / 4 + 1
+    size_t _fftCapacity = 0;
+    size_t _twiddleLen = 0;         // FFT length the twiddle table was built for
+    
+    // Window table cache; tables hold _fftCapacity entries and are
+    // reused for whichever length/type a slot is assigned to
+    static constexpr int WINDOW_CACHE_SLOTS = 2;
+    struct WindowSlot {
+        float* table;
+        size_t len;             // 0 = empty
+        WindowType type;
+        uint32_t lastUse;
+    };
+    WindowSlot _windows[WINDOW_CACHE_SLOTS] = {};
+    
+    // Filter coefficient cache
+    static constexpr int SOS_CACHE_SLOTS = 4;
+    struct SosSlot {
+        float cutoffHz;
+        float sampleRateHz;
+        uint8_t order;          // 0 = empty
+        int numSections;
+        float sos[MAX_SOS][5];
+        uint32_t lastUse;
+    };
+    SosSlot _sosCache[SOS_CACHE_SLOTS] = {};
+    
+    uint32_t _cacheClock = 0;
+    volatile bool _cachesStale = false;
+    
+    void _freeWorkspace();
+    void _flushStaleCaches();
+    const float* _getWindow(WindowType type, size_t len);
+    void _buildTwiddle(size_t fftLen);
+    bool _prepareFFT(size_t len, WindowType window, size_t& fftLen, const float*& table);
+    void _realSpectrum(size_t fftLen, float* output, bool accumulatePower);
+    template <typename T>
+    bool _accumulateSegment(const T* input, size_t stride, float scale, size_t len,
+                            float* powerSum);
+    
     void _resetState();
-    float _processSample(float x, int section);
-    void _reverseArray(float* data, size_t len);
+    float _processSample(float x, float* z, int section);
+    float _processCascade(float x, float (*state)[2]);
+    void _filterBlock(float* data, size_t len, float (*state)[2]);
+    void _filterBackward(float* data, size_t len);
 };
 
 // Global instance
@@ -0,0 +1,97 @@
+// Generated by scripts/gzip_assets.py from web/fallback.html; do not edit.
+#ifndef FALLBACK_PAGE_H
+#define FALLBACK_PAGE_H
+
+#include <Arduino.h>
+
+// Setup page served when no filesystem image was uploaded (3906 bytes)
+static const uint8_t FALLBACK_PAGE_GZ[] PROGMEM = {
+    0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0xad, 0x57, 0x4b, 0x73, 0xe3, 0x44,
+    0x10, 0xbe, 0xe7, 0x57, 0xf4, 0x8a, 0x02, 0xdb, 0x45, 0x2c, 0x4b, 0x4a, 0x9c, 0x75, 0xfc, 0xc8,
+    0x21, 0x9b, 0xa4, 0x08, 0xb5, 0x45, 0x52, 0x49, 0x16, 0x8a, 0x53, 0x6a, 0x24, 0x8d, 0xe4, 0x21,
+    0xb2, 0x46, 0xcc, 0x8c, 0xec, 0x98, 0x54, 0xee, 0xdc, 0xa0, 0x80, 0x3b, 0x47, 0x4e, 0x1c, 0xf6,
+    0xc2, 0x91, 0xc3, 0xfe, 0x22, 0x7e, 0x02, 0x3d, 0x7a, 0xd8, 0xf2, 0x2b, 0x4e, 0x16, 0x74, 0xb0,
+    0x25, 0x4d, 0xf7, 0xd7, 0x0f, 0x75, 0x7f, 0x3d, 0xd3, 0x7f, 0x75, 0x72, 0xf1, 0xe6, 0xe6, 0xdb,
+    0xcb, 0x53, 0x18, 0xaa, 0x51, 0x74, 0xb4, 0xd3, 0x2f, 0xff, 0x28, 0xf1, 0x8f, 0x76, 0x00, 0xaf,
+    0xfe, 0x88, 0x2a, 0x02, 0xde, 0x90, 0x08, 0x49, 0xd5, 0xc0, 0x78, 0x77, 0x73, 0xd6, 0xec, 0x18,
+    0xd5, 0xa5, 0x98, 0x8c, 0xe8, 0xc0, 0x18, 0x33, 0x3a, 0x49, 0xb8, 0x50, 0x06, 0x78, 0x3c, 0x56,
+    0x34, 0x46, 0xd1, 0x09, 0xf3, 0xd5, 0x70, 0xe0, 0xd3, 0x31, 0xf3, 0x68, 0x33, 0x7b, 0xd8, 0x05,
+    0x16, 0x33, 0xc5, 0x48, 0xd4, 0x94, 0x1e, 0x89, 0xe8, 0xc0, 0x36, 0xad, 0x12, 0x4a, 0x31, 0x15,
+    0xd1, 0xa3, 0xaf, 0x99, 0x2b, 0x88, 0x62, 0x3c, 0x86, 0x6b, 0x1a, 0x4b, 0x2e, 0xf0, 0x4f, 0xa5,
+    0x49, 0xbf, 0x95, 0xaf, 0xe6, 0x92, 0x52, 0x4d, 0xcb, 0x7b, 0x7d, 0xb9, 0xdc, 0x9f, 0xc2, 0x03,
+    0x04, 0x68, 0xb5, 0x19, 0x90, 0x11, 0x8b, 0xa6, 0x5d, 0x68, 0x92, 0x24, 0x89, 0x68, 0x53, 0x4e,
+    0xa5, 0xa2, 0xa3, 0x5d, 0x90, 0x24, 0x96, 0x4d, 0x49, 0x05, 0x0b, 0x7a, 0xe0, 0x12, 0xef, 0x2e,
+    0x14, 0x3c, 0x8d, 0xfd, 0x2e, 0x7c, 0x62, 0x13, 0x9b, 0x38, 0xb4, 0x87, 0x2e, 0x47, 0x5c, 0xe0,
+    0x73, 0x60, 0x07, 0xed, 0xe0, 0xb0, 0x07, 0x33, 0xf0, 0xe2, 0x4a, 0x88, 0xef, 0xb3, 0x38, 0xec,
+    0x82, 0x63, 0x25, 0xf7, 0x3d, 0x18, 0x91, 0xfb, 0x3c, 0x9e, 0x2e, 0xb4, 0xad, 0xe2, 0x8d, 0x08,
+    0x59, 0xdc, 0x05, 0x0b, 0x48, 0xaa, 0x78, 0x0f, 0x1e, 0x67, 0x08, 0x43, 0x1b, 0x9d, 0x2b, 0xf1,
+    0xf7, 0xdc, 0x8e, 0x13, 0x1c, 0x54, 0x97, 0x4d, 0x8f, 0x08, 0x1f, 0x25, 0x16, 0xdd, 0xa2, 0xce,
+    0xe1, 0x9e, 0xdb, 0x5b, 0x36, 0xeb, 0x72, 0xe1, 0x53, 0xd1, 0x14, 0xc4, 0x67, 0xa9, 0xec, 0x82,
+    0xed, 0x54, 0x2d, 0x6b, 0x11, 0xb0, 0xaa, 0xd0, 0x11, 0x71, 0x69, 0x84, 0xd0, 0x3e, 0x93, 0x49,
+    0x44, 0x30, 0x2b, 0x6e, 0xc4, 0xbd, 0xbb, 0xb9, 0x86, 0x9d, 0x69, 0x40, 0x5b, 0xa3, 0x94, 0x0e,
+    0x1e, 0xee, 0x13, 0xf4, 0xb1, 0x8a, 0xc2, 0xe2, 0x24, 0x55, 0x88, 0x52, 0xc4, 0x6b, 0x5b, 0xd6,
+    0xa7, 0x15, 0xc7, 0x72, 0x1f, 0x96, 0x1c, 0xeb, 0xcc, 0xdf, 0xa1, 0x04, 0x1a, 0x91, 0x3c, 0x62,
+    0x3e, 0x46, 0xbf, 0xb7, 0x6f, 0xb7, 0xdb, 0xbd, 0xe5, 0xe4, 0x2e, 0xc6, 0x6e, 0x05, 0xf6, 0x6b,
+    0x87, 0xac, 0x7e, 0x12, 0x97, 0xdf, 0x37, 0x25, 0xfb, 0x21, 0xb3, 0x5a, 0xd8, 0xc3, 0x57, 0x55,
+    0x4f, 0xdd, 0x54, 0x29, 0x2c, 0x9c, 0x8d, 0xae, 0xee, 0x6f, 0x73, 0x35, 0xe6, 0x31, 0x2d, 0xd3,
+    0xd3, 0x54, 0x3c, 0x29, 0xf2, 0xbe, 0xe2, 0xef, 0x82, 0xc3, 0x11, 0x8b, 0x29, 0x11, 0xcd, 0x50,
+    0x23, 0x62, 0xd5, 0xd7, 0xed, 0xbd, 0xb6, 0x4f, 0xc3, 0xdd, 0xf2, 0x5b, 0xe3, 0x8d, 0xd3, 0x3e,
+    0xd8, 0xa3, 0x6e, 0x63, 0x16, 0xd2, 0x64, 0xc8, 0x14, 0x5d, 0xad, 0x31, 0xc8, 0x4b, 0x78, 0x42,
+    0x59, 0x38, 0x54, 0x3a, 0xc6, 0xc8, 0x47, 0x95, 0x54, 0x48, 0xad, 0x93, 0x70, 0x86, 0x4d, 0x25,
+    0x16, 0x2a, 0x67, 0x42, 0x44, 0xbc, 0x5c, 0x39, 0xaf, 0x3d, 0xc7, 0xb7, 0x9d, 0x6a, 0xd4, 0xd6,
+    0xa6, 0xa8, 0x8b, 0x38, 0x5d, 0x8e, 0x59, 0x1b, 0x95, 0x25, 0x96, 0xc3, 0xf7, 0x5b, 0x45, 0x8f,
+    0xf5, 0x5b, 0x39, 0x0f, 0xf4, 0x75, 0x93, 0x15, 0xed, 0x37, 0xb4, 0x8f, 0xfe, 0xf9, 0xfd, 0xb7,
+    0x3f, 0x60, 0xb9, 0x55, 0x51, 0xd6, 0xce, 0x45, 0x72, 0xb9, 0x80, 0x8b, 0x11, 0x30, 0x7f, 0x60,
+    0x48, 0xdd, 0xc2, 0x67, 0xf8, 0x64, 0xcc, 0x9b, 0xb6, 0xef, 0xb3, 0x31, 0x78, 0x11, 0x91, 0x72,
+    0x60, 0xe8, 0x0e, 0xa8, 0x2c, 0xe5, 0x46, 0x1c, 0x34, 0xf2, 0xeb, 0x5f, 0xf0, 0x0d, 0x3b, 0x63,
+    0x08, 0xec, 0x2c, 0x2d, 0x67, 0xa5, 0x7d, 0x74, 0x7d, 0x7d, 0x7e, 0xd2, 0x6f, 0xe5, 0xf7, 0x8b,
+    0xeb, 0x79, 0xd1, 0xaa, 0x69, 0x82, 0xc4, 0xa4, 0xe8, 0x3d, 0x92, 0x92, 0x76, 0x64, 0xc2, 0x02,
+    0x76, 0x2b, 0x25, 0xf3, 0x0d, 0x10, 0xf4, 0xfb, 0x94, 0x09, 0xea, 0xaf, 0xc5, 0xbd, 0x44, 0xb7,
+    0x26, 0x98, 0xb1, 0xed, 0xd8, 0x49, 0x21, 0x59, 0xc1, 0x9f, 0xbd, 0xaa, 0x04, 0xdb, 0xc2, 0x68,
+    0xe7, 0x8f, 0x2f, 0x4c, 0xc2, 0x8f, 0x70, 0x1e, 0x07, 0x51, 0x7a, 0x7f, 0x72, 0xbc, 0x31, 0x11,
+    0xef, 0xae, 0xde, 0xbe, 0x24, 0x0f, 0x2c, 0xc3, 0xbb, 0x4d, 0x45, 0x64, 0x00, 0x32, 0x83, 0x47,
+    0x87, 0x58, 0x6b, 0x54, 0x0c, 0x8c, 0xa1, 0x52, 0x49, 0xb7, 0xd5, 0xb2, 0x0f, 0x1d, 0xd3, 0x3e,
+    0xe8, 0x98, 0xb6, 0x89, 0x2d, 0xd4, 0xed, 0x58, 0x9d, 0x03, 0x63, 0xad, 0xd9, 0x1b, 0x7e, 0x47,
+    0xe3, 0x97, 0x26, 0xa9, 0x30, 0xae, 0xb4, 0xee, 0x7a, 0xd8, 0x0b, 0x11, 0x7e, 0x44, 0x34, 0x5c,
+    0x84, 0x06, 0x8c, 0x49, 0x94, 0xe2, 0x22, 0xbd, 0x4f, 0xa8, 0x50, 0x4c, 0xd2, 0xf5, 0x06, 0x8e,
+    0x53, 0xef, 0x8e, 0xaa, 0x8f, 0xb0, 0xe1, 0x66, 0x8a, 0x4f, 0x9a, 0xf9, 0x4f, 0xdf, 0xfa, 0xa7,
+    0x3f, 0xe1, 0x02, 0x21, 0xb3, 0xae, 0xda, 0xf8, 0xb1, 0x67, 0x12, 0xf0, 0xb2, 0xea, 0xe7, 0xa5,
+    0xde, 0xad, 0x6e, 0x80, 0x85, 0xef, 0xfe, 0xf6, 0xf0, 0xe2, 0xf2, 0xc0, 0xb2, 0xfe, 0xb7, 0x92,
+    0xfd, 0x79, 0x4e, 0x09, 0x1b, 0x3a, 0x17, 0x97, 0x71, 0x1f, 0x30, 0x66, 0x6a, 0x0a, 0x57, 0x24,
+    0x0e, 0xe9, 0xfa, 0x40, 0x24, 0x8d, 0xa8, 0xa7, 0x0a, 0x12, 0x99, 0x69, 0x18, 0x90, 0xb1, 0x53,
+    0xb1, 0xbf, 0xe8, 0x66, 0x34, 0x5f, 0xf2, 0x5d, 0x36, 0x8f, 0x16, 0xd9, 0xae, 0x33, 0x7b, 0xd3,
+    0x5d, 0x9d, 0x45, 0x15, 0xf2, 0x2c, 0x27, 0x4f, 0xce, 0xd2, 0xe5, 0xdc, 0x59, 0x0a, 0x30, 0x73,
+    0x8b, 0x27, 0x59, 0xfa, 0x8b, 0x2a, 0xc0, 0xb4, 0x7d, 0x78, 0x6f, 0x99, 0xed, 0x10, 0xea, 0x5f,
+    0x20, 0x75, 0x23, 0xb5, 0xa0, 0x89, 0x54, 0x4b, 0x34, 0xfa, 0xad, 0x5c, 0x74, 0x2b, 0x86, 0xad,
+    0x31, 0xec, 0xf0, 0xd9, 0xf2, 0x0e, 0xe6, 0x20, 0xcb, 0x0d, 0x32, 0xd8, 0x87, 0xf7, 0x0e, 0x9a,
+    0x3e, 0xa1, 0x01, 0x49, 0x23, 0xf5, 0x7c, 0x93, 0x7b, 0xda, 0xe4, 0x7e, 0xe9, 0x34, 0x19, 0x25,
+    0x11, 0x53, 0xa9, 0x4f, 0x37, 0x00, 0xe0, 0x44, 0xc8, 0xec, 0x3d, 0xa3, 0x42, 0x8a, 0x31, 0x9c,
+    0x97, 0x9f, 0x4c, 0xdd, 0x11, 0x53, 0x06, 0x16, 0xc5, 0x2f, 0x7f, 0xc3, 0x35, 0x19, 0x53, 0xf8,
+    0x0c, 0xae, 0xa8, 0xcb, 0x39, 0xb6, 0x5f, 0x2e, 0x58, 0x4c, 0x95, 0x96, 0x1e, 0x17, 0xd5, 0xf1,
+    0x21, 0x3d, 0xc1, 0x92, 0x8a, 0x3d, 0x9f, 0x7b, 0xe9, 0x08, 0x07, 0xac, 0x19, 0x52, 0x75, 0x1a,
+    0x51, 0x7d, 0x7b, 0x3c, 0x3d, 0xf7, 0xeb, 0xb5, 0xd9, 0x78, 0xa9, 0x35, 0x4c, 0x1e, 0xe7, 0x06,
+    0x61, 0x00, 0x44, 0x4e, 0x63, 0x0f, 0xea, 0xb4, 0x01, 0x83, 0x23, 0x78, 0x58, 0x08, 0x86, 0x9a,
+    0x89, 0xa0, 0x63, 0x04, 0x28, 0x92, 0x56, 0x6f, 0x2c, 0xce, 0x78, 0xdc, 0xc0, 0x4a, 0xa5, 0x7f,
+    0x03, 0x16, 0x22, 0xd2, 0xc3, 0x4a, 0x2a, 0x67, 0x83, 0xa4, 0xbb, 0xd9, 0xad, 0x99, 0x0c, 0xba,
+    0x95, 0xa5, 0x7c, 0x77, 0x3d, 0x4c, 0xc9, 0x8e, 0xdb, 0xa0, 0x4a, 0xb9, 0xcd, 0x70, 0x73, 0x5a,
+    0x7f, 0x02, 0x6b, 0x2e, 0xb4, 0x15, 0x28, 0xa3, 0xe8, 0xed, 0x50, 0x99, 0xd8, 0x56, 0x30, 0xa4,
+    0xe7, 0xed, 0x50, 0x28, 0xb4, 0x15, 0x28, 0xe7, 0xe0, 0xed, 0x58, 0xb9, 0xdc, 0x66, 0xb8, 0x2a,
+    0x1d, 0x3e, 0x81, 0x56, 0x15, 0xdb, 0x0c, 0x56, 0x61, 0x27, 0xdc, 0xab, 0xe9, 0x93, 0xd2, 0x39,
+    0x6e, 0x05, 0x9f, 0x28, 0xd9, 0x99, 0x78, 0x89, 0xd9, 0x58, 0xc0, 0x7c, 0x5c, 0x2c, 0x48, 0x25,
+    0xa6, 0x6b, 0xaa, 0x30, 0x2f, 0x53, 0xa4, 0x9b, 0x44, 0x97, 0xfb, 0x84, 0x60, 0xd9, 0x07, 0x54,
+    0x79, 0xc3, 0x7a, 0xad, 0x45, 0x12, 0xd6, 0xca, 0xeb, 0xb7, 0xb6, 0xbb, 0x46, 0x53, 0x5f, 0x78,
+    0x74, 0x1b, 0x72, 0x8c, 0xbc, 0x76, 0x79, 0x71, 0x7d, 0x53, 0xdb, 0x5d, 0x2b, 0xa3, 0x37, 0x7f,
+    0x54, 0xe0, 0x86, 0xf1, 0xa1, 0xf6, 0x26, 0x3f, 0xd4, 0x35, 0x6f, 0xb0, 0xad, 0x6b, 0xa8, 0xa5,
+    0x0f, 0x58, 0xcc, 0xcb, 0x32, 0xd3, 0xfa, 0x4e, 0xf2, 0xb8, 0xf6, 0xb8, 0x1e, 0x42, 0x6f, 0x1c,
+    0xbb, 0xf0, 0xe5, 0xf5, 0xc5, 0x57, 0xa6, 0x54, 0x02, 0x29, 0x9a, 0x05, 0xd3, 0x7a, 0xee, 0x5a,
+    0x63, 0x45, 0xe1, 0xb1, 0xb1, 0xba, 0xd9, 0xc6, 0x63, 0xa2, 0x50, 0xf5, 0x9a, 0xe6, 0x0e, 0xff,
+    0x15, 0x9c, 0x64, 0x87, 0x49, 0xec, 0x9c, 0x28, 0xc2, 0xc8, 0x35, 0x8f, 0x98, 0xa6, 0x59, 0x5b,
+    0x52, 0x7b, 0x04, 0x74, 0x0c, 0xf3, 0x40, 0x85, 0x68, 0xac, 0x89, 0xbe, 0x40, 0x3c, 0x15, 0x42,
+    0xef, 0xac, 0x6b, 0xf0, 0x39, 0x68, 0xc1, 0x25, 0x88, 0x9d, 0xa5, 0x4f, 0x81, 0x04, 0x58, 0x10,
+    0x12, 0x12, 0x57, 0xb6, 0x19, 0xc6, 0xe1, 0x96, 0x1d, 0x95, 0xff, 0x05, 0x81, 0x05, 0x6e, 0x64,
+    0x42, 0x0f, 0x00, 0x00,
+};
+
+#define FALLBACK_PAGE_ETAG "49a19db8"
+
+#endif // FALLBACK_PAGE_H
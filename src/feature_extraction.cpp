@@ -0,0 +1,85 @@
+#include "feature_extraction.h"
+#include <math.h>
+
+static constexpr float G_TO_MM_S2 = 9806.65f;     // 1 g in mm/s^2
+
+void Features::computeTime(const float* x, size_t len, AxisFeatures& out) {
+    out.rms = 0.0f;
+    out.peak = 0.0f;
+    out.crest = 0.0f;
+    out.kurtosis = 0.0f;
+    if (len == 0) {
+        return;
+    }
+
+    // The low-pass output still carries gravity; statistics are about the mean
+    double sum = 0.0;
+    for (size_t i = 0; i < len; i++) {
+        sum += x[i];
+    }
+    float mean = (float)(sum / len);
+
+    double m2 = 0.0;
+    double m4 = 0.0;
+    float peak = 0.0f;
+    for (size_t i = 0; i < len; i++) {
+        float d = x[i] - mean;
+        float d2 = d * d;
+        m2 += d2;
+        m4 += d2 * d2;
+        if (fabsf(d) > peak) peak = fabsf(d);
+    }
+    m2 /= len;
+    m4 /= len;
+
+    out.rms = sqrtf((float)m2);
+    out.peak = peak;
+    if (m2 > 0.0) {
+        out.crest = peak / out.rms;
+        out.kurtosis = (float)(m4 / (m2 * m2));
+    }
+}
+
+void Features::computeSpectral(const float* magnitude, size_t numBins, size_t fftSize,
+                               float sampleRateHz, float windowPower,
+                               const uint16_t* bandEdgesHz, AxisFeatures& out) {
+    out.velocityRms = 0.0f;
+    for (int b = 0; b < FEATURE_BANDS; b++) {
+        out.bandRms[b] = 0.0f;
+    }
+    if (numBins < 2 || fftSize == 0 || windowPower <= 0.0f) {
+        return;
+    }
+
+    // A bin of amplitude A carries A^2 / 2 of power; the window spreads
+    // it over neighbouring bins and scales the total by windowPower
+    float binHz = sampleRateHz / (float)fftSize;
+    float norm = 1.0f / (2.0f * windowPower);
+    float velocityMaxHz = fminf(FEATURE_VELOCITY_MAX_HZ, sampleRateHz / 2.0f);
+
+    double velocity = 0.0;
+    double bands[FEATURE_BANDS] = {};
+
+    // DC carries gravity and is skipped, as in the uploads
+    for (size_t k = 1; k < numBins; k++) {
+        float f = k * binHz;
+        float power = magnitude[k] * magnitude[k] * norm;
+
+        // Integrate once: V(f) = A(f) / (2 pi f)
+        if (f >= FEATURE_VELOCITY_MIN_HZ && f <= velocityMaxHz) {
+            float w = G_TO_MM_S2 / (2.0f * (float)M_PI * f);
+            velocity += power * w * w;
+        }
+
+        for (int b = 0; b < FEATURE_BANDS; b++) {
+            if (f >= bandEdgesHz[b] && f < bandEdgesHz[b + 1]) {
+                bands[b] += power;
+            }
+        }
+    }
+
+    out.velocityRms = sqrtf((float)velocity);
+    for (int b = 0; b < FEATURE_BANDS; b++) {
+        out.bandRms[b] = sqrtf((float)bands[b]);
+    }
+}
@@ -0,0 +1,61 @@
+#ifndef FEATURE_EXTRACTION_H
+#define FEATURE_EXTRACTION_H
+
+#include <Arduino.h>
+#include "config.h"
+
+/**
+ * @brief Condition indicators of one axis
+ */
+struct AxisFeatures {
+    float rms;                      // g, mean removed
+    float peak;                     // g, largest |x - mean|
+    float crest;                    // peak / rms
+    float kurtosis;                 // m4 / m2^2 (3 for Gaussian noise)
+    float velocityRms;              // mm/s between the velocity band limits
+    float bandRms[FEATURE_BANDS];   // g RMS per band_edges_hz band
+};
+
+/**
+ * @brief Condition indicators of one run, as uploaded in accelfeatures
+ */
+struct RunFeatures {
+    AxisFeatures axis[3];                       // X, Y, Z
+    uint16_t bandEdgesHz[FEATURE_BANDS + 1];    // Edges the bands were computed with
+};
+
+/**
+ * @brief Per-run feature extraction from the filtered signal and its spectrum
+ *
+ * Time-domain statistics come from the filtered samples; velocity RMS
+ * and band energies are summed from the FFT magnitudes, so no second
+ * transform is needed. Spectral sums are corrected for the window with
+ * DSP::windowPowerGain().
+ */
+class Features {
+public:
+    /**
+     * @brief RMS, peak, crest factor and kurtosis of one axis
+     * @param x Filtered samples in g
+     * @param len Number of samples
+     * @param out Output; spectral fields are left unchanged
+     */
+    static void computeTime(const float* x, size_t len, AxisFeatures& out);
+
+    /**
+     * @brief Velocity RMS and band energies of one axis
+     * @param magnitude Single-sided amplitude spectrum from DSP::computeFFT()
+     * @param numBins Number of bins (fftSize / 2 + 1)
+     * @param fftSize Padded FFT length
+     * @param sampleRateHz Sample rate in Hz
+     * @param windowPower DSP::windowPowerGain() for the transform
+     * @param bandEdgesHz FEATURE_BANDS + 1 ascending edges; a band whose
+     *                    upper edge is not above its lower edge yields 0
+     * @param out Output; time-domain fields are left unchanged
+     */
+    static void computeSpectral(const float* magnitude, size_t numBins, size_t fftSize,
+                                float sampleRateHz, float windowPower,
+                                const uint16_t* bandEdgesHz, AxisFeatures& out);
+};
+
+#endif // FEATURE_EXTRACTION_H
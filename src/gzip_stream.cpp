@@ -0,0 +1,252 @@
+#include "gzip_stream.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Deflate length symbols 257..285 (RFC 1951 3.2.5)
+static const uint16_t LEN_BASE[29] = {
+    3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+    35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+static const uint8_t LEN_EXTRA[29] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+    3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+};
+
+// Distance codes 0..23 cover the 4 KB window
+static const uint16_t DIST_BASE[24] = {
+    1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+    257, 385, 513, 769, 1025, 1537, 2049, 3073
+};
+static const uint8_t DIST_EXTRA[24] = {
+    0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+    7, 7, 8, 8, 9, 9, 10, 10
+};
+
+// CRC-32 (gzip polynomial), four bits at a time
+static const uint32_t CRC_NIBBLE[16] = {
+    0x00000000, 0x1db71064, 0x3b6e20c8, 0x26d930ac,
+    0x76dc4190, 0x6b6b51f4, 0x4db26158, 0x5005713c,
+    0xedb88320, 0xf00f9344, 0xd6d6a3e8, 0xcb61b38c,
+    0x9b64c2b0, 0x86d3d2d4, 0xa00ae278, 0xbdbdf21c
+};
+
+static inline uint32_t hash3(const uint8_t* p) {
+    uint32_t v = ((uint32_t)p[0] << 16) | ((uint32_t)p[1] << 8) | p[2];
+    return (v * 2654435761u) >> (32 - 12);    // 12 = HASH_BITS
+}
+
+GzipStream::~GzipStream() {
+    free(_buf);
+    free(_head);
+}
+
+bool GzipStream::allocate() {
+    if (_buf && _head) {
+        return true;
+    }
+    _buf = (uint8_t*)malloc(BUFFER);
+    _head = (uint16_t*)malloc(HASH_SIZE * sizeof(uint16_t));
+    if (!_buf || !_head) {
+        free(_buf);
+        free(_head);
+        _buf = nullptr;
+        _head = nullptr;
+        return false;
+    }
+    return true;
+}
+
+void GzipStream::begin(Sink sink, void* ctx) {
+    _sink = sink;
+    _ctx = ctx;
+    _failed = false;
+    _fill = 0;
+    _cur = 0;
+    _outLen = 0;
+    _bitBuf = 0;
+    _bitCount = 0;
+    _crc = 0xFFFFFFFF;
+    _bytesIn = 0;
+    _bytesOut = 0;
+    memset(_head, 0, HASH_SIZE * sizeof(uint16_t));
+
+    // Member header: magic, deflate, no flags, no mtime, unknown OS
+    static const uint8_t header[10] = { 0x1f, 0x8b, 8, 0, 0, 0, 0, 0, 0, 0xff };
+    for (size_t i = 0; i < sizeof(header); i++) {
+        _putByte(header[i]);
+    }
+
+    // One open-ended fixed-Huffman block (BFINAL = 0, BTYPE = 01)
+    _putBits(0, 1);
+    _putBits(1, 2);
+}
+
+bool GzipStream::write(const uint8_t* data, size_t len) {
+    _bytesIn += len;
+    for (size_t i = 0; i < len; i++) {
+        _crc ^= data[i];
+        _crc = (_crc >> 4) ^ CRC_NIBBLE[_crc & 0x0F];
+        _crc = (_crc >> 4) ^ CRC_NIBBLE[_crc & 0x0F];
+    }
+
+    while (len > 0) {
+        if (_fill == BUFFER) {
+            _slide();
+        }
+        size_t n = BUFFER - _fill;
+        if (n > len) n = len;
+        memcpy(_buf + _fill, data, n);
+        _fill += n;
+        data += n;
+        len -= n;
+        _compress(false);
+    }
+    return !_failed;
+}
+
+bool GzipStream::finish() {
+    _compress(true);
+
+    // End of block, then an empty final block
+    _putCode(0, 7);
+    _putBits(1, 1);
+    _putBits(1, 2);
+    _putCode(0, 7);
+    _alignByte();
+
+    uint32_t crc = ~_crc;
+    for (int i = 0; i < 4; i++) _putByte((uint8_t)(crc >> (8 * i)));
+    for (int i = 0; i < 4; i++) _putByte((uint8_t)(_bytesIn >> (8 * i)));
+    _flushOut();
+
+    return !_failed;
+}
+
+void GzipStream::_slide() {
+    // Drop the oldest WINDOW bytes; _cur is always past them here
+    memmove(_buf, _buf + WINDOW, _fill - WINDOW);
+    _fill -= WINDOW;
+    _cur -= WINDOW;
+    for (size_t i = 0; i < HASH_SIZE; i++) {
+        _head[i] = _head[i] > WINDOW ? _head[i] - WINDOW : 0;
+    }
+}
+
+void GzipStream::_insert(size_t pos) {
+    if (pos + MIN_MATCH <= _fill) {
+        _head[hash3(_buf + pos)] = (uint16_t)(pos + 1);
+    }
+}
+
+void GzipStream::_compress(bool flush) {
+    // Keep a full match of lookahead unless this is the end of input
+    size_t limit = flush ? _fill : (_fill > MAX_MATCH ? _fill - MAX_MATCH : 0);
+
+    while (_cur < limit) {
+        size_t avail = _fill - _cur;
+        size_t bestLen = 0;
+        size_t bestDist = 0;
+
+        if (avail >= MIN_MATCH) {
+            uint32_t h = hash3(_buf + _cur);
+            size_t candidate = _head[h];
+            _head[h] = (uint16_t)(_cur + 1);
+
+            if (candidate > 0) {
+                candidate--;
+                size_t dist = _cur - candidate;
+                if (dist > 0 && dist <= WINDOW) {
+                    size_t maxLen = avail < MAX_MATCH ? avail : MAX_MATCH;
+                    const uint8_t* a = _buf + candidate;
+                    const uint8_t* b = _buf + _cur;
+                    size_t len = 0;
+                    while (len < maxLen && a[len] == b[len]) len++;
+                    if (len >= MIN_MATCH) {
+                        bestLen = len;
+                        bestDist = dist;
+                    }
+                }
+            }
+        }
+
+        if (bestLen > 0) {
+            _match(bestLen, bestDist);
+            for (size_t i = 1; i < bestLen; i++) {
+                _insert(_cur + i);
+            }
+            _cur += bestLen;
+        } else {
+            _literal(_buf[_cur]);
+            _cur++;
+        }
+    }
+}
+
+void GzipStream::_literal(uint8_t c) {
+    if (c < 144) {
+        _putCode(0x30 + c, 8);
+    } else {
+        _putCode(0x190 + (c - 144), 9);
+    }
+}
+
+void GzipStream::_match(size_t length, size_t distance) {
+    int li = 28;
+    while (length < LEN_BASE[li]) li--;
+    uint32_t sym = 257 + li;
+    if (sym < 280) {
+        _putCode(sym - 256, 7);
+    } else {
+        _putCode(0xC0 + (sym - 280), 8);
+    }
+    _putBits(length - LEN_BASE[li], LEN_EXTRA[li]);
+
+    int di = 23;
+    while (distance < DIST_BASE[di]) di--;
+    _putCode(di, 5);
+    _putBits(distance - DIST_BASE[di], DIST_EXTRA[di]);
+}
+
+void GzipStream::_putBits(uint32_t bits, uint8_t count) {
+    _bitBuf |= bits << _bitCount;
+    _bitCount += count;
+    while (_bitCount >= 8) {
+        _putByte((uint8_t)_bitBuf);
+        _bitBuf >>= 8;
+        _bitCount -= 8;
+    }
+}
+
+void GzipStream::_putCode(uint32_t code, uint8_t length) {
+    // Huffman codes are stored most significant bit first
+    uint32_t reversed = 0;
+    for (uint8_t i = 0; i < length; i++) {
+        reversed = (reversed << 1) | ((code >> i) & 1);
+    }
+    _putBits(reversed, length);
+}
+
+void GzipStream::_alignByte() {
+    if (_bitCount > 0) {
+        _putByte((uint8_t)_bitBuf);
+    }
+    _bitBuf = 0;
+    _bitCount = 0;
+}
+
+void GzipStream::_putByte(uint8_t b) {
+    _out[_outLen++] = b;
+    if (_outLen == OUT_SIZE) {
+        _flushOut();
+    }
+}
+
+void GzipStream::_flushOut() {
+    if (_outLen > 0) {
+        if (!_failed && (!_sink || !_sink(_ctx, _out, _outLen))) {
+            _failed = true;
+        }
+        _bytesOut += _outLen;
+        _outLen = 0;
+    }
+}
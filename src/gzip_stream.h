@@ -0,0 +1,102 @@
+#ifndef GZIP_STREAM_H
+#define GZIP_STREAM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Small streaming gzip compressor
+ *
+ * Deflate with fixed Huffman codes and a 4 KB LZ77 window, searched
+ * through a single-entry hash table. That is far weaker than zlib at
+ * general data but does well on line protocol, where every line
+ * repeats the previous one's prefix, and it needs about 17 KB instead
+ * of the few hundred KB a full miniz/zlib compressor state takes.
+ *
+ * Input is fed in arbitrary pieces with write(); compressed output is
+ * handed to the sink in pieces of up to OUT_SIZE bytes.
+ */
+class GzipStream {
+public:
+    /**
+     * @brief Receives compressed bytes
+     * @return false to abort (e.g. socket closed)
+     */
+    typedef bool (*Sink)(void* ctx, const uint8_t* data, size_t len);
+
+    ~GzipStream();
+
+    /**
+     * @brief Allocate the window and hash table (once)
+     * @return true if the buffers are available
+     */
+    bool allocate();
+
+    /**
+     * @brief Start a new gzip member and write its header
+     * @param sink Function receiving compressed output
+     * @param ctx Context passed to the sink
+     */
+    void begin(Sink sink, void* ctx);
+
+    /**
+     * @brief Compress input
+     * @return false if the sink failed
+     */
+    bool write(const uint8_t* data, size_t len);
+
+    /**
+     * @brief Compress the remaining input and write the gzip trailer
+     * @return false if the sink failed at any point since begin()
+     */
+    bool finish();
+
+    /**
+     * @brief Uncompressed bytes since begin()
+     */
+    uint32_t bytesIn() const { return _bytesIn; }
+
+    /**
+     * @brief Compressed bytes (including header/trailer) since begin()
+     */
+    uint32_t bytesOut() const { return _bytesOut + _outLen; }
+
+private:
+    static constexpr size_t WINDOW = 4096;          // Max match distance
+    static constexpr size_t BUFFER = 2 * WINDOW;    // History + lookahead
+    static constexpr size_t HASH_BITS = 12;
+    static constexpr size_t HASH_SIZE = 1 << HASH_BITS;
+    static constexpr size_t MIN_MATCH = 3;
+    static constexpr size_t MAX_MATCH = 258;
+    static constexpr size_t OUT_SIZE = 512;
+
+    uint8_t* _buf = nullptr;        // BUFFER bytes of history and input
+    uint16_t* _head = nullptr;      // Hash -> last position + 1 (0 = none)
+    uint8_t _out[OUT_SIZE];
+
+    size_t _fill = 0;               // Bytes in _buf
+    size_t _cur = 0;                // Next position to encode
+    size_t _outLen = 0;
+    uint32_t _bitBuf = 0;
+    uint8_t _bitCount = 0;
+    uint32_t _crc = 0;
+    uint32_t _bytesIn = 0;
+    uint32_t _bytesOut = 0;
+
+    Sink _sink = nullptr;
+    void* _ctx = nullptr;
+    bool _failed = false;
+
+    void _compress(bool flush);
+    void _slide();
+    void _insert(size_t pos);
+    void _literal(uint8_t c);
+    void _match(size_t length, size_t distance);
+    void _putBits(uint32_t bits, uint8_t count);
+    void _putCode(uint32_t code, uint8_t length);
+    void _alignByte();
+    void _putByte(uint8_t b);
+    void _flushOut();
+};
+
+#endif // GZIP_STREAM_H
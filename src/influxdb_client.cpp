@@ -2,20 +2,6 @@
 #include "config.h"
 #include <WiFi.h>
 
-static String escapeTagValue(const char* raw) {
-    String out;
-    if (!raw) return out;
-
-    for (size_t i = 0; raw[i] != '\0'; i++) {
-        char c = raw[i];
-        if (c == ',' || c == '=' || c == ' ') {
-            out += '\\';
-        }
-        out += c;
-    }
-    return out;
-}
-
 // Global instance
 InfluxDBClient influxClient;
 
@@ -30,6 +16,7 @@ void InfluxDBClient::setConnection(const char* url, const char* token,
     _token = token;
     _org = org;
     _bucket = bucket;
+    _parseUrl();
     
     Serial.printf("[InfluxDB] Configured: %s, org=%s, bucket=%s\n",
                   _url.c_str(), _org.c_str(), _bucket.c_str());
@@ -39,15 +26,38 @@ bool InfluxDBClient::isConfigured() const {
     return _url.length() > 0 && _token.length() > 0;
 }
 
-String InfluxDBClient::_buildWriteUrl() {
-    String url = _url;
-    if (!url.endsWith("/")) url += "/";
-    url += "api/v2/write?org=";
-    url += _org;
-    url += "&bucket=";
-    url += _bucket;
-    url += "&precision=ns";
-    return url;
+void InfluxDBClient::_parseUrl() {
+    String rest = _url;
+    _https = rest.startsWith("https://");
+    if (_https) {
+        rest = rest.substring(8);
+    } else if (rest.startsWith("http://")) {
+        rest = rest.substring(7);
+    }
+    
+    int slash = rest.indexOf('/');
+    String hostPort = slash >= 0 ? rest.substring(0, slash) : rest;
+    _basePath = slash >= 0 ? rest.substring(slash) : String("/");
+    if (!_basePath.endsWith("/")) _basePath += "/";
+    
+    int colon = hostPort.indexOf(':');
+    if (colon >= 0) {
+        _host = hostPort.substring(0, colon);
+        _port = (uint16_t)hostPort.substring(colon + 1).toInt();
+    } else {
+        _host = hostPort;
+        _port = _https ? 443 : 80;
+    }
+}
+
+String InfluxDBClient::_buildWritePath() {
+    String path = _basePath;
+    path += "api/v2/write?org=";
+    path += _org;
+    path += "&bucket=";
+    path += _bucket;
+    path += "&precision=ns";
+    return path;
 }
 
 bool InfluxDBClient::testConnection() {
@@ -77,59 +87,324 @@ bool InfluxDBClient::testConnection() {
     return false;
 }
 
-bool InfluxDBClient::_sendLineProtocol(const String& lineProtocol) {
+bool InfluxDBClient::_writeChunk(const uint8_t* data, size_t len) {
+    char header[12];
+    int n = snprintf(header, sizeof(header), "%X\r\n", (unsigned int)len);
+    
+    return _client->write((const uint8_t*)header, n) == (size_t)n &&
+           _client->write(data, len) == len &&
+           _client->write((const uint8_t*)"\r\n", 2) == 2;
+}
+
+bool InfluxDBClient::_encoderSink(void* ctx, const char* data, size_t len) {
+    InfluxDBClient* self = static_cast<InfluxDBClient*>(ctx);
+    if (self->_compress) {
+        return self->_gzip.write((const uint8_t*)data, len);
+    }
+    return self->_writeChunk((const uint8_t*)data, len);
+}
+
+bool InfluxDBClient::_gzipSink(void* ctx, const uint8_t* data, size_t len) {
+    return static_cast<InfluxDBClient*>(ctx)->_writeChunk(data, len);
+}
+
+void InfluxDBClient::setCompression(bool enabled) {
+    if (enabled && !_gzip.allocate()) {
+        Serial.println("[InfluxDB] Gzip buffer allocation failed, sending uncompressed");
+        enabled = false;
+    }
+    _compress = enabled;
+    Serial.printf("[InfluxDB] Compression: %s\n", _compress ? "gzip" : "off");
+}
+
+void InfluxDBClient::setSensorId(const char* id) {
+    strlcpy(_sensorId, id ? id : "", sizeof(_sensorId));
+}
+
+bool InfluxDBClient::_connect(bool& reused) {
+    reused = _client && _client->connected();
+    if (reused) {
+        return true;
+    }
+    
+    if (_https) {
+        _secureClient.setInsecure();
+        _client = &_secureClient;
+    } else {
+        _client = &_plainClient;
+    }
+    
+    if (!_client->connect(_host.c_str(), _port, INFLUX_TIMEOUT_MS)) {
+        _lastError = "Connection to " + _host + ":" + String(_port) + " failed";
+        return false;
+    }
+    _sessionConnects++;
+    return true;
+}
+
+void InfluxDBClient::_disconnect() {
+    if (_client) {
+        _client->stop();
+    }
+}
+
+bool InfluxDBClient::beginSession() {
     if (!isConfigured()) {
-        _lastError = "Client not configured";
         return false;
     }
     
-    String writeUrl = _buildWriteUrl();
+    if (!_inSession) {
+        _inSession = true;
+        _sessionRequests = 0;
+        _sessionConnects = 0;
+        _sessionBytes = 0;
+        _sessionWireBytes = 0;
+    }
     
-    for (int attempt = 0; attempt < INFLUX_RETRY_COUNT; attempt++) {
-        _http.begin(writeUrl);
-        _http.setTimeout(INFLUX_TIMEOUT_MS);
-        _http.addHeader("Content-Type", "text/plain");
-        _http.addHeader("Authorization", "Token " + _token);
-        
-        int httpCode = _http.POST(lineProtocol);
-        String response = _http.getString();
-        _http.end();
-        
-        if (httpCode >= 200 && httpCode < 300) {
-            return true;
-        }
-        
-        _lastError = "Write failed: " + String(httpCode) + " - " + response;
-        Serial.printf("[InfluxDB] Attempt %d failed: %s\n", attempt + 1, _lastError.c_str());
-        
-        // Exponential backoff
-        delay(100 * (1 << attempt));
+    bool reused;
+    unsigned long startTime = millis();
+    if (!_connect(reused)) {
+        Serial.printf("[InfluxDB] Pre-connect failed: %s\n", _lastError.c_str());
+        return false;
+    }
+    if (!reused) {
+        Serial.printf("[InfluxDB] Connected in %lu ms\n", millis() - startTime);
     }
+    return true;
+}
+
+void InfluxDBClient::endSession() {
+    if (!_inSession) {
+        return;
+    }
+    _inSession = false;
+    _disconnect();
     
-    Serial.println("[InfluxDB] All retries failed, dropping data");
-    return false;
+    Serial.printf("[InfluxDB] Session: %lu requests over %lu connection(s), %lu bytes (%lu sent)\n",
+                  (unsigned long)_sessionRequests, (unsigned long)_sessionConnects,
+                  (unsigned long)_sessionBytes, (unsigned long)_sessionWireBytes);
 }
 
-bool InfluxDBClient::writePoint(const char* measurement, const char* tags,
-                                const char* fields, uint64_t timestampNs) {
-    String line = measurement;
+bool InfluxDBClient::_beginWrite(bool& reused) {
+    if (!_connect(reused)) {
+        return false;
+    }
+    _sessionRequests++;
+    
+    _client->print("POST ");
+    _client->print(_buildWritePath());
+    _client->print(" HTTP/1.1\r\nHost: ");
+    _client->print(_host);
+    _client->print("\r\nAuthorization: Token ");
+    _client->print(_token);
+    _client->print("\r\nContent-Type: text/plain; charset=utf-8\r\n"
+                   "Transfer-Encoding: chunked\r\n");
+    if (_compress) {
+        _client->print("Content-Encoding: gzip\r\n");
+    }
+    _client->print(_inSession ? "Connection: keep-alive\r\n\r\n"
+                              : "Connection: close\r\n\r\n");
+    
+    _encoder.begin(_encoderSink, this);
+    if (_compress) {
+        _gzip.begin(_gzipSink, this);
+    }
+    return true;
+}
+
+int InfluxDBClient::_finishWrite() {
+    bool ok = _encoder.flush();
+    if (_compress) {
+        ok = _gzip.finish() && ok;
+    }
+    _sessionBytes += _encoder.bytesWritten();
+    _sessionWireBytes += _compress ? _gzip.bytesOut() : _encoder.bytesWritten();
+    
+    if (!ok || _client->write((const uint8_t*)"0\r\n\r\n", 5) != 5) {
+        _disconnect();
+        _lastError = "Connection lost while sending";
+        return -1;
+    }
     
-    if (tags && strlen(tags) > 0) {
-        line += ",";
-        line += tags;
+    String body;
+    bool reusable = false;
+    int httpCode = _readResponse(body, reusable);
+    
+    // Keep the connection only if the response was read to its end
+    if (!_inSession || !reusable) {
+        _disconnect();
+    }
+    
+    if (httpCode < 0) {
+        _lastError = "No response from server";
+    } else if (httpCode < 200 || httpCode >= 300) {
+        _lastError = "Write failed: " + String(httpCode) + " - " + body;
+    }
+    return httpCode;
+}
+
+int InfluxDBClient::_readByte(uint32_t deadline) {
+    while (!_client->available()) {
+        if (!_client->connected() || (int32_t)(millis() - deadline) >= 0) {
+            return -1;
+        }
+        delay(1);
+    }
+    return _client->read();
+}
+
+bool InfluxDBClient::_readLine(char* buf, size_t size, uint32_t deadline) {
+    size_t n = 0;
+    for (;;) {
+        int c = _readByte(deadline);
+        if (c < 0) {
+            return false;
+        }
+        if (c == '\n') break;
+        if (c != '\r' && n + 1 < size) {
+            buf[n++] = (char)c;
+        }
     }
+    buf[n] = '\0';
+    return true;
+}
+
+int InfluxDBClient::_readResponse(String& body, bool& reusable) {
+    static constexpr size_t MAX_ERROR_BODY = 256;
+    uint32_t deadline = millis() + INFLUX_TIMEOUT_MS;
+    char line[128];
     
-    line += " ";
-    line += fields;
+    // Status line: "HTTP/1.1 204 No Content"
+    if (!_readLine(line, sizeof(line), deadline) || strncmp(line, "HTTP/", 5) != 0) {
+        return -1;
+    }
+    const char* code = strchr(line, ' ');
+    int httpCode = code ? atoi(code + 1) : -1;
     
-    if (timestampNs > 0) {
-        line += " ";
-        char timestamp[32];
-        snprintf(timestamp, sizeof(timestamp), "%llu", (unsigned long long)timestampNs);
-        line += timestamp;
+    // Headers
+    long contentLength = -1;
+    bool chunked = false;
+    bool serverClose = false;
+    bool headersDone = false;
+    while (_readLine(line, sizeof(line), deadline)) {
+        if (line[0] == '\0') {
+            headersDone = true;
+            break;
+        }
+        if (strncasecmp(line, "Content-Length:", 15) == 0) {
+            contentLength = atol(line + 15);
+        } else if (strncasecmp(line, "Transfer-Encoding:", 18) == 0 && strstr(line, "chunked")) {
+            chunked = true;
+        } else if (strncasecmp(line, "Connection:", 11) == 0 && strstr(line, "close")) {
+            serverClose = true;
+        }
     }
+    if (!headersDone) {
+        return httpCode;
+    }
+    
+    // Body: keep the start for error messages, discard the rest.
+    // Without a length the body ends at close, so the socket is spent.
+    bool framed = chunked || contentLength >= 0 || httpCode == 204 || httpCode == 304;
+    reusable = framed && !serverClose;
     
-    return _sendLineProtocol(line);
+    if (httpCode == 204 || httpCode == 304) {
+        return httpCode;
+    }
+    if (chunked) {
+        while (_readLine(line, sizeof(line), deadline)) {
+            long size = strtol(line, nullptr, 16);
+            if (size <= 0) {
+                _readLine(line, sizeof(line), deadline);  // Trailer
+                break;
+            }
+            for (long i = 0; i < size; i++) {
+                int c = _readByte(deadline);
+                if (c < 0) {
+                    reusable = false;
+                    return httpCode;
+                }
+                if (body.length() < MAX_ERROR_BODY) body += (char)c;
+            }
+            _readLine(line, sizeof(line), deadline);  // Chunk CRLF
+        }
+    } else {
+        for (long i = 0; contentLength < 0 || i < contentLength; i++) {
+            int c = _readByte(deadline);
+            if (c < 0) {
+                reusable = false;
+                break;
+            }
+            if (body.length() < MAX_ERROR_BODY) body += (char)c;
+        }
+    }
+    return httpCode;
+}
+
+template <typename EncodeLine>
+bool InfluxDBClient::_writeLines(size_t count, EncodeLine encodeLine) {
+    if (!isConfigured()) {
+        _lastError = "Client not configured";
+        return false;
+    }
+    
+    for (size_t start = 0; start < count; start += INFLUX_WRITE_BATCH_SIZE) {
+        size_t end = start + INFLUX_WRITE_BATCH_SIZE;
+        if (end > count) end = count;
+        
+        bool sent = false;
+        for (int attempt = 0; attempt < INFLUX_RETRY_COUNT && !sent; attempt++) {
+            bool reused = false;
+            int httpCode = -1;
+            if (_beginWrite(reused)) {
+                // Stop encoding early if the socket went away
+                for (size_t i = start; i < end && !_encoder.failed(); i++) {
+                    encodeLine(_encoder, i);
+                }
+                httpCode = _finishWrite();
+                sent = httpCode >= 200 && httpCode < 300;
+            }
+            
+            // A kept-alive connection the server already closed fails
+            // without a response; reconnect once without spending a retry.
+            if (!sent && reused && httpCode < 0) {
+                _disconnect();
+                attempt--;
+                continue;
+            }
+            
+            if (!sent) {
+                Serial.printf("[InfluxDB] Attempt %d failed: %s\n", attempt + 1, _lastError.c_str());
+                if (attempt + 1 < INFLUX_RETRY_COUNT) {
+                    metrics.count(METRIC_UPLOAD_RETRIES);
+                }
+                
+                // Exponential backoff
+                delay(100 * (1 << attempt));
+            }
+        }
+        
+        if (!sent) {
+            Serial.println("[InfluxDB] All retries failed, dropping data");
+            metrics.count(METRIC_UPLOAD_FAILURES);
+            return false;
+        }
+    }
+    return true;
+}
+
+bool InfluxDBClient::writePoint(const char* measurement, const char* tags,
+                                const char* fields, uint64_t timestampNs) {
+    return _writeLines(1, [&](LineProtocolEncoder& enc, size_t) {
+        enc.raw(measurement, strlen(measurement));
+        if (tags && strlen(tags) > 0) {
+            enc.raw(",", 1);
+            enc.raw(tags, strlen(tags));
+        }
+        enc.raw(" ", 1);
+        enc.raw(fields, strlen(fields));
+        enc.endLine(timestampNs);
+    });
 }
 
 bool InfluxDBClient::writeFrequencyData(const char* operationId, const char* deviceId,
@@ -140,52 +415,99 @@ bool InfluxDBClient::writeFrequencyData(const char* operationId, const char* dev
                                         uint64_t baseTimestampNs) {
     Serial.printf("[InfluxDB] Writing %d frequency bins\n", numBins);
     
-    // Build line protocol in batches
-    String batch;
-    batch.reserve(INFLUX_WRITE_BATCH_SIZE * 150);  // Estimate ~150 chars per point
+    if (numBins < 2) {
+        return true;
+    }
     
-    size_t batchCount = 0;
     uint64_t timestampIncrement = 1000000;  // 1ms between "points" for visualization
     
-    String operationTag = escapeTagValue(operationId);
-    String deviceTag = escapeTagValue(deviceId);
-    String runTag = escapeTagValue(runId);
+    _encoder.setMeasurement("accelfreq");
+    _encoder.addTag("operation", operationId);
+    _encoder.addTag("device_id", deviceId);
+    _encoder.addTag("sensor_id", _sensorId);
+    _encoder.addTag("run_id", runId);
+    
+    // Skip DC component (bin 0) as in Python code
+    bool ok = _writeLines(numBins - 1, [&](LineProtocolEncoder& enc, size_t line) {
+        size_t i = line + 1;
+        enc.beginLine();
+        enc.field("frequencies", frequencies[i]);
+        enc.field("x_freq", xFreq[i]);
+        enc.field("y_freq", yFreq[i]);
+        enc.field("z_freq", zFreq[i]);
+        enc.endLine(baseTimestampNs + (i * timestampIncrement));
+    });
+    
+    if (ok) {
+        Serial.println("[InfluxDB] Frequency data written successfully");
+    }
+    return ok;
+}
 
-    for (size_t i = 0; i < numBins; i++) {
-        // Skip DC component (i=0) as in Python code
-        if (i == 0) continue;
-        
-        // measurement,tags fields timestamp
-        char point[320];
-        snprintf(point, sizeof(point),
-                 "accelfreq,operation=%s,device_id=%s,run_id=%s frequencies=%.6f,x_freq=%.6f,y_freq=%.6f,z_freq=%.6f %llu\n",
-                 operationTag.c_str(), deviceTag.c_str(), runTag.c_str(),
-                 frequencies[i], xFreq[i], yFreq[i], zFreq[i],
-                 (unsigned long long)(baseTimestampNs + (i * timestampIncrement)));
-        
-        batch += point;
-        batchCount++;
-        
-        // Send batch when full
-        if (batchCount >= INFLUX_WRITE_BATCH_SIZE) {
-            if (!_sendLineProtocol(batch)) {
-                return false;
-            }
-            batch = "";
-            batch.reserve(INFLUX_WRITE_BATCH_SIZE * 150);
-            batchCount = 0;
-        }
+bool InfluxDBClient::writePackedSpectra(const char* operationId, const char* deviceId,
+                                        const char* runId,
+                                        const float* xFreq, const float* yFreq,
+                                        const float* zFreq, size_t numBins,
+                                        float binHz, uint64_t timestampNs) {
+    if (numBins < 2) {
+        return true;
     }
     
-    // Send remaining points
-    if (batchCount > 0) {
-        if (!_sendLineProtocol(batch)) {
-            return false;
+    const float* axes[3] = { xFreq, yFreq, zFreq };
+    static const char* const valueKeys[3] = { "x_freq", "y_freq", "z_freq" };
+    static const char* const scaleKeys[3] = { "x_scale", "y_scale", "z_scale" };
+    
+    // Peak-relative scale per axis, bin 0 excluded
+    float scales[3];
+    for (int a = 0; a < 3; a++) {
+        float peak = 0.0f;
+        for (size_t i = 1; i < numBins; i++) {
+            if (axes[a][i] > peak) peak = axes[a][i];
         }
+        scales[a] = peak / 65535.0f;
     }
     
-    Serial.println("[InfluxDB] Frequency data written successfully");
-    return true;
+    Serial.printf("[InfluxDB] Writing %d packed frequency bins\n", numBins - 1);
+    
+    _encoder.setMeasurement("accelspectrum");
+    _encoder.addTag("operation", operationId);
+    _encoder.addTag("device_id", deviceId);
+    _encoder.addTag("sensor_id", _sensorId);
+    _encoder.addTag("run_id", runId);
+    
+    bool ok = _writeLines(1, [&](LineProtocolEncoder& enc, size_t) {
+        enc.beginLine();
+        enc.fieldInt("first_bin", 1);
+        enc.fieldInt("bins", numBins - 1);
+        enc.field("bin_hz", binHz);
+        enc.fieldString("encoding", "u16le");
+        for (int a = 0; a < 3; a++) {
+            enc.fieldExp(scaleKeys[a], scales[a]);
+            
+            // Quantize in blocks whose byte count is a multiple of 3,
+            // so the base64 pieces concatenate without padding
+            float inv = scales[a] > 0.0f ? 1.0f / scales[a] : 0.0f;
+            uint8_t block[96];
+            enc.beginBase64Field(valueKeys[a]);
+            for (size_t i = 1; i < numBins; ) {
+                size_t n = 0;
+                for (; n < sizeof(block) / 2 && i < numBins; n++, i++) {
+                    float q = axes[a][i] * inv + 0.5f;
+                    uint16_t v = q >= 65535.0f ? 65535 : (q > 0.0f ? (uint16_t)q : 0);
+                    block[2 * n] = (uint8_t)v;
+                    block[2 * n + 1] = (uint8_t)(v >> 8);
+                }
+                enc.base64(block, 2 * n);
+            }
+            enc.endBase64Field();
+        }
+        enc.endLine(timestampNs);
+    });
+    
+    if (ok) {
+        Serial.println("[InfluxDB] Packed spectra written successfully");
+    }
+    return ok;
 }
 
 bool InfluxDBClient::writeTimeData(const char* operationId, const char* deviceId,
@@ -198,71 +520,266 @@ bool InfluxDBClient::writeTimeData(const char* operationId, const char* deviceId
     // Calculate time increment between samples in nanoseconds
     uint64_t sampleIntervalNs = (uint64_t)(1000000000.0 / sampleRateHz);
     
-    String batch;
-    batch.reserve(INFLUX_WRITE_BATCH_SIZE * 100);
+    _encoder.setMeasurement("acceltime");
+    _encoder.addTag("operation", operationId);
+    _encoder.addTag("device_id", deviceId);
+    _encoder.addTag("sensor_id", _sensorId);
+    _encoder.addTag("run_id", runId);
     
-    size_t batchCount = 0;
+    bool ok = _writeLines(numSamples, [&](LineProtocolEncoder& enc, size_t i) {
+        enc.beginLine();
+        enc.field("x", x[i]);
+        enc.field("y", y[i]);
+        enc.field("z", z[i]);
+        enc.endLine(baseTimestampNs + (i * sampleIntervalNs));
+    });
     
-    String operationTag = escapeTagValue(operationId);
-    String deviceTag = escapeTagValue(deviceId);
-    String runTag = escapeTagValue(runId);
+    if (ok) {
+        Serial.println("[InfluxDB] Time data written successfully");
+    }
+    return ok;
+}
 
-    for (size_t i = 0; i < numSamples; i++) {
-        char point[256];
-        snprintf(point, sizeof(point),
-                 "acceltime,operation=%s,device_id=%s,run_id=%s x=%.6f,y=%.6f,z=%.6f %llu\n",
-                 operationTag.c_str(), deviceTag.c_str(), runTag.c_str(),
-                 x[i], y[i], z[i],
-                 (unsigned long long)(baseTimestampNs + (i * sampleIntervalNs)));
-        
-        batch += point;
-        batchCount++;
-        
-        if (batchCount >= INFLUX_WRITE_BATCH_SIZE) {
-            if (!_sendLineProtocol(batch)) {
-                return false;
+bool InfluxDBClient::writeTimeData(const char* operationId, const char* deviceId,
+                                   const char* runId,
+                                   const int16_t* xyz, float scale,
+                                   size_t numSamples, uint64_t baseTimestampNs,
+                                   float sampleRateHz) {
+    Serial.printf("[InfluxDB] Writing %d raw time samples\n", numSamples);
+    
+    uint64_t sampleIntervalNs = (uint64_t)(1000000000.0 / sampleRateHz);
+    
+    _encoder.setMeasurement("acceltime");
+    _encoder.addTag("operation", operationId);
+    _encoder.addTag("device_id", deviceId);
+    _encoder.addTag("sensor_id", _sensorId);
+    _encoder.addTag("run_id", runId);
+    
+    bool ok = _writeLines(numSamples, [&](LineProtocolEncoder& enc, size_t i) {
+        enc.beginLine();
+        enc.field("x", xyz[i * 3 + 0] * scale);
+        enc.field("y", xyz[i * 3 + 1] * scale);
+        enc.field("z", xyz[i * 3 + 2] * scale);
+        enc.endLine(baseTimestampNs + (i * sampleIntervalNs));
+    });
+    
+    if (ok) {
+        Serial.println("[InfluxDB] Time data written successfully");
+    }
+    return ok;
+}
+
+bool InfluxDBClient::writeFeatures(const char* operationId, const char* deviceId,
+                                   const char* runId, const RunFeatures& features,
+                                   uint64_t timestampNs) {
+    static const char AXES[3] = { 'x', 'y', 'z' };
+    
+    _encoder.setMeasurement("accelfeatures");
+    _encoder.addTag("operation", operationId);
+    _encoder.addTag("device_id", deviceId);
+    _encoder.addTag("sensor_id", _sensorId);
+    _encoder.addTag("run_id", runId);
+    
+    bool ok = _writeLines(1, [&](LineProtocolEncoder& enc, size_t) {
+        char key[32];
+        enc.beginLine();
+        for (int a = 0; a < 3; a++) {
+            const AxisFeatures& f = features.axis[a];
+            snprintf(key, sizeof(key), "%c_rms", AXES[a]);
+            enc.field(key, f.rms);
+            snprintf(key, sizeof(key), "%c_peak", AXES[a]);
+            enc.field(key, f.peak);
+            snprintf(key, sizeof(key), "%c_crest", AXES[a]);
+            enc.field(key, f.crest, 3);
+            snprintf(key, sizeof(key), "%c_kurtosis", AXES[a]);
+            enc.field(key, f.kurtosis, 3);
+            snprintf(key, sizeof(key), "%c_vel_rms", AXES[a]);
+            enc.field(key, f.velocityRms, 4);
+            
+            for (int b = 0; b < FEATURE_BANDS; b++) {
+                uint16_t lo = features.bandEdgesHz[b];
+                uint16_t hi = features.bandEdgesHz[b + 1];
+                if (hi <= lo) continue;
+                snprintf(key, sizeof(key), "%c_band_%u_%u", AXES[a], lo, hi);
+                enc.field(key, f.bandRms[b]);
             }
-            batch = "";
-            batch.reserve(INFLUX_WRITE_BATCH_SIZE * 100);
-            batchCount = 0;
         }
+        enc.endLine(timestampNs);
+    });
+    
+    if (ok) {
+        Serial.println("[InfluxDB] Features written successfully");
     }
+    return ok;
+}
+
+bool InfluxDBClient::writeSpectralDiff(const char* operationId, const char* deviceId,
+                                       const char* runId, const SpectralDiff& diff,
+                                       uint64_t timestampNs) {
+    static const char AXES[3] = { 'x', 'y', 'z' };
     
-    if (batchCount > 0) {
-        if (!_sendLineProtocol(batch)) {
-            return false;
+    _encoder.setMeasurement("accelbaseline");
+    _encoder.addTag("operation", operationId);
+    _encoder.addTag("device_id", deviceId);
+    _encoder.addTag("sensor_id", _sensorId);
+    _encoder.addTag("run_id", runId);
+    
+    bool ok = _writeLines(1, [&](LineProtocolEncoder& enc, size_t) {
+        char key[32];
+        enc.beginLine();
+        for (int a = 0; a < 3; a++) {
+            snprintf(key, sizeof(key), "%c_score", AXES[a]);
+            enc.field(key, diff.score[a], 4);
         }
-    }
+        enc.fieldInt("baseline_runs", diff.baselineRuns);
+        
+        for (int i = 0; i < diff.topCount; i++) {
+            const ChangedBin& bin = diff.top[i];
+            char axis[2] = { AXES[bin.axis < 3 ? bin.axis : 0], '\0' };
+            snprintf(key, sizeof(key), "top%d_axis", i + 1);
+            enc.fieldString(key, axis);
+            snprintf(key, sizeof(key), "top%d_hz", i + 1);
+            enc.field(key, bin.freqHz, 2);
+            snprintf(key, sizeof(key), "top%d_amp", i + 1);
+            enc.field(key, bin.amplitude);
+            snprintf(key, sizeof(key), "top%d_base", i + 1);
+            enc.field(key, bin.baseline);
+        }
+        enc.endLine(timestampNs);
+    });
     
-    Serial.println("[InfluxDB] Time data written successfully");
-    return true;
+    if (ok) {
+        Serial.println("[InfluxDB] Baseline diff written successfully");
+    }
+    return ok;
 }
 
 bool InfluxDBClient::writeRunMetadata(const char* operationId, const char* deviceId,
                                       const char* runId, uint16_t sampleRateHz,
-                                      uint16_t sampleCount, size_t fftSize,
+                                      float odrHz, uint8_t decimation, uint16_t sampleCount,
+                                      uint32_t preTriggerFrames, int32_t triggerOffsetUs,
+                                      uint32_t timingJitterUs, size_t fftSize,
+                                      uint16_t averages,
+                                      float zoomCenterHz, uint16_t zoomFactor,
                                       uint16_t filterCutoffHz, float rangeG,
-                                      bool sendTimeDomain, const char* firmwareVersion,
-                                      uint64_t timestampNs) {
-    String tags = "operation=" + escapeTagValue(operationId);
-    tags += ",device_id=" + escapeTagValue(deviceId);
-    tags += ",run_id=" + escapeTagValue(runId);
-
+                                      bool sendTimeDomain, const char* trigger,
+                                      const char* firmwareVersion, uint64_t timestampNs) {
     const char* fw = (firmwareVersion && strlen(firmwareVersion) > 0) ? firmwareVersion : "unknown";
-    char fields[320];
-    snprintf(fields, sizeof(fields),
-             "sample_rate_hz=%ui,sample_count=%ui,fft_size=%ui,filter_cutoff_hz=%ui,range_g=%.3f,send_time_domain=%s,window=\"hann\",fw=\"%s\"",
-             sampleRateHz, sampleCount, (unsigned int)fftSize, filterCutoffHz, rangeG,
-             sendTimeDomain ? "true" : "false",
-             fw);
-
-    bool ok = writePoint("accelrunmeta", tags.c_str(), fields, timestampNs);
+    
+    _encoder.setMeasurement("accelrunmeta");
+    _encoder.addTag("operation", operationId);
+    _encoder.addTag("device_id", deviceId);
+    _encoder.addTag("sensor_id", _sensorId);
+    _encoder.addTag("run_id", runId);
+    
+    bool ok = _writeLines(1, [&](LineProtocolEncoder& enc, size_t) {
+        enc.beginLine();
+        enc.fieldInt("sample_rate_hz", sampleRateHz);
+        enc.field("odr_hz", odrHz, 3);
+        if (decimation > 1) {
+            enc.fieldInt("decimation", decimation);
+        }
+        enc.fieldInt("sample_count", sampleCount);
+        enc.fieldInt("pretrigger_samples", preTriggerFrames);
+        enc.fieldInt("trigger_offset_us", triggerOffsetUs);
+        enc.fieldInt("timing_jitter_us", timingJitterUs);
+        enc.fieldInt("fft_size", fftSize);
+        enc.fieldInt("averages", averages);
+        if (zoomFactor > 0) {
+            enc.fieldInt("zoom_factor", zoomFactor);
+            enc.field("zoom_center_hz", zoomCenterHz, 3);
+        }
+        enc.fieldInt("filter_cutoff_hz", filterCutoffHz);
+        enc.field("range_g", rangeG, 3);
+        enc.fieldBool("send_time_domain", sendTimeDomain);
+        enc.fieldString("window", "hann");
+        enc.fieldString("trigger", trigger);
+        enc.fieldString("fw", fw);
+        enc.endLine(timestampNs);
+    });
+    
     if (ok) {
         Serial.println("[InfluxDB] Run metadata written successfully");
     }
     return ok;
 }
 
+bool InfluxDBClient::writeHeartbeat(const char* operationId, const char* deviceId,
+                                    const MonitorSummary& summary, uint64_t timestampNs) {
+    _encoder.setMeasurement("accelheartbeat");
+    _encoder.addTag("operation", operationId);
+    _encoder.addTag("device_id", deviceId);
+    _encoder.addTag("sensor_id", _sensorId);
+    
+    bool ok = _writeLines(1, [&](LineProtocolEncoder& enc, size_t) {
+        enc.beginLine();
+        enc.fieldInt("period_ms", summary.periodMs);
+        enc.fieldInt("blocks", summary.blocks);
+        enc.fieldInt("events", summary.events);
+        enc.field("rms_mean", summary.rmsMean);
+        enc.field("rms_max", summary.rmsMax);
+        enc.field("baseline", summary.baseline);
+        enc.endLine(timestampNs);
+    });
+    
+    if (ok) {
+        Serial.println("[InfluxDB] Heartbeat written successfully");
+    }
+    return ok;
+}
+
+bool InfluxDBClient::writeDeviceHealth(const char* operationId, const char* deviceId,
+                                       const MetricsSnapshot& snap, int32_t rssi,
+                                       uint32_t journalPending, uint64_t timestampNs) {
+    _encoder.setMeasurement("devicehealth");
+    _encoder.addTag("operation", operationId);
+    _encoder.addTag("device_id", deviceId);
+    
+    char key[40];
+    bool ok = _writeLines(1, [&](LineProtocolEncoder& enc, size_t) {
+        enc.beginLine();
+        enc.fieldInt("uptime_s", millis() / 1000);
+        enc.fieldInt("window_ms", snap.windowMs);
+        for (uint8_t m = 0; m < METRIC_HISTOGRAMS; m++) {
+            const HistogramSummary& s = snap.hist[m];
+            const char* name = Metrics::histogramName(m);
+            snprintf(key, sizeof(key), "%s_count", name);
+            enc.fieldInt(key, s.count);
+            if (s.count == 0) continue;
+            snprintf(key, sizeof(key), "%s_p50", name);
+            enc.fieldInt(key, s.p50);
+            snprintf(key, sizeof(key), "%s_p90", name);
+            enc.fieldInt(key, s.p90);
+            snprintf(key, sizeof(key), "%s_max", name);
+            enc.fieldInt(key, s.max);
+        }
+        for (uint8_t c = 0; c < METRIC_COUNTERS; c++) {
+            enc.fieldInt(Metrics::counterName(c), snap.counters[c]);
+        }
+        enc.fieldInt("heap_free", snap.heapFree);
+        enc.fieldInt("heap_min_free", snap.heapMinFree);
+        enc.fieldInt("heap_largest", snap.heapLargest);
+        enc.fieldInt("heap_largest_min", snap.heapLargestMin);
+        for (uint8_t i = 0; i < snap.taskCount; i++) {
+            snprintf(key, sizeof(key), "stack_%s", snap.taskName[i]);
+            enc.fieldInt(key, snap.stackFree[i]);
+        }
+        for (uint8_t p = 0; p < BOOT_PHASES; p++) {
+            if (snap.bootMs[p] == 0) continue;
+            snprintf(key, sizeof(key), "boot_%s_ms", Metrics::bootPhaseName(p));
+            enc.fieldInt(key, snap.bootMs[p]);
+        }
+        enc.fieldInt("rssi", rssi);
+        enc.fieldInt("journal_pending", journalPending);
+        enc.endLine(timestampNs);
+    });
+    
+    if (ok) {
+        Serial.println("[InfluxDB] Device health written successfully");
+    }
+    return ok;
+}
+
 String InfluxDBClient::getLastError() const {
     return _lastError;
 }
@@ -3,12 +3,26 @@
 
 #include <Arduino.h>
 #include <HTTPClient.h>
+#include <WiFiClient.h>
+#include <WiFiClientSecure.h>
+#include "line_protocol.h"
+#include "gzip_stream.h"
+#include "feature_extraction.h"
+#include "spectral_baseline.h"
+#include "acquisition.h"
+#include "metrics.h"
 
 /**
  * @brief InfluxDB 2.x HTTP client for line protocol writes
  * 
  * Handles batched writes to InfluxDB with retry logic and
  * exponential backoff, similar to the Python implementation.
+ * Batches are encoded straight into the request body and sent with
+ * chunked transfer encoding, so no batch is ever held in memory; a
+ * retry re-encodes the batch from the source arrays.
+ *
+ * Writes between beginSession() and endSession() share one keep-alive
+ * connection; outside a session each write uses its own connection.
  */
 class InfluxDBClient {
 public:
@@ -32,6 +46,33 @@ public:
      */
     bool testConnection();
     
+    /**
+     * @brief Enable gzip-compressed write bodies (Content-Encoding: gzip)
+     * @param enabled true to compress
+     */
+    void setCompression(bool enabled);
+    
+    /**
+     * @brief Set the sensor_id tag of the points written next
+     * @param id Sensor index as text, or empty to omit the tag (single sensor)
+     */
+    void setSensorId(const char* id);
+    
+    /**
+     * @brief Start an upload session on one keep-alive connection
+     * 
+     * Connects immediately, so calling this at capture start hides the
+     * TCP/TLS setup behind the sampling time. Writes reconnect on their
+     * own if the connection was dropped in the meantime.
+     * @return true if the connection is open
+     */
+    bool beginSession();
+    
+    /**
+     * @brief End the upload session and close the connection
+     */
+    void endSession();
+    
     /**
      * @brief Write a single point in line protocol format
      * @param measurement Measurement name
@@ -61,6 +102,29 @@ public:
                             const float* xFreq, const float* yFreq, const float* zFreq,
                             size_t numBins, uint64_t baseTimestampNs);
     
+    /**
+     * @brief Write the three spectra as one packed point
+     * 
+     * Writes a single "accelspectrum" point instead of one line per bin.
+     * Each axis is quantized to uint16 against its own peak and sent
+     * base64-encoded (little endian) with the matching scale:
+     * magnitude[k] = value[k] * scale for bin k + first_bin. The DC bin
+     * is skipped, as in writeFrequencyData().
+     * @param operationId Operation identifier for tagging
+     * @param deviceId Unique device identifier
+     * @param runId Run identifier
+     * @param xFreq Array of X-axis frequency magnitudes
+     * @param yFreq Array of Y-axis frequency magnitudes
+     * @param zFreq Array of Z-axis frequency magnitudes
+     * @param numBins Number of frequency bins
+     * @param binHz Bin spacing in Hz
+     * @param timestampNs Timestamp in nanoseconds
+     * @return true if write successful
+     */
+    bool writePackedSpectra(const char* operationId, const char* deviceId, const char* runId,
+                            const float* xFreq, const float* yFreq, const float* zFreq,
+                            size_t numBins, float binHz, uint64_t timestampNs);
+    
     /**
      * @brief Write time domain data batch
      * @param operationId Operation identifier for tagging
@@ -78,15 +142,93 @@ public:
                        const float* x, const float* y, const float* z,
                        size_t numSamples, uint64_t baseTimestampNs, 
                        float sampleRateHz);
+    
+    /**
+     * @brief Write time domain data batch from raw sensor counts
+     * @param operationId Operation identifier for tagging
+     * @param deviceId Unique device identifier
+     * @param runId Run identifier
+     * @param xyz Interleaved X/Y/Z raw counts (3 per sample)
+     * @param scale Conversion factor to g (g per LSB)
+     * @param numSamples Number of samples
+     * @param baseTimestampNs Base timestamp in nanoseconds
+     * @param sampleRateHz Sample rate for timestamp calculation
+     * @return true if write successful
+     */
+    bool writeTimeData(const char* operationId, const char* deviceId, const char* runId,
+                       const int16_t* xyz, float scale,
+                       size_t numSamples, uint64_t baseTimestampNs,
+                       float sampleRateHz);
 
+    /**
+     * @brief Write the condition indicators of a run as one accelfeatures point
+     * 
+     * Fields per axis (prefix x_, y_, z_): rms, peak, crest, kurtosis,
+     * vel_rms (mm/s) and band_<lo>_<hi> (g RMS) for each non-empty band.
+     * @param operationId Operation identifier for tagging
+     * @param deviceId Unique device identifier
+     * @param runId Run identifier
+     * @param features Features from the processing stage
+     * @param timestampNs Timestamp in nanoseconds
+     * @return true if write successful
+     */
+    bool writeFeatures(const char* operationId, const char* deviceId, const char* runId,
+                       const RunFeatures& features, uint64_t timestampNs);
+    
+    /**
+     * @brief Write the deviation of a run from its baseline as one accelbaseline point
+     * 
+     * Fields: x_score, y_score, z_score, baseline_runs and, per changed
+     * bin i (1 = largest change), top<i>_axis, top<i>_hz, top<i>_amp and
+     * top<i>_base.
+     * @param operationId Operation identifier for tagging
+     * @param deviceId Unique device identifier
+     * @param runId Run identifier
+     * @param diff Result of SpectralBaseline::update()
+     * @param timestampNs Timestamp in nanoseconds
+     * @return true if write successful
+     */
+    bool writeSpectralDiff(const char* operationId, const char* deviceId, const char* runId,
+                           const SpectralDiff& diff, uint64_t timestampNs);
+    
     /**
      * @brief Write run-level metadata for downstream ML traceability
      */
     bool writeRunMetadata(const char* operationId, const char* deviceId, const char* runId,
-                          uint16_t sampleRateHz, uint16_t sampleCount, size_t fftSize,
+                          uint16_t sampleRateHz, float odrHz, uint8_t decimation,
+                          uint16_t sampleCount,
+                          uint32_t preTriggerFrames, int32_t triggerOffsetUs,
+                          uint32_t timingJitterUs, size_t fftSize,
+                          uint16_t averages,
+                          float zoomCenterHz, uint16_t zoomFactor,
                           uint16_t filterCutoffHz, float rangeG,
-                          bool sendTimeDomain, const char* firmwareVersion,
-                          uint64_t timestampNs);
+                          bool sendTimeDomain, const char* trigger,
+                          const char* firmwareVersion, uint64_t timestampNs);
+    
+    /**
+     * @brief Write a continuous-monitoring summary as one accelheartbeat point
+     * @param operationId Operation identifier for tagging
+     * @param deviceId Unique device identifier
+     * @param summary Detector statistics for the period
+     * @param timestampNs Timestamp in nanoseconds
+     * @return true if write successful
+     */
+    bool writeHeartbeat(const char* operationId, const char* deviceId,
+                        const MonitorSummary& summary, uint64_t timestampNs);
+    
+    /**
+     * @brief Write runtime metrics as one devicehealth point
+     * @param operationId Operation identifier for tagging
+     * @param deviceId Unique device identifier
+     * @param snap Metrics of the current window
+     * @param rssi WiFi signal strength in dBm
+     * @param journalPending Runs waiting in the journal
+     * @param timestampNs Timestamp in nanoseconds
+     * @return true if write successful
+     */
+    bool writeDeviceHealth(const char* operationId, const char* deviceId,
+                           const MetricsSnapshot& snap, int32_t rssi,
+                           uint32_t journalPending, uint64_t timestampNs);
     
     /**
      * @brief Get last error message
@@ -100,6 +242,16 @@ public:
      */
     bool isConfigured() const;
     
+    /**
+     * @brief Line protocol bytes produced in the current or last session
+     */
+    uint32_t sessionBytes() const { return _sessionBytes; }
+    
+    /**
+     * @brief Body bytes sent in the current or last session (after gzip)
+     */
+    uint32_t sessionWireBytes() const { return _sessionWireBytes; }
+    
 private:
     String _url;
     String _token;
@@ -107,20 +259,93 @@ private:
     String _bucket;
     String _lastError;
     
+    // Parsed from the URL in setConnection()
+    String _host;
+    uint16_t _port = 80;
+    String _basePath;
+    bool _https = false;
+    
     HTTPClient _http;
+    WiFiClient _plainClient;
+    WiFiClientSecure _secureClient;
+    WiFiClient* _client = nullptr;
+    LineProtocolEncoder _encoder;
+    
+    bool _inSession = false;
+    uint32_t _sessionRequests = 0;
+    uint32_t _sessionConnects = 0;
+    uint32_t _sessionBytes = 0;         // Line protocol produced
+    uint32_t _sessionWireBytes = 0;     // Body bytes sent (after gzip)
+    
+    bool _compress = false;
+    GzipStream _gzip;
+    
+    char _sensorId[8] = "";
     
     /**
-     * @brief Build the write API endpoint URL
-     * @return Full URL with query parameters
+     * @brief Build the write API path
+     * @return Path with query parameters
      */
-    String _buildWriteUrl();
+    String _buildWritePath();
     
     /**
-     * @brief Send line protocol data with retries
-     * @param lineProtocol Line protocol formatted data
-     * @return true if write successful
+     * @brief Split _url into scheme, host, port and base path
+     */
+    void _parseUrl();
+    
+    /**
+     * @brief Write count lines in batches, retrying each batch
+     * @param count Number of lines
+     * @param encodeLine Called as encodeLine(encoder, index) for each line
+     * @return true if every batch was accepted
+     */
+    template <typename EncodeLine>
+    bool _writeLines(size_t count, EncodeLine encodeLine);
+    
+    /**
+     * @brief Open the connection unless an open one can be reused
+     * @param reused Output: true if an existing connection was kept
+     * @return true if connected
+     */
+    bool _connect(bool& reused);
+    
+    /**
+     * @brief Close the connection
+     */
+    void _disconnect();
+    
+    /**
+     * @brief Connect and send the request headers of a chunked write
+     * @param reused Output: true if an existing connection was used
+     * @return true if the body can be streamed
+     */
+    bool _beginWrite(bool& reused);
+    
+    /**
+     * @brief Terminate the body and read the response
+     * @return HTTP status code, or -1 on connection failure
+     */
+    int _finishWrite();
+    
+    /**
+     * @brief Read status, headers and body of a response
+     * @param body Output: start of the body (for error messages)
+     * @param reusable Output: connection may carry another request
+     * @return HTTP status code, or -1 on timeout
+     */
+    int _readResponse(String& body, bool& reusable);
+    
+    bool _readLine(char* buf, size_t size, uint32_t deadline);
+    int _readByte(uint32_t deadline);
+    
+    /**
+     * @brief Write one HTTP chunk to the socket
      */
-    bool _sendLineProtocol(const String& lineProtocol);
+    bool _writeChunk(const uint8_t* data, size_t len);
+    
+    // Sinks for the encoder (plain or into gzip) and the gzip stage
+    static bool _encoderSink(void* ctx, const char* data, size_t len);
+    static bool _gzipSink(void* ctx, const uint8_t* data, size_t len);
 };
 
 // Global instance
@@ -0,0 +1,49 @@
+#include "latest_run.h"
+
+// Global instance
+LatestRun latestRun;
+
+void LatestRun::beginWrite(uint32_t waitMs) {
+    portENTER_CRITICAL(&_mux);
+    _valid = false;
+    _generation++;
+    portEXIT_CRITICAL(&_mux);
+
+    uint32_t start = millis();
+    while (_readers > 0 && millis() - start < waitMs) {
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+    if (_readers > 0) {
+        Serial.printf("[LatestRun] %lu download(s) still active, cutting them off\n",
+                      (unsigned long)_readers);
+    }
+}
+
+void LatestRun::publish(const RetainedRun& run) {
+    portENTER_CRITICAL(&_mux);
+    _run = run;
+    _valid = run.frames > 0;
+    portEXIT_CRITICAL(&_mux);
+}
+
+bool LatestRun::acquire(RetainedRun& run, uint32_t& generation) {
+    portENTER_CRITICAL(&_mux);
+    bool ok = _valid;
+    if (ok) {
+        run = _run;
+        generation = _generation;
+        _readers++;
+    }
+    portEXIT_CRITICAL(&_mux);
+    return ok;
+}
+
+bool LatestRun::isCurrent(uint32_t generation) const {
+    return _valid && _generation == generation;
+}
+
+void LatestRun::release() {
+    portENTER_CRITICAL(&_mux);
+    if (_readers > 0) _readers--;
+    portEXIT_CRITICAL(&_mux);
+}
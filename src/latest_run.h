@@ -0,0 +1,76 @@
+#ifndef LATEST_RUN_H
+#define LATEST_RUN_H
+
+#include <Arduino.h>
+#include "config.h"
+
+/**
+ * @brief The time-domain data of the last processed run, in place
+ *
+ * Points into the sample buffers owned by the processing task: counts
+ * is set in raw capture mode, axes otherwise (filtered, in g).
+ */
+struct RetainedRun {
+    uint32_t sequence;          // RunInfo::sequence
+    uint8_t sensor;             // RunInfo::sensor
+    uint64_t epochNs;           // Time of the first frame, 0 if the clock was not set
+    float odrHz;                // Measured sample rate
+    float scale;                // g per LSB of counts (and of the quantized axes)
+    size_t frames;
+    const int16_t* counts;      // Interleaved X/Y/Z counts, or nullptr
+    const float* axes[3];       // X, Y, Z in g when counts is nullptr
+};
+
+/**
+ * @brief Hand-over of the sample buffers to readers in other tasks
+ *
+ * The processing task publishes a run once its buffers are final and
+ * takes them back before ingesting the next one. Readers (downloads in
+ * the web server task) acquire the run, check isCurrent() before every
+ * block they read, and release it when done. beginWrite() waits a
+ * bounded time for readers to finish; a reader still active after that
+ * sees isCurrent() turn false and stops.
+ */
+class LatestRun {
+public:
+    /**
+     * @brief Withdraw the published run before overwriting the buffers
+     * @param waitMs Longest time to wait for active readers
+     */
+    void beginWrite(uint32_t waitMs);
+
+    /**
+     * @brief Publish the run now held in the buffers
+     */
+    void publish(const RetainedRun& run);
+
+    /**
+     * @brief Start reading the published run
+     * @param run Output: run descriptor
+     * @param generation Output: token for isCurrent()
+     * @return false if no run is published; release() is not needed then
+     */
+    bool acquire(RetainedRun& run, uint32_t& generation);
+
+    /**
+     * @brief Whether the buffers still hold the acquired run
+     */
+    bool isCurrent(uint32_t generation) const;
+
+    /**
+     * @brief Finish a read started with acquire()
+     */
+    void release();
+
+private:
+    RetainedRun _run = {};
+    volatile bool _valid = false;
+    volatile uint32_t _generation = 0;
+    volatile uint32_t _readers = 0;
+    portMUX_TYPE _mux = portMUX_INITIALIZER_UNLOCKED;
+};
+
+// Global instance
+extern LatestRun latestRun;
+
+#endif // LATEST_RUN_H
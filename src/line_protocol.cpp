@@ -0,0 +1,243 @@
+#include "line_protocol.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+static const char BASE64[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+static const uint32_t POW10[] = {
+    1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000
+};
+
+size_t LineProtocolEncoder::formatUint(char* out, uint64_t value) {
+    char tmp[20];
+    size_t n = 0;
+    do {
+        tmp[n++] = '0' + (char)(value % 10);
+        value /= 10;
+    } while (value > 0);
+
+    for (size_t i = 0; i < n; i++) {
+        out[i] = tmp[n - 1 - i];
+    }
+    return n;
+}
+
+size_t LineProtocolEncoder::formatFloat(char* out, float value, uint8_t decimals) {
+    if (decimals > 9) decimals = 9;
+    char* p = out;
+
+    // Line protocol has no NaN/Inf; a bad sample must not reject the batch
+    if (isnan(value) || isinf(value)) {
+        *p++ = '0';
+        return 1;
+    }
+
+    if (value < 0.0f) {
+        *p++ = '-';
+        value = -value;
+    }
+
+    // Out of uint32 range: rare enough to leave to printf
+    if (value >= 4.0e9f) {
+        return (p - out) + snprintf(p, 23, "%.6e", value);
+    }
+
+    // Integer and fraction are split in float; the fraction is exact,
+    // so the rounded digits match "%.Nf" to within float precision.
+    uint32_t intPart = (uint32_t)value;
+    float frac = value - (float)intPart;
+    uint32_t scale = POW10[decimals];
+    uint32_t fracPart = (uint32_t)(frac * (float)scale + 0.5f);
+    if (fracPart >= scale) {
+        fracPart -= scale;
+        intPart++;
+    }
+
+    p += formatUint(p, intPart);
+
+    if (decimals > 0) {
+        *p++ = '.';
+        for (int d = decimals - 1; d >= 0; d--) {
+            p[d] = '0' + (char)(fracPart % 10);
+            fracPart /= 10;
+        }
+        p += decimals;
+    }
+
+    return p - out;
+}
+
+void LineProtocolEncoder::begin(Sink sink, void* ctx) {
+    _sink = sink;
+    _ctx = ctx;
+    _len = 0;
+    _total = 0;
+    _failed = false;
+    _firstField = true;
+}
+
+void LineProtocolEncoder::_prefixEscaped(const char* s, const char* special) {
+    if (!s) return;
+    for (size_t i = 0; s[i] != '\0'; i++) {
+        if (_prefixLen + 2 >= PREFIX_SIZE) return;
+        if (strchr(special, s[i])) {
+            _prefix[_prefixLen++] = '\\';
+        }
+        _prefix[_prefixLen++] = s[i];
+    }
+}
+
+void LineProtocolEncoder::setMeasurement(const char* measurement) {
+    _prefixLen = 0;
+    _prefixEscaped(measurement, ", ");
+}
+
+void LineProtocolEncoder::addTag(const char* key, const char* value) {
+    if (!value || value[0] == '\0') return;  // Empty tag values are invalid
+    if (_prefixLen + 1 >= PREFIX_SIZE) return;
+    _prefix[_prefixLen++] = ',';
+    _prefixEscaped(key, ",= ");
+    if (_prefixLen + 1 >= PREFIX_SIZE) return;
+    _prefix[_prefixLen++] = '=';
+    _prefixEscaped(value, ",= ");
+}
+
+void LineProtocolEncoder::_reserve(size_t n) {
+    if (_len + n > sizeof(_chunk)) {
+        flush();
+    }
+}
+
+void LineProtocolEncoder::_put(char c) {
+    _reserve(1);
+    _chunk[_len++] = c;
+}
+
+void LineProtocolEncoder::_put(const char* s, size_t n) {
+    while (n > 0) {
+        size_t room = sizeof(_chunk) - _len;
+        if (room == 0) {
+            flush();
+            room = sizeof(_chunk);
+        }
+        size_t take = n < room ? n : room;
+        memcpy(_chunk + _len, s, take);
+        _len += take;
+        s += take;
+        n -= take;
+    }
+}
+
+void LineProtocolEncoder::beginLine() {
+    _put(_prefix, _prefixLen);
+    _firstField = true;
+}
+
+void LineProtocolEncoder::_fieldKey(const char* key) {
+    _put(_firstField ? ' ' : ',');
+    _firstField = false;
+    _put(key, strlen(key));
+    _put('=');
+}
+
+void LineProtocolEncoder::field(const char* key, float value) {
+    field(key, value, 6);
+}
+
+void LineProtocolEncoder::field(const char* key, float value, uint8_t decimals) {
+    _fieldKey(key);
+    _reserve(24);
+    _len += formatFloat(_chunk + _len, value, decimals);
+}
+
+void LineProtocolEncoder::fieldExp(const char* key, float value) {
+    if (isnan(value) || isinf(value)) {
+        value = 0.0f;
+    }
+    _fieldKey(key);
+    _reserve(24);
+    _len += snprintf(_chunk + _len, 24, "%.7e", value);
+}
+
+void LineProtocolEncoder::fieldInt(const char* key, int64_t value) {
+    _fieldKey(key);
+    _reserve(22);
+    if (value < 0) {
+        _chunk[_len++] = '-';
+        _len += formatUint(_chunk + _len, (uint64_t)(-(value + 1)) + 1);
+    } else {
+        _len += formatUint(_chunk + _len, (uint64_t)value);
+    }
+    _chunk[_len++] = 'i';
+}
+
+void LineProtocolEncoder::fieldBool(const char* key, bool value) {
+    _fieldKey(key);
+    if (value) {
+        _put("true", 4);
+    } else {
+        _put("false", 5);
+    }
+}
+
+void LineProtocolEncoder::fieldString(const char* key, const char* value) {
+    _fieldKey(key);
+    _put('"');
+    for (size_t i = 0; value && value[i] != '\0'; i++) {
+        if (value[i] == '"' || value[i] == '\\') {
+            _put('\\');
+        }
+        _put(value[i]);
+    }
+    _put('"');
+}
+
+void LineProtocolEncoder::beginBase64Field(const char* key) {
+    _fieldKey(key);
+    _put('"');
+}
+
+void LineProtocolEncoder::base64(const uint8_t* data, size_t len) {
+    for (size_t i = 0; i < len; i += 3) {
+        uint32_t v = (uint32_t)data[i] << 16;
+        if (i + 1 < len) v |= (uint32_t)data[i + 1] << 8;
+        if (i + 2 < len) v |= data[i + 2];
+
+        _reserve(4);
+        _chunk[_len++] = BASE64[(v >> 18) & 0x3F];
+        _chunk[_len++] = BASE64[(v >> 12) & 0x3F];
+        _chunk[_len++] = i + 1 < len ? BASE64[(v >> 6) & 0x3F] : '=';
+        _chunk[_len++] = i + 2 < len ? BASE64[v & 0x3F] : '=';
+    }
+}
+
+void LineProtocolEncoder::endBase64Field() {
+    _put('"');
+}
+
+void LineProtocolEncoder::endLine(uint64_t timestampNs) {
+    if (timestampNs > 0) {
+        _reserve(22);
+        _chunk[_len++] = ' ';
+        _len += formatUint(_chunk + _len, timestampNs);
+    }
+    _put('\n');
+}
+
+void LineProtocolEncoder::raw(const char* data, size_t len) {
+    _put(data, len);
+}
+
+bool LineProtocolEncoder::flush() {
+    if (_len > 0) {
+        // Keep draining after a failure so callers can finish their loop
+        if (!_failed && (!_sink || !_sink(_ctx, _chunk, _len))) {
+            _failed = true;
+        }
+        _total += _len;
+        _len = 0;
+    }
+    return !_failed;
+}
@@ -0,0 +1,169 @@
+#ifndef LINE_PROTOCOL_H
+#define LINE_PROTOCOL_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "config.h"
+
+/**
+ * @brief Streaming InfluxDB line protocol encoder
+ *
+ * Formats points into a fixed chunk buffer and hands each full chunk
+ * to a sink (e.g. a socket writer), so a batch of any size is encoded
+ * without building it in memory. The measurement and tag set are
+ * rendered once into a prefix that is copied at the start of every
+ * line, and numbers are formatted without printf.
+ *
+ * Usage per line: beginLine(), field()..., endLine(timestampNs).
+ */
+class LineProtocolEncoder {
+public:
+    /**
+     * @brief Receives encoded bytes
+     * @param ctx Context pointer given to begin()
+     * @param data Encoded bytes
+     * @param len Number of bytes
+     * @return false to abort encoding (e.g. socket closed)
+     */
+    typedef bool (*Sink)(void* ctx, const char* data, size_t len);
+
+    /**
+     * @brief Start a new body
+     * @param sink Function receiving each full chunk
+     * @param ctx Context passed to the sink
+     */
+    void begin(Sink sink, void* ctx);
+
+    /**
+     * @brief Set the measurement for following lines (clears tags)
+     * @param measurement Measurement name
+     */
+    void setMeasurement(const char* measurement);
+
+    /**
+     * @brief Append a tag to the pre-rendered prefix (value is escaped)
+     * @param key Tag key
+     * @param value Tag value
+     */
+    void addTag(const char* key, const char* value);
+
+    /**
+     * @brief Start a line with the measurement and tag prefix
+     */
+    void beginLine();
+
+    /**
+     * @brief Append a float field, formatted like "%.6f"
+     */
+    void field(const char* key, float value);
+
+    /**
+     * @brief Append a float field with a given number of decimals (0-9)
+     */
+    void field(const char* key, float value, uint8_t decimals);
+
+    /**
+     * @brief Append a float field in exponent notation ("%.7e")
+     *
+     * For values of unknown magnitude such as scale factors; uses printf,
+     * so keep it out of per-sample loops.
+     */
+    void fieldExp(const char* key, float value);
+
+    /**
+     * @brief Append an integer field ("123i")
+     */
+    void fieldInt(const char* key, int64_t value);
+
+    /**
+     * @brief Append a boolean field
+     */
+    void fieldBool(const char* key, bool value);
+
+    /**
+     * @brief Append a string field (quotes and backslashes are escaped)
+     */
+    void fieldString(const char* key, const char* value);
+
+    /**
+     * @brief Start a string field whose value is streamed with base64()
+     */
+    void beginBase64Field(const char* key);
+
+    /**
+     * @brief Append base64 of data to the open string field
+     *
+     * Pieces are encoded independently, so every piece but the last
+     * must be a multiple of 3 bytes.
+     */
+    void base64(const uint8_t* data, size_t len);
+
+    /**
+     * @brief Close the string field opened by beginBase64Field()
+     */
+    void endBase64Field();
+
+    /**
+     * @brief Finish the line
+     * @param timestampNs Timestamp in nanoseconds (0 = server time)
+     */
+    void endLine(uint64_t timestampNs = 0);
+
+    /**
+     * @brief Append pre-formatted line protocol text verbatim
+     */
+    void raw(const char* data, size_t len);
+
+    /**
+     * @brief Hand any buffered bytes to the sink
+     * @return false if the sink failed at any point since begin()
+     */
+    bool flush();
+
+    /**
+     * @brief Whether the sink failed since begin()
+     */
+    bool failed() const { return _failed; }
+
+    /**
+     * @brief Bytes produced since begin()
+     */
+    size_t bytesWritten() const { return _total + _len; }
+
+    /**
+     * @brief Format a float with fixed decimals (no trailing NUL)
+     * @param out Destination, at least 24 bytes
+     * @return Number of characters written
+     */
+    static size_t formatFloat(char* out, float value, uint8_t decimals = 6);
+
+    /**
+     * @brief Format an unsigned integer (no trailing NUL)
+     * @param out Destination, at least 20 bytes
+     * @return Number of characters written
+     */
+    static size_t formatUint(char* out, uint64_t value);
+
+private:
+    static constexpr size_t PREFIX_SIZE = 192;
+
+    char _chunk[INFLUX_CHUNK_BYTES];
+    size_t _len = 0;
+    size_t _total = 0;
+
+    char _prefix[PREFIX_SIZE];
+    size_t _prefixLen = 0;
+
+    Sink _sink = nullptr;
+    void* _ctx = nullptr;
+    bool _failed = false;
+    bool _firstField = true;
+
+    void _reserve(size_t n);
+    void _put(char c);
+    void _put(const char* s, size_t n);
+    void _fieldKey(const char* key);
+    void _prefixEscaped(const char* s, const char* special);
+};
+
+#endif // LINE_PROTOCOL_H
@@ -5,6 +5,8 @@
  * 
  * Features:
  * - ADXL313 3-axis accelerometer sampling at 3200 Hz
+ * - Pinned acquisition task feeding a lock-free ring (core 1),
+ *   processing and upload task (core 0)
  * - PLC trigger input for synchronized measurements
  * - Butterworth low-pass filtering
  * - FFT for frequency domain analysis
@@ -28,7 +30,15 @@
 #include "adxl313.h"
 #include "dsp.h"
 #include "influxdb_client.h"
+#include "acquisition.h"
+#include "run_journal.h"
+#include "feature_extraction.h"
+#include "spectral_baseline.h"
+#include "metrics.h"
+#include "latest_run.h"
 #include <sys/time.h>
+#include <esp_heap_caps.h>
+#include <esp_timer.h>
 
 // ============================================================================
 // Global State
@@ -38,9 +48,14 @@ volatile uint32_t lastTriggerTime = 0;
 portMUX_TYPE triggerMux = portMUX_INITIALIZER_UNLOCKED;
 
 // Sampling buffers (allocated dynamically)
+// Float mode keeps per-axis buffers in g; raw mode keeps interleaved
+// int16 counts plus one float work buffer shared by the three axes.
 float* bufferX = nullptr;
 float* bufferY = nullptr;
 float* bufferZ = nullptr;
+RawFrame* rawBuffer = nullptr;
+float* workBuffer = nullptr;
+bool rawCaptureMode = false;
 float* freqBins = nullptr;
 float* fftX = nullptr;
 float* fftY = nullptr;
@@ -48,13 +63,51 @@ float* fftZ = nullptr;
 
 size_t currentSampleCount = 0;
 
+// Condition indicators of the last processed run
+RunFeatures runFeatures;
+
+// Deviation of the last processed run from its sensor's baseline
+SpectralDiff runDiff;
+
+// Measured sample timing of the last ingested run
+RunTiming runTiming;
+
+// Sensors 1..sensor_count-1; sensor 0 is the global adxl313
+static ADXL313 auxSensors[MAX_SENSORS - 1];
+
+// Spectrum of the last processed run (a Welch segment or the padded capture)
+size_t spectrumFftSize = 0;
+size_t spectrumBins = 0;
+uint16_t spectrumAverages = 1;
+float spectrumZoomCenterHz = 0.0f;
+uint16_t spectrumZoomFactor = 0;
+
+// Bins the spectrum arrays hold; zoom mode only needs the zoomed band.
+// The band is fixed when the arrays are sized: a config saved since only
+// applies after the restart that follows it.
+static size_t spectrumCapacity = 0;
+static size_t zoomedBins = 0;
+static uint8_t zoomedFactor = 0;
+static float zoomedCenterHz = 0.0f;
+
+// Welch averaging state of the run being ingested
+struct WelchState {
+    size_t segment;     // Segment length, 0 = one FFT over the capture
+    size_t hop;         // Samples between segment starts
+    size_t next;        // Start of the next segment
+    size_t count;       // Segments accumulated
+};
+static WelchState welch = {};
+
+// Streaming filter state per axis (FILTER_MODE_STREAMING, float mode)
+static DSP::FilterState filterStates[3];
+static bool filteredDuringIngest = false;
+
 // Run ID for InfluxDB
 char runId[64];
 uint32_t runSequence = 0;
 uint64_t lastUploadTimestampNs = 0;
 
-static constexpr const char* FW_VERSION = "1.1.0";
-
 static bool getCurrentEpochTimestampNs(uint64_t& timestampNs) {
     struct timeval tv;
     if (gettimeofday(&tv, nullptr) != 0) {
@@ -70,6 +123,17 @@ static bool getCurrentEpochTimestampNs(uint64_t& timestampNs) {
     return true;
 }
 
+// Epoch time of an esp_timer timestamp taken earlier in this boot
+static bool epochAtTimerUs(int64_t timerUs, uint64_t& timestampNs) {
+    int64_t nowUs = esp_timer_get_time();
+    uint64_t nowNs;
+    if (!getCurrentEpochTimestampNs(nowNs)) {
+        return false;
+    }
+    timestampNs = nowNs - (uint64_t)(nowUs - timerUs) * 1000ULL;
+    return true;
+}
+
 static float getRangeGFromSensitivity(uint8_t sensitivity) {
     switch (sensitivity) {
         case ADXL313_RANGE_0_5G: return 0.5f;
@@ -80,6 +144,39 @@ static float getRangeGFromSensitivity(uint8_t sensitivity) {
     }
 }
 
+// ============================================================================
+// Heap Diagnostics
+// ============================================================================
+static size_t heapFreeNow() {
+    return heap_caps_get_free_size(MALLOC_CAP_8BIT);
+}
+
+// Free/largest/min-free report; baseline > 0 also prints the change since then
+static void logHeapReport(const char* stage, size_t baseline = 0) {
+    size_t freeBytes = heapFreeNow();
+    size_t largest = heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+    size_t minFree = heap_caps_get_minimum_free_size(MALLOC_CAP_8BIT);
+    float fragmentation = freeBytes > 0 ? 100.0f * (1.0f - (float)largest / (float)freeBytes) : 0.0f;
+    
+    Serial.printf("[Heap] %s: free %u, largest block %u, min free %u, fragmentation %.1f%%",
+                  stage, (unsigned)freeBytes, (unsigned)largest, (unsigned)minFree, fragmentation);
+    if (baseline > 0) {
+        Serial.printf(", delta %d", (int)freeBytes - (int)baseline);
+    }
+    Serial.println();
+}
+
+static void logBootPhases() {
+    Serial.print("[Boot]");
+    for (uint8_t p = 0; p < BOOT_PHASES; p++) {
+        uint32_t ms = metrics.bootMs((BootPhase)p);
+        if (ms > 0) {
+            Serial.printf(" %s %lu ms", Metrics::bootPhaseName(p), (unsigned long)ms);
+        }
+    }
+    Serial.println();
+}
+
 // ============================================================================
 // ISR: PLC Trigger
 // ============================================================================
@@ -91,32 +188,72 @@ void IRAM_ATTR plcTriggerISR() {
     if (now - lastTriggerTime > 100) {  // 100ms debounce
         triggerPending = true;
         lastTriggerTime = now;
+        acquisition.markTrigger();
     }
     
     portEXIT_CRITICAL_ISR(&triggerMux);
+    
+    acquisition.wakeFromISR();
+}
+
+// Called by the acquisition task to claim a pending trigger
+static bool takeTrigger() {
+    bool pending = false;
+    portENTER_CRITICAL(&triggerMux);
+    if (triggerPending) {
+        triggerPending = false;
+        pending = true;
+    }
+    portEXIT_CRITICAL(&triggerMux);
+    return pending;
 }
 
 // ============================================================================
 // Buffer Management
 // ============================================================================
-bool allocateBuffers(size_t sampleCount) {
+// Bins of the zoomed band, or 0 for the full spectrum
+static size_t zoomBinCount(const DeviceConfig& cfg, size_t sampleCount) {
+    uint8_t factor = cfg.zoom_factor;
+    if (factor < 2 || factor > ZOOM_MAX_FACTOR || (factor & (factor - 1)) != 0 ||
+        cfg.zoom_center_hz == 0) {
+        return 0;
+    }
+    size_t bins = DSP::nextPowerOf2(sampleCount) / factor;
+    return bins >= ZOOM_MIN_BINS ? bins : 0;
+}
+
+bool allocateBuffers(size_t sampleCount, bool rawCapture) {
     // Free existing buffers
     if (bufferX) { free(bufferX); bufferX = nullptr; }
     if (bufferY) { free(bufferY); bufferY = nullptr; }
     if (bufferZ) { free(bufferZ); bufferZ = nullptr; }
+    if (rawBuffer) { free(rawBuffer); rawBuffer = nullptr; }
+    if (workBuffer) { free(workBuffer); workBuffer = nullptr; }
     if (freqBins) { free(freqBins); freqBins = nullptr; }
     if (fftX) { free(fftX); fftX = nullptr; }
     if (fftY) { free(fftY); fftY = nullptr; }
     if (fftZ) { free(fftZ); fftZ = nullptr; }
     
-    // Calculate FFT size (power of 2)
+    // Calculate FFT size (power of 2); a zoomed spectrum only keeps its band
     size_t fftSize = DSP::nextPowerOf2(sampleCount);
-    size_t numBins = fftSize / 2 + 1;
+    const DeviceConfig& cfg = configManager.getConfig();
+    zoomedBins = zoomBinCount(cfg, sampleCount);
+    zoomedFactor = zoomedBins > 0 ? cfg.zoom_factor : 0;
+    zoomedCenterHz = zoomedBins > 0 ? cfg.zoom_center_hz : 0.0f;
+    size_t numBins = zoomedBins > 0 ? zoomedBins : fftSize / 2 + 1;
     
     // Allocate time-domain buffers
-    bufferX = (float*)malloc(sampleCount * sizeof(float));
-    bufferY = (float*)malloc(sampleCount * sizeof(float));
-    bufferZ = (float*)malloc(sampleCount * sizeof(float));
+    bool timeOk;
+    if (rawCapture) {
+        rawBuffer = (RawFrame*)malloc(sampleCount * sizeof(RawFrame));
+        workBuffer = (float*)malloc(sampleCount * sizeof(float));
+        timeOk = rawBuffer && workBuffer;
+    } else {
+        bufferX = (float*)malloc(sampleCount * sizeof(float));
+        bufferY = (float*)malloc(sampleCount * sizeof(float));
+        bufferZ = (float*)malloc(sampleCount * sizeof(float));
+        timeOk = bufferX && bufferY && bufferZ;
+    }
     
     // Allocate frequency-domain buffers
     freqBins = (float*)malloc(numBins * sizeof(float));
@@ -124,116 +261,283 @@ bool allocateBuffers(size_t sampleCount) {
     fftY = (float*)malloc(numBins * sizeof(float));
     fftZ = (float*)malloc(numBins * sizeof(float));
     
-    if (!bufferX || !bufferY || !bufferZ || !freqBins || !fftX || !fftY || !fftZ) {
+    if (!timeOk || !freqBins || !fftX || !fftY || !fftZ) {
         Serial.println("[Main] Buffer allocation failed!");
         return false;
     }
     
+    // DSP scratch is sized here too, so processing never allocates; the
+    // zoom FFT needs one complex point per bin
+    if (!dsp.allocateWorkspace(zoomedBins > 0 ? 2 * zoomedBins : sampleCount)) {
+        return false;
+    }
+    
+    spectrumCapacity = numBins;
     currentSampleCount = sampleCount;
-    Serial.printf("[Main] Buffers allocated: %d samples, %d freq bins, heap free: %d\n",
-                  sampleCount, numBins, ESP.getFreeHeap());
+    rawCaptureMode = rawCapture;
+    Serial.printf("[Main] Buffers allocated: %d samples (%s), %d freq bins, heap free: %d\n",
+                  sampleCount, rawCapture ? "raw int16" : "float", numBins, ESP.getFreeHeap());
     
     return true;
 }
 
 // ============================================================================
-// Sampling
+// Ingest
 // ============================================================================
-void performSampling() {
-    DeviceConfig& cfg = configManager.getConfig();
-    
-    Serial.println("\n========================================");
-    Serial.println("[Main] Trigger received - starting measurement");
-    Serial.println("========================================");
+static size_t welchSegmentLength(const DeviceConfig& cfg) {
+    size_t seg = cfg.welch_segment;
+    // Zoom mode sizes the spectrum arrays for its band only
+    if (zoomedBins > 0 || seg < WELCH_MIN_SEGMENT || (seg & (seg - 1)) != 0 ||
+        seg > currentSampleCount) {
+        return 0;
+    }
+    return seg;
+}
+
+static void beginWelch(const DeviceConfig& cfg) {
+    welch.segment = welchSegmentLength(cfg);
+    welch.next = 0;
+    welch.count = 0;
+    if (welch.segment == 0) {
+        return;
+    }
     
-    unsigned long startTime = micros();
+    uint8_t overlap = cfg.welch_overlap_pct > WELCH_MAX_OVERLAP_PCT
+                          ? WELCH_MAX_OVERLAP_PCT : cfg.welch_overlap_pct;
+    welch.hop = welch.segment * (100 - overlap) / 100;
     
-    // Sample interval in microseconds
-    uint32_t sampleIntervalUs = 1000000 / cfg.sample_rate_hz;
-    uint32_t nextSampleTime = micros();
+    // The spectrum arrays are the accumulators
+    size_t numBins = welch.segment / 2 + 1;
+    memset(fftX, 0, numBins * sizeof(float));
+    memset(fftY, 0, numBins * sizeof(float));
+    memset(fftZ, 0, numBins * sizeof(float));
+}
+
+// Accumulate every segment that is complete within the first `available` samples
+static void feedWelch(const RunInfo& run, size_t available) {
+    float* spectra[3] = { fftX, fftY, fftZ };
+    while (welch.segment > 0 && welch.next + welch.segment <= available) {
+        if (rawCaptureMode) {
+            const int16_t* counts = reinterpret_cast<const int16_t*>(rawBuffer + welch.next);
+            for (int axis = 0; axis < 3; axis++) {
+                dsp.accumulateSpectrum(counts + axis, 3, run.scale, welch.segment, spectra[axis]);
+            }
+        } else {
+            const float* axes[3] = { bufferX, bufferY, bufferZ };
+            for (int axis = 0; axis < 3; axis++) {
+                dsp.accumulateSpectrum(axes[axis] + welch.next, 1, 1.0f, welch.segment, spectra[axis]);
+            }
+        }
+        welch.next += welch.hop;
+        welch.count++;
+    }
+}
+
+void ingestRun(const RunInfo& run) {
+    DeviceConfig& cfg = configManager.getConfig();
+    beginWelch(cfg);
     
-    // Disable WiFi interrupts for consistent timing
-    WiFi.setSleep(true);
+    // Streaming mode filters each chunk as it lands in the float buffers;
+    // raw mode has no per-axis float buffers and filters after the capture
+    dsp.designButterworth(cfg.filter_cutoff_hz, acquisition.storedRateHz(), 4);
+    filteredDuringIngest = cfg.filter_mode == FILTER_MODE_STREAMING && !rawCaptureMode;
     
-    // Sampling loop
-    for (size_t i = 0; i < currentSampleCount; i++) {
-        // Wait for next sample time
-        while (micros() < nextSampleTime) {
-            // Busy wait for timing accuracy
+    // Frames are consumed as they arrive, overlapping with the capture;
+    // Welch segments are transformed as soon as they are complete
+    size_t i = 0;
+    while (i < run.frameCount) {
+        const RawFrame* frames;
+        size_t n = acquisition.peekFrames(run.sensor, &frames, 1000);
+        if (n == 0) {
+            Serial.printf("[Main] Waiting for samples (%d/%d)\n", i, run.frameCount);
+            continue;
         }
-        nextSampleTime += sampleIntervalUs;
+        if (n > run.frameCount - i) n = run.frameCount - i;
         
-        // Read accelerometer
-        float x, y, z;
-        if (adxl313.readAccel(x, y, z)) {
-            bufferX[i] = x;
-            bufferY[i] = y;
-            bufferZ[i] = z;
+        if (rawCaptureMode) {
+            // Counts stay packed; scaling happens in the filter input pass
+            memcpy(rawBuffer + i, frames, n * sizeof(RawFrame));
+            i += n;
         } else {
-            bufferX[i] = 0;
-            bufferY[i] = 0;
-            bufferZ[i] = 0;
+            size_t start = i;
+            for (size_t k = 0; k < n; k++, i++) {
+                bufferX[i] = frames[k].x * run.scale;
+                bufferY[i] = frames[k].y * run.scale;
+                bufferZ[i] = frames[k].z * run.scale;
+            }
+            if (filteredDuringIngest) {
+                float* axes[3] = { bufferX, bufferY, bufferZ };
+                for (int axis = 0; axis < 3; axis++) {
+                    if (start == 0) {
+                        dsp.initFilterState(filterStates[axis], axes[axis][0]);
+                    }
+                    dsp.applyFilter(axes[axis] + start, n, filterStates[axis]);
+                }
+            }
         }
+        acquisition.consumeFrames(run.sensor, n);
+        feedWelch(run, i);
     }
     
-    // Re-enable WiFi
-    WiFi.setSleep(false);
-    
-    unsigned long endTime = micros();
-    float actualDuration = (endTime - startTime) / 1000000.0f;
-    float actualRate = currentSampleCount / actualDuration;
-    
-    Serial.printf("[Main] Sampling complete: %d samples in %.3f seconds\n", 
-                  currentSampleCount, actualDuration);
-    Serial.printf("[Main] Actual sampling rate: %.1f Hz\n", actualRate);
+    // Posted right after the last frame; the nominal rate stands in if lost
+    if (!acquisition.takeTiming(run, runTiming, 200)) {
+        Serial.println("[Main] Run timing missing, using nominal rate");
+        runTiming = {};
+        runTiming.sequence = run.sequence;
+        runTiming.sensor = run.sensor;
+        runTiming.odrHz = acquisition.storedRateHz();
+        runTiming.startUs = (int64_t)run.triggerMillis * 1000;
+        runTiming.edgeUs = runTiming.startUs;
+    }
 }
 
 // ============================================================================
 // Signal Processing
 // ============================================================================
-void processData() {
-    DeviceConfig& cfg = configManager.getConfig();
-    
-    Serial.println("[Main] Processing data...");
-    unsigned long startTime = millis();
-    
-    // Design and apply Butterworth filter
-    dsp.designButterworth(cfg.filter_cutoff_hz, cfg.sample_rate_hz, 4);
+// Full spectrum, or the zoomed band in zoom mode
+static size_t computeSpectrum(const float* data, float* out) {
+    if (zoomedBins > 0) {
+        // The mixer needs the measured rate to land on the configured band;
+        // the anti-alias filter is designed at the nominal one, so it stays cached
+        return dsp.computeZoomFFT(data, out, currentSampleCount, runTiming.odrHz,
+                                  acquisition.storedRateHz(), zoomedCenterHz, zoomedFactor);
+    }
+    return dsp.computeFFT(data, out, currentSampleCount);
+}
+
+// Bin frequencies from the measured ODR, which differs from the nominal
+// rate by the sensor's clock error; zoomed bins are centered on the band
+static void fillFreqBins(size_t numBins, size_t fftSize, float odrHz,
+                         uint16_t zoomFactor, float zoomCenterHz) {
+    for (size_t i = 0; i < numBins; i++) {
+        freqBins[i] = zoomFactor > 0
+            ? zoomCenterHz + ((float)i - (float)(numBins / 2)) * odrHz / (float)fftSize
+            : DSP::binToFrequency(i, fftSize, odrHz);
+    }
+}
+
+static size_t processRaw(const RunInfo& run, const DeviceConfig& cfg, bool fft) {
+    // One axis at a time through the shared work buffer: the filter's
+    // forward pass reads the packed counts and applies the scale.
+    const int16_t* counts = reinterpret_cast<const int16_t*>(rawBuffer);
+    float* spectra[3] = { fftX, fftY, fftZ };
+    size_t numBins = 0;
     
-    dsp.applyFiltFilt(bufferX, currentSampleCount);
-    dsp.applyFiltFilt(bufferY, currentSampleCount);
-    dsp.applyFiltFilt(bufferZ, currentSampleCount);
+    for (int axis = 0; axis < 3; axis++) {
+        unsigned long axisStart = micros();
+        if (cfg.filter_mode == FILTER_MODE_STREAMING) {
+            // Causal, a single pass straight from the counts
+            DSP::FilterState state;
+            dsp.initFilterState(state, counts[axis] * run.scale);
+            dsp.applyFilter(counts + axis, 3, run.scale, workBuffer, currentSampleCount, state);
+        } else {
+            dsp.applyFiltFilt(counts + axis, 3, run.scale, workBuffer, currentSampleCount);
+        }
+        Features::computeTime(workBuffer, currentSampleCount, runFeatures.axis[axis]);
+        if (fft) {
+            numBins = computeSpectrum(workBuffer, spectra[axis]);
+        }
+        metrics.record(METRIC_DSP_AXIS_US, micros() - axisStart);
+    }
     
-    Serial.printf("[Main] Filtering complete, heap: %d\n", ESP.getFreeHeap());
+    Serial.printf("[Main] Filtering and FFT complete, heap: %d\n", ESP.getFreeHeap());
+    return numBins;
+}
+
+static size_t processFloat(const DeviceConfig& cfg, bool fft) {
+    float* buffers[3] = { bufferX, bufferY, bufferZ };
+    float* spectra[3] = { fftX, fftY, fftZ };
+    size_t numBins = 0;
     
-    // Compute FFT for each axis
-    // Note: We need copies because FFT modifies input
-    float* tempBuffer = (float*)malloc(currentSampleCount * sizeof(float));
-    if (!tempBuffer) {
-        Serial.println("[Main] FFT temp buffer allocation failed!");
-        return;
+    for (int axis = 0; axis < 3; axis++) {
+        unsigned long axisStart = micros();
+        // Streaming mode already filtered the buffers during ingest
+        if (!filteredDuringIngest) {
+            dsp.applyFiltFilt(buffers[axis], currentSampleCount);
+        }
+        Features::computeTime(buffers[axis], currentSampleCount, runFeatures.axis[axis]);
+        
+        // Input is copied into the DSP workspace
+        if (fft) {
+            numBins = computeSpectrum(buffers[axis], spectra[axis]);
+        }
+        metrics.record(METRIC_DSP_AXIS_US, micros() - axisStart);
     }
     
-    // FFT for X axis
-    memcpy(tempBuffer, bufferX, currentSampleCount * sizeof(float));
-    size_t numBins = dsp.computeFFT(tempBuffer, fftX, currentSampleCount, cfg.sample_rate_hz);
+    Serial.printf("[Main] Filtering and FFT complete, heap: %d\n", ESP.getFreeHeap());
+    return numBins;
+}
+
+void processData(const RunInfo& run) {
+    DeviceConfig& cfg = configManager.getConfig();
     
-    // FFT for Y axis
-    memcpy(tempBuffer, bufferY, currentSampleCount * sizeof(float));
-    dsp.computeFFT(tempBuffer, fftY, currentSampleCount, cfg.sample_rate_hz);
+    Serial.println("[Main] Processing data...");
+    unsigned long startTime = millis();
     
-    // FFT for Z axis
-    memcpy(tempBuffer, bufferZ, currentSampleCount * sizeof(float));
-    dsp.computeFFT(tempBuffer, fftZ, currentSampleCount, cfg.sample_rate_hz);
+    // Design Butterworth filter (cached unless the config changed)
+    dsp.designButterworth(cfg.filter_cutoff_hz, acquisition.storedRateHz(), 4);
     
-    free(tempBuffer);
+    // Welch spectra were accumulated during ingest; the filter pass is
+    // still needed for the time-domain features and upload
+    bool welchMode = welch.segment > 0 && welch.count > 0;
+    size_t numBins = rawCaptureMode ? processRaw(run, cfg, !welchMode)
+                                    : processFloat(cfg, !welchMode);
     
-    size_t fftSize = DSP::nextPowerOf2(currentSampleCount);
+    size_t fftSize;
+    if (welchMode) {
+        fftSize = welch.segment;
+        numBins = fftSize / 2 + 1;
+        // Segments from filtered buffers already carry the filter response;
+        // otherwise it is applied here as filtfilt would
+        bool applyResponse = !filteredDuringIngest;
+        dsp.finishSpectrum(fftX, numBins, welch.count, acquisition.storedRateHz(), applyResponse);
+        dsp.finishSpectrum(fftY, numBins, welch.count, acquisition.storedRateHz(), applyResponse);
+        dsp.finishSpectrum(fftZ, numBins, welch.count, acquisition.storedRateHz(), applyResponse);
+        Serial.printf("[Main] Welch spectrum: %d segments of %d\n", welch.count, welch.segment);
+    } else {
+        fftSize = DSP::nextPowerOf2(currentSampleCount);
+    }
+    spectrumFftSize = fftSize;
+    spectrumBins = numBins;
+    spectrumAverages = welchMode ? welch.count : 1;
+    spectrumZoomFactor = zoomedFactor;
+    spectrumZoomCenterHz = zoomedCenterHz;
 
-    // Calculate frequency values for each bin
-    for (size_t i = 0; i < numBins; i++) {
-        // Use actual FFT length (after zero-padding), not raw sample count.
-        freqBins[i] = DSP::binToFrequency(i, fftSize, cfg.sample_rate_hz);
+    // Use actual FFT length (after zero-padding), not raw sample count;
+    // a zoomed spectrum has the resolution of the full-length transform
+    fillFreqBins(numBins, fftSize, runTiming.odrHz, spectrumZoomFactor, spectrumZoomCenterHz);
+    
+    // Velocity and band energies need the spectrum from DC up; a zoomed
+    // band leaves them out (vel_rms 0, no band fields)
+    if (spectrumZoomFactor > 0) {
+        memset(runFeatures.bandEdgesHz, 0, sizeof(runFeatures.bandEdgesHz));
+        for (int axis = 0; axis < 3; axis++) {
+            runFeatures.axis[axis].velocityRms = 0.0f;
+            memset(runFeatures.axis[axis].bandRms, 0, sizeof(runFeatures.axis[axis].bandRms));
+        }
+        Serial.printf("[Main] Zoom spectrum: %d bins around %.1f Hz\n",
+                      numBins, spectrumZoomCenterHz);
+    } else {
+        // Spectral features from the magnitudes just computed
+        const float* spectra[3] = { fftX, fftY, fftZ };
+        float windowPower = dsp.windowPowerGain(welchMode ? welch.segment : currentSampleCount);
+        memcpy(runFeatures.bandEdgesHz, cfg.band_edges_hz, sizeof(runFeatures.bandEdgesHz));
+        for (int axis = 0; axis < 3; axis++) {
+            Features::computeSpectral(spectra[axis], numBins, fftSize, runTiming.odrHz,
+                                      windowPower, cfg.band_edges_hz, runFeatures.axis[axis]);
+        }
+    }
+    
+    // Compare with the baseline and fold this run in
+    memset(&runDiff, 0, sizeof(runDiff));
+    if (cfg.baseline_alpha_pct > 0) {
+        SpectralBaseline::Layout layout = {
+            (uint32_t)numBins, (uint32_t)fftSize, acquisition.storedRateHz(),
+            spectrumZoomCenterHz, spectrumZoomFactor, cfg.filter_cutoff_hz
+        };
+        const float* spectra[3] = { fftX, fftY, fftZ };
+        float alpha = cfg.baseline_alpha_pct > 100 ? 1.0f : cfg.baseline_alpha_pct / 100.0f;
+        spectralBaseline.update(run.sensor, layout, spectra, freqBins, alpha, runDiff);
     }
     
     unsigned long processingTime = millis() - startTime;
@@ -241,97 +545,423 @@ void processData() {
                   processingTime, numBins);
 }
 
+// Offer the final buffers to /api/run/latest downloads
+static void publishRun(const RunInfo& run) {
+    RetainedRun retained = {};
+    retained.sequence = run.sequence;
+    retained.sensor = run.sensor;
+    if (!epochAtTimerUs(runTiming.startUs, retained.epochNs)) {
+        retained.epochNs = 0;
+    }
+    retained.odrHz = runTiming.odrHz;
+    retained.scale = run.scale;
+    retained.frames = currentSampleCount;
+    retained.counts = rawCaptureMode ? reinterpret_cast<const int16_t*>(rawBuffer) : nullptr;
+    retained.axes[0] = bufferX;
+    retained.axes[1] = bufferY;
+    retained.axes[2] = bufferZ;
+    latestRun.publish(retained);
+}
+
 // ============================================================================
 // Data Upload
 // ============================================================================
-void uploadData() {
+// Frame block for journaling and replaying time-domain data
+static int16_t journalFrames[INFLUX_WRITE_BATCH_SIZE * 3];
+
+static void makeRunId(char* out, size_t size, uint64_t timestampNs) {
+    String deviceId = configManager.getDeviceId();
+    runSequence++;
+    snprintf(out, size, "%s-%llu-%lu",
+             deviceId.c_str(),
+             (unsigned long long)(timestampNs / 1000000000ULL),
+             (unsigned long)runSequence);
+}
+
+// Run metadata, features and spectra; shared by live uploads and journal replay
+static bool uploadSummary(const JournalRecord& rec, const char* id) {
     DeviceConfig& cfg = configManager.getConfig();
+    String deviceId = configManager.getDeviceId();
+    bool success = true;
+
+    // Upload run metadata first for traceability
+    success &= influxClient.writeRunMetadata(
+        rec.operationId, deviceId.c_str(), id,
+        rec.sampleRateHz, rec.odrHz, rec.decimation, rec.sampleCount, rec.preTriggerFrames,
+        rec.triggerOffsetUs, rec.timingJitterUs,
+        rec.fftSize, rec.averages, rec.zoomCenterHz, rec.zoomFactor,
+        rec.filterCutoffHz, rec.rangeG,
+        rec.timeFrames > 0, Acquisition::reasonName(rec.triggerReason),
+        rec.firmware, rec.epochNs
+    );
     
-    if (!configManager.isInfluxConfigured()) {
-        Serial.println("[Main] InfluxDB not configured, skipping upload");
-        return;
+    if (cfg.send_features) {
+        success &= influxClient.writeFeatures(
+            rec.operationId, deviceId.c_str(), id,
+            rec.features, rec.epochNs
+        );
     }
     
-    if (!wifiManager.isConnected()) {
-        Serial.println("[Main] WiFi not connected, skipping upload");
-        return;
+    // The spectra of a run close to its baseline are left out in
+    // changes-only mode; the scores and changed bins still go up
+    bool unchanged = false;
+    if (rec.diff.baselineRuns > 0) {
+        success &= influxClient.writeSpectralDiff(
+            rec.operationId, deviceId.c_str(), id,
+            rec.diff, rec.epochNs
+        );
+        unchanged = cfg.changes_only &&
+                    SpectralBaseline::maxScore(rec.diff) * 100.0f < cfg.change_threshold_pct;
+        if (unchanged) {
+            Serial.println("[Main] Spectrum within baseline, not uploaded");
+        }
     }
     
-    Serial.println("[Main] Uploading data to InfluxDB...");
-    unsigned long startTime = millis();
+    // Upload frequency domain data unless only features are wanted; the
+    // packed format assumes bins from 0 Hz, so a zoomed band goes per bin
+    bool packed = cfg.spectrum_format == SPECTRUM_FORMAT_PACKED && rec.zoomFactor == 0;
+    bool sendSpectrum = cfg.send_spectrum && !unchanged;
+    if (sendSpectrum && packed) {
+        success &= influxClient.writePackedSpectra(
+            rec.operationId, deviceId.c_str(), id,
+            fftX, fftY, fftZ, rec.numBins,
+            rec.odrHz / rec.fftSize, rec.epochNs
+        );
+    } else if (sendSpectrum) {
+        success &= influxClient.writeFrequencyData(
+            rec.operationId, deviceId.c_str(), id,
+            freqBins, fftX, fftY, fftZ,
+            rec.numBins, rec.epochNs
+        );
+    }
+    return success;
+}
 
-    if (!wifiManager.hasValidTime()) {
-        Serial.println("[Main] Time not synchronized, attempting SNTP sync...");
-        if (!wifiManager.syncTime()) {
-            Serial.println("[Main] SNTP time unavailable, skipping upload");
-            webServer.updateStatus(lastTriggerTime, currentSampleCount, false);
-            return;
-        }
+// sensor_id tag of the next points; omitted on single-sensor setups so
+// existing series keep their tag set
+static void tagSensor(uint8_t sensor) {
+    char id[4] = "";
+    if (configManager.getConfig().sensor_count > 1 || sensor > 0) {
+        snprintf(id, sizeof(id), "%u", sensor);
     }
+    influxClient.setSensorId(id);
+}
 
-    uint64_t baseTimestampNs = 0;
-    if (!getCurrentEpochTimestampNs(baseTimestampNs)) {
-        Serial.println("[Main] Failed to read epoch timestamp, skipping upload");
-        webServer.updateStatus(lastTriggerTime, currentSampleCount, false);
+static JournalRecord describeRun(const RunInfo& run, const DeviceConfig& cfg, uint64_t timestampNs) {
+    JournalRecord rec = {};
+    
+    rec.bootId = runJournal.bootId();
+    rec.uptimeMs = run.triggerMillis;
+    rec.sequence = run.sequence;
+    rec.sensor = run.sensor;
+    rec.epochNs = timestampNs;
+    strlcpy(rec.operationId, cfg.operation_id, sizeof(rec.operationId));
+    strlcpy(rec.firmware, FW_VERSION, sizeof(rec.firmware));
+    rec.sampleRateHz = (uint16_t)(acquisition.storedRateHz() + 0.5f);
+    rec.decimation = acquisition.decimation();
+    rec.sampleCount = currentSampleCount;
+    rec.filterCutoffHz = cfg.filter_cutoff_hz;
+    rec.numBins = spectrumBins;
+    rec.fftSize = spectrumFftSize;
+    rec.averages = spectrumAverages;
+    rec.zoomCenterHz = spectrumZoomCenterHz;
+    rec.zoomFactor = spectrumZoomFactor;
+    rec.triggerReason = run.reason;
+    rec.preTriggerFrames = run.preTriggerFrames;
+    rec.startUs = runTiming.startUs;
+    rec.odrHz = runTiming.odrHz;
+    rec.triggerOffsetUs = (int32_t)(runTiming.startUs - runTiming.edgeUs);
+    rec.timingJitterUs = runTiming.jitterUs;
+    rec.rangeG = getRangeGFromSensitivity(cfg.sensitivity);
+    rec.scale = run.scale;
+    rec.timeFrames = cfg.send_time_domain ? currentSampleCount : 0;
+    rec.features = runFeatures;
+    rec.diff = runDiff;
+    return rec;
+}
+
+// Store a run that could not be uploaded
+static void journalRun(const JournalRecord& rec) {
+    if (!runJournal.beginRecord(rec) || !runJournal.writeSpectra(fftX, fftY, fftZ)) {
+        runJournal.commitRecord();
         return;
     }
-
-    // Guarantee strictly increasing run timestamps to avoid collisions.
-    if (baseTimestampNs <= lastUploadTimestampNs) {
-        baseTimestampNs = lastUploadTimestampNs + 1;
+    
+    // Time data as counts: raw mode keeps the capture, float mode is
+    // quantized back to the sensor LSB
+    for (size_t start = 0; start < rec.timeFrames; start += INFLUX_WRITE_BATCH_SIZE) {
+        size_t n = rec.timeFrames - start;
+        if (n > INFLUX_WRITE_BATCH_SIZE) n = INFLUX_WRITE_BATCH_SIZE;
+        
+        if (rawCaptureMode) {
+            if (!runJournal.writeTime(reinterpret_cast<const int16_t*>(rawBuffer + start), n)) break;
+            continue;
+        }
+        const float* axes[3] = { bufferX + start, bufferY + start, bufferZ + start };
+        for (size_t i = 0; i < n; i++) {
+            for (int a = 0; a < 3; a++) {
+                float counts = roundf(axes[a][i] / rec.scale);
+                journalFrames[i * 3 + a] = (int16_t)constrain(counts, -32768.0f, 32767.0f);
+            }
+        }
+        if (!runJournal.writeTime(journalFrames, n)) break;
     }
-    lastUploadTimestampNs = baseTimestampNs;
+    runJournal.commitRecord();
+}
 
-    String deviceId = configManager.getDeviceId();
-    runSequence++;
-    snprintf(runId, sizeof(runId), "%s-%llu-%lu",
-             deviceId.c_str(),
-             (unsigned long long)(baseTimestampNs / 1000000000ULL),
-             (unsigned long)runSequence);
-    Serial.printf("[Main] Run ID: %s\n", runId);
+void uploadData(const RunInfo& run) {
+    DeviceConfig& cfg = configManager.getConfig();
     
-    // Calculate number of frequency bins
-    size_t fftSize = DSP::nextPowerOf2(currentSampleCount);
-    size_t numBins = fftSize / 2 + 1;
+    if (!configManager.isInfluxConfigured()) {
+        Serial.println("[Main] InfluxDB not configured, skipping upload");
+        return;
+    }
     
-    bool success = true;
-
-    // Upload run metadata first for traceability
-    success &= influxClient.writeRunMetadata(
-        cfg.operation_id, deviceId.c_str(), runId,
-        cfg.sample_rate_hz, currentSampleCount, fftSize,
-        cfg.filter_cutoff_hz, getRangeGFromSensitivity(cfg.sensitivity),
-        cfg.send_time_domain, FW_VERSION,
-        baseTimestampNs
-    );
+    // No wait for SNTP here: a run without a clock is journaled and
+    // dated once the WiFi manager has synced it
+    bool online = wifiManager.isConnected();
     
-    // Upload frequency domain data
-    success &= influxClient.writeFrequencyData(
-        cfg.operation_id, deviceId.c_str(), runId,
-        freqBins, fftX, fftY, fftZ,
-        numBins, baseTimestampNs
-    );
+    // Runs are stamped with the time of their first sample
+    uint64_t baseTimestampNs = 0;
+    bool haveTime = epochAtTimerUs(runTiming.startUs, baseTimestampNs);
+    if (haveTime) {
+        // Guarantee strictly increasing run timestamps to avoid collisions.
+        if (baseTimestampNs <= lastUploadTimestampNs) {
+            baseTimestampNs = lastUploadTimestampNs + 1;
+        }
+        lastUploadTimestampNs = baseTimestampNs;
+    }
+    
+    JournalRecord rec = describeRun(run, cfg, haveTime ? baseTimestampNs : 0);
+    
+    // Keep the run for later instead of dropping it
+    if (!online || !haveTime) {
+        Serial.println(!online ? "[Main] WiFi not connected, journaling run"
+                               : "[Main] Time unavailable, journaling run");
+        journalRun(rec);
+        webServer.updateStatus(run.triggerMillis, currentSampleCount, false);
+        return;
+    }
+    
+    Serial.println("[Main] Uploading data to InfluxDB...");
+    unsigned long startTime = millis();
+    
+    // All writes of this run share one keep-alive connection (a no-op
+    // if the connection was already opened at capture start)
+    influxClient.beginSession();
+    tagSensor(run.sensor);
+    
+    makeRunId(runId, sizeof(runId), baseTimestampNs);
+    strlcpy(rec.runId, runId, sizeof(rec.runId));
+    Serial.printf("[Main] Run ID: %s\n", runId);
+    
+    String deviceId = configManager.getDeviceId();
+    bool success = uploadSummary(rec, runId);
     
     // Optionally upload time domain data
-    if (cfg.send_time_domain) {
+    if (success && cfg.send_time_domain && rawCaptureMode) {
+        // Raw mode uploads the unfiltered capture, scaled on the fly
+        success &= influxClient.writeTimeData(
+            cfg.operation_id, deviceId.c_str(), runId,
+            reinterpret_cast<const int16_t*>(rawBuffer), run.scale,
+            currentSampleCount, baseTimestampNs,
+            runTiming.odrHz
+        );
+    } else if (success && cfg.send_time_domain) {
         success &= influxClient.writeTimeData(
             cfg.operation_id, deviceId.c_str(), runId,
             bufferX, bufferY, bufferZ,
             currentSampleCount, baseTimestampNs,
-            cfg.sample_rate_hz
+            runTiming.odrHz
         );
     }
     
     unsigned long uploadTime = millis() - startTime;
+    metrics.record(METRIC_UPLOAD_MS, uploadTime);
+    metrics.record(METRIC_UPLOAD_BYTES, influxClient.sessionWireBytes());
     
     if (success) {
         Serial.printf("[Main] Upload complete in %d ms\n", uploadTime);
     } else {
-        Serial.println("[Main] Upload failed!");
+        Serial.println("[Main] Upload failed, journaling run");
+        journalRun(rec);
     }
     
     // Update web server status
-    webServer.updateStatus(lastTriggerTime, currentSampleCount, success);
+    webServer.updateStatus(run.triggerMillis, currentSampleCount, success);
+}
+
+// ============================================================================
+// Journal Replay
+// ============================================================================
+// Upload the oldest journaled run; true if one was replayed
+static bool drainJournal() {
+    if (runJournal.count() == 0 || !configManager.isInfluxConfigured() ||
+        !wifiManager.isConnected() || !wifiManager.hasValidTime()) {
+        return false;
+    }
+    
+    JournalRecord rec;
+    if (!runJournal.openOldest(rec)) {
+        return false;
+    }
+    
+    // Runs captured without a clock are dated from esp_timer, which only
+    // works within the same boot
+    if (rec.epochNs == 0) {
+        if (rec.bootId != runJournal.bootId() || !epochAtTimerUs(rec.startUs, rec.epochNs)) {
+            Serial.printf("[Main] Journaled run %lu cannot be dated, dropping\n",
+                          (unsigned long)rec.sequence);
+            runJournal.closeRecord(true);
+            return true;
+        }
+    }
+    
+    if (!runJournal.readSpectra(fftX, fftY, fftZ, spectrumCapacity)) {
+        Serial.println("[Main] Journaled run does not fit current buffers, dropping");
+        runJournal.closeRecord(true);
+        return true;
+    }
+    fillFreqBins(rec.numBins, rec.fftSize, rec.odrHz, rec.zoomFactor, rec.zoomCenterHz);
+    
+    char id[sizeof(rec.runId)];
+    if (rec.runId[0] != '\0') {
+        strlcpy(id, rec.runId, sizeof(id));
+    } else {
+        makeRunId(id, sizeof(id), rec.epochNs);
+    }
+    
+    Serial.printf("[Main] Replaying journaled run %s (%d pending)\n", id, runJournal.count());
+    influxClient.beginSession();
+    tagSensor(rec.sensor);
+    
+    bool success = uploadSummary(rec, id);
+    
+    // Time data in batch-sized blocks, timestamps as in the live upload
+    String deviceId = configManager.getDeviceId();
+    double sampleIntervalNs = 1000000000.0 / rec.odrHz;
+    size_t offset = 0;
+    size_t n;
+    while (success && (n = runJournal.readTime(journalFrames, INFLUX_WRITE_BATCH_SIZE)) > 0) {
+        success &= influxClient.writeTimeData(
+            rec.operationId, deviceId.c_str(), id,
+            journalFrames, rec.scale, n,
+            rec.epochNs + (uint64_t)(offset * sampleIntervalNs), rec.odrHz
+        );
+        offset += n;
+    }
+    
+    influxClient.endSession();
+    runJournal.closeRecord(success);
+    
+    Serial.printf("[Main] Journal replay %s\n", success ? "complete" : "failed, will retry");
+    return success;
+}
+
+// ============================================================================
+// Monitoring Heartbeat
+// ============================================================================
+// Upload the latest continuous-monitoring summary; dropped when offline
+static void uploadHeartbeat() {
+    MonitorSummary summary;
+    if (!acquisition.takeHeartbeat(summary)) {
+        return;
+    }
+    
+    uint64_t timestampNs;
+    if (!configManager.isInfluxConfigured() || !wifiManager.isConnected() ||
+        !getCurrentEpochTimestampNs(timestampNs)) {
+        return;
+    }
+    
+    DeviceConfig& cfg = configManager.getConfig();
+    // The detector runs on sensor 0
+    String deviceId = configManager.getDeviceId();
+    tagSensor(0);
+    influxClient.writeHeartbeat(cfg.operation_id, deviceId.c_str(), summary, timestampNs);
+    influxClient.endSession();
+}
+
+// ============================================================================
+// Device Health
+// ============================================================================
+// Upload the metrics window every health_s; kept accumulating while offline
+static void uploadHealth() {
+    static uint32_t lastHealthMs = 0;
+    DeviceConfig& cfg = configManager.getConfig();
+    if (cfg.health_s == 0 || millis() - lastHealthMs < cfg.health_s * 1000UL) {
+        return;
+    }
+    
+    uint64_t timestampNs;
+    if (!configManager.isInfluxConfigured() || !wifiManager.isConnected() ||
+        !getCurrentEpochTimestampNs(timestampNs)) {
+        return;
+    }
+    
+    MetricsSnapshot snap;
+    metrics.snapshot(snap);
+    String deviceId = configManager.getDeviceId();
+    bool ok = influxClient.writeDeviceHealth(cfg.operation_id, deviceId.c_str(), snap,
+                                             wifiManager.getRSSI(), runJournal.count(),
+                                             timestampNs);
+    influxClient.endSession();
+    
+    // A failed write is retried at the next interval with the same window
+    lastHealthMs = millis();
+    if (ok) {
+        metrics.resetWindow();
+    }
+}
+
+// ============================================================================
+// Processing Task
+// ============================================================================
+static void processingTask(void* arg) {
+    RunInfo run;
+    bool replaying = false;
+    for (;;) {
+        // While idle, replay journaled runs: back to back while uploads
+        // succeed, otherwise every JOURNAL_DRAIN_INTERVAL_MS
+        uint32_t timeoutMs = replaying ? 0 : JOURNAL_DRAIN_INTERVAL_MS;
+        if (!acquisition.waitForRun(run, timeoutMs)) {
+            uploadHeartbeat();
+            uploadHealth();
+            replaying = drainJournal();
+            continue;
+        }
+        
+        // Complete measurement cycle; the next capture can already be
+        // running on the other core while this one uploads.
+        size_t heapAtStart = heapFreeNow();
+        
+#if INFLUX_PREWARM
+        // Connect to InfluxDB while the capture is still running
+        if (configManager.isInfluxConfigured() && wifiManager.isConnected()) {
+            influxClient.beginSession();
+        }
+#endif
+        
+        // Downloads of the previous run get a moment to finish
+        latestRun.beginWrite(RUN_DOWNLOAD_WAIT_MS);
+        ingestRun(run);
+        processData(run);
+        publishRun(run);
+        
+        // Live view first; the upload can take seconds
+        const float* spectra[3] = { fftX, fftY, fftZ };
+        webServer.publishRun(run, runFeatures, spectra, freqBins, spectrumBins, runTiming.odrHz);
+        metrics.count(METRIC_RUNS);
+        metrics.sampleHeap();
+        logHeapReport("after DSP", heapAtStart);
+        uploadData(run);
+        influxClient.endSession();
+        uploadHeartbeat();
+        uploadHealth();
+        logHeapReport("after upload", heapAtStart);
+        
+        Serial.println("\n[Main] Measurement cycle complete, waiting for next trigger...\n");
+    }
 }
 
 // ============================================================================
@@ -341,17 +971,31 @@ void manualTriggerCallback() {
     portENTER_CRITICAL(&triggerMux);
     triggerPending = true;
     lastTriggerTime = millis();
+    acquisition.markTrigger();
     portEXIT_CRITICAL(&triggerMux);
     
+    acquisition.wake();
     Serial.println("[Main] Manual trigger requested");
 }
 
+// ============================================================================
+// Config Save Callback
+// ============================================================================
+void configSavedCallback() {
+    // Window tables and filter designs depend on the config
+    dsp.invalidateCaches();
+}
+
 // ============================================================================
 // Setup
 // ============================================================================
 void setup() {
+    // Triggers are armed before anything that waits on flash or the
+    // network. Until the processing task starts (after the journal mount)
+    // only ACQ_QUEUED_RUNS runs per sensor can queue up in the acquisition
+    // task; later ones are processed and journaled until WiFi and the
+    // clock are available.
     Serial.begin(115200);
-    delay(1000);
     
     Serial.println("\n\n");
     Serial.println("==============================================");
@@ -366,6 +1010,47 @@ void setup() {
     }
     
     DeviceConfig& cfg = configManager.getConfig();
+    configManager.setSaveCallback(configSavedCallback);
+    metrics.markBoot(BOOT_CONFIG);
+    
+    // Initialize ADXL313 sensors; all share the SPI bus and the settings
+    Serial.println("[Main] Initializing ADXL313...");
+    ADXL313* sensors[MAX_SENSORS];
+    size_t sensorCount = 0;
+    uint8_t wanted = constrain(cfg.sensor_count, 1, SPI_MAX_SENSORS);
+    for (uint8_t s = 0; s < wanted; s++) {
+        ADXL313* sensor = s == 0 ? &adxl313 : &auxSensors[s - 1];
+        uint8_t csPin = s == 0 ? cfg.spi_cs_pin : cfg.aux_cs_pins[s - 1];
+        if (!sensor->begin(csPin)) {
+            Serial.printf("[Main] ADXL313 %d (CS %d) init failed! Check wiring.\n", s, csPin);
+            // Indices are the sensor_id tags: stop rather than renumber the
+            // sensors behind a missing one. Sensor 0 is kept regardless.
+            if (s > 0) break;
+        } else {
+            sensor->setSensitivity(cfg.sensitivity);
+            sensor->setDataRate(ADXL313::rateCodeForHz(cfg.sample_rate_hz));
+        }
+        sensors[sensorCount++] = sensor;
+    }
+    
+    // Allocate sampling buffers
+    Serial.println("[Main] Allocating buffers...");
+    if (!allocateBuffers(cfg.sample_count, cfg.raw_capture)) {
+        Serial.println("[Main] Buffer allocation failed!");
+    }
+    
+    // Start acquisition (core 1), then accept triggers
+    Serial.println("[Main] Starting acquisition task...");
+    acquisition.setTriggerSource(takeTrigger);
+    if (!acquisition.begin(currentSampleCount, sensors, sensorCount)) {
+        Serial.println("[Main] Acquisition start failed!");
+    }
+    
+    // Configure PLC trigger input
+    Serial.printf("[Main] Configuring PLC trigger on GPIO %d...\n", cfg.plc_trigger_pin);
+    pinMode(cfg.plc_trigger_pin, INPUT_PULLDOWN);
+    attachInterrupt(digitalPinToInterrupt(cfg.plc_trigger_pin), plcTriggerISR, RISING);
+    metrics.markBoot(BOOT_ARMED);
     
     // Initialize DSP
     Serial.println("[Main] Initializing DSP...");
@@ -373,26 +1058,35 @@ void setup() {
         Serial.println("[Main] DSP init failed!");
     }
     
-    // Initialize ADXL313
-    Serial.println("[Main] Initializing ADXL313...");
-    if (!adxl313.begin(cfg.spi_cs_pin)) {
-        Serial.println("[Main] ADXL313 init failed! Check wiring.");
-    } else {
-        adxl313.setSensitivity(cfg.sensitivity);
+    // Failed uploads are kept on flash until the next successful one.
+    // Mounts LittleFS, which takes seconds if it has to be formatted.
+    Serial.println("[Main] Opening run journal...");
+    if (!runJournal.begin()) {
+        Serial.println("[Main] Run journal unavailable, failed uploads will be dropped");
     }
-    
-    // Allocate sampling buffers
-    Serial.println("[Main] Allocating buffers...");
-    if (!allocateBuffers(cfg.sample_count)) {
-        Serial.println("[Main] Buffer allocation failed!");
+    if (cfg.baseline_alpha_pct > 0 && !spectralBaseline.begin()) {
+        Serial.println("[Main] Spectral baseline unavailable, runs are not compared");
     }
     
     // Initialize InfluxDB client
     Serial.println("[Main] Configuring InfluxDB client...");
     influxClient.begin(cfg.influx_url, cfg.influx_token, 
                        cfg.influx_org, cfg.influx_bucket);
+    influxClient.setCompression(cfg.influx_gzip);
+    
+    // Processing (core 0) as soon as the journal is there, so the queued
+    // runs are drained while the network comes up; the live view is
+    // skipped until the web server has started
+    Serial.println("[Main] Starting processing task...");
+    TaskHandle_t procTask = nullptr;
+    xTaskCreatePinnedToCore(processingTask, "proc", PROC_TASK_STACK, nullptr,
+                            PROC_TASK_PRIORITY, &procTask, PROC_TASK_CORE);
+    metrics.watchTask("acq", acquisition.taskHandle());
+    metrics.watchTask("proc", procTask);
+    metrics.watchTask("loop", xTaskGetCurrentTaskHandle());
+    metrics.markBoot(BOOT_STORAGE);
     
-    // Initialize WiFi
+    // Start WiFi; the connection, AP fallback and SNTP continue in loop()
     Serial.println("[Main] Initializing WiFi...");
     wifiManager.begin();
     
@@ -400,11 +1094,11 @@ void setup() {
     Serial.println("[Main] Starting web server...");
     webServer.begin();
     webServer.setTriggerCallback(manualTriggerCallback);
+    metrics.markBoot(BOOT_NETWORK);
+    metrics.markBoot(BOOT_READY);
     
-    // Configure PLC trigger input
-    Serial.printf("[Main] Configuring PLC trigger on GPIO %d...\n", cfg.plc_trigger_pin);
-    pinMode(cfg.plc_trigger_pin, INPUT_PULLDOWN);
-    attachInterrupt(digitalPinToInterrupt(cfg.plc_trigger_pin), plcTriggerISR, RISING);
+    logHeapReport("boot");
+    logBootPhases();
     
     Serial.println("\n[Main] System ready!");
     Serial.printf("[Main] Device ID: %s\n", configManager.getDeviceId().c_str());
@@ -417,25 +1111,15 @@ void setup() {
 // Main Loop
 // ============================================================================
 void loop() {
-    // Process WiFi events
+    // Process WiFi events; capture and processing run in their own tasks
     wifiManager.loop();
+    webServer.loop();
     
-    // Check for trigger
-    bool shouldProcess = false;
-    portENTER_CRITICAL(&triggerMux);
-    if (triggerPending) {
-        triggerPending = false;
-        shouldProcess = true;
-    }
-    portEXIT_CRITICAL(&triggerMux);
-    
-    if (shouldProcess) {
-        // Perform complete measurement cycle
-        performSampling();
-        processData();
-        uploadData();
-        
-        Serial.println("\n[Main] Measurement cycle complete, waiting for next trigger...\n");
+    // The asynchronous milestones complete the boot report
+    static bool bootReported = false;
+    if (!bootReported && (metrics.bootMs(BOOT_TIME) > 0 || wifiManager.isAPMode())) {
+        logBootPhases();
+        bootReported = true;
     }
     
     // Small delay to prevent watchdog issues
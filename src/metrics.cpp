@@ -0,0 +1,157 @@
+#include "metrics.h"
+#include <esp_heap_caps.h>
+
+// Global instance
+Metrics metrics;
+
+static const char* const HISTOGRAM_NAMES[METRIC_HISTOGRAMS] = {
+    "trigger_latency_us", "capture_ratio_pm", "dsp_axis_us", "upload_ms", "upload_bytes"
+};
+
+static const char* const COUNTER_NAMES[METRIC_COUNTERS] = {
+    "runs", "dropped_triggers", "zero_filled_frames", "fifo_overruns",
+    "upload_retries", "upload_failures"
+};
+
+static const char* const BOOT_PHASE_NAMES[BOOT_PHASES] = {
+    "config", "armed", "storage", "network", "ready", "wifi", "time"
+};
+
+const char* Metrics::histogramName(uint8_t metric) {
+    return metric < METRIC_HISTOGRAMS ? HISTOGRAM_NAMES[metric] : "unknown";
+}
+
+const char* Metrics::counterName(uint8_t counter) {
+    return counter < METRIC_COUNTERS ? COUNTER_NAMES[counter] : "unknown";
+}
+
+const char* Metrics::bootPhaseName(uint8_t phase) {
+    return phase < BOOT_PHASES ? BOOT_PHASE_NAMES[phase] : "unknown";
+}
+
+uint8_t Metrics::_bucket(uint32_t value) {
+    // 0..3 exact, then four buckets per power of two
+    if (value < 4) return (uint8_t)value;
+    uint32_t octave = 31 - __builtin_clz(value);
+    uint32_t bucket = 4 * (octave - 1) + ((value >> (octave - 2)) & 3);
+    return bucket < METRICS_BUCKETS ? (uint8_t)bucket : METRICS_BUCKETS - 1;
+}
+
+uint32_t Metrics::_bucketTop(uint8_t bucket) {
+    if (bucket < 4) return bucket;
+    uint32_t octave = bucket / 4 + 1;
+    uint32_t sub = bucket % 4;
+    return ((4 + sub + 1) << (octave - 2)) - 1;
+}
+
+uint32_t Metrics::_percentile(const Histogram& h, uint32_t permille) {
+    if (h.count == 0) return 0;
+    uint64_t target = ((uint64_t)h.count * permille + 999) / 1000;
+    if (target == 0) target = 1;
+
+    uint64_t seen = 0;
+    for (uint8_t b = 0; b < METRICS_BUCKETS; b++) {
+        seen += h.buckets[b];
+        if (seen >= target) {
+            uint32_t top = _bucketTop(b);
+            if (top > h.max) top = h.max;
+            if (top < h.min) top = h.min;
+            return top;
+        }
+    }
+    return h.max;
+}
+
+void Metrics::record(MetricHistogram metric, uint32_t value) {
+    if (metric >= METRIC_HISTOGRAMS) return;
+    uint8_t bucket = _bucket(value);
+
+    portENTER_CRITICAL(&_mux);
+    Histogram& h = _hist[metric];
+    if (h.count == 0 || value < h.min) h.min = value;
+    if (value > h.max) h.max = value;
+    h.count++;
+    h.sum += value;
+    h.buckets[bucket]++;
+    portEXIT_CRITICAL(&_mux);
+}
+
+void Metrics::count(MetricCounter counter, uint32_t n) {
+    if (counter >= METRIC_COUNTERS) return;
+    portENTER_CRITICAL(&_mux);
+    _counters[counter] += n;
+    portEXIT_CRITICAL(&_mux);
+}
+
+void Metrics::watchTask(const char* name, TaskHandle_t task) {
+    if (!task) return;
+    portENTER_CRITICAL(&_mux);
+    if (_taskCount < METRICS_MAX_TASKS) {
+        _taskName[_taskCount] = name;
+        _tasks[_taskCount] = task;
+        _taskCount++;
+    }
+    portEXIT_CRITICAL(&_mux);
+}
+
+void Metrics::markBoot(BootPhase phase) {
+    if (phase >= BOOT_PHASES) return;
+    // At least 1, so a milestone in the first millisecond still reads as reached
+    uint32_t now = millis();
+    if (now == 0) now = 1;
+    portENTER_CRITICAL(&_mux);
+    if (_bootMs[phase] == 0) _bootMs[phase] = now;
+    portEXIT_CRITICAL(&_mux);
+}
+
+uint32_t Metrics::bootMs(BootPhase phase) const {
+    return phase < BOOT_PHASES ? _bootMs[phase] : 0;
+}
+
+void Metrics::sampleHeap() {
+    uint32_t largest = heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+    portENTER_CRITICAL(&_mux);
+    if (_heapLargestMin == 0 || largest < _heapLargestMin) _heapLargestMin = largest;
+    portEXIT_CRITICAL(&_mux);
+}
+
+void Metrics::snapshot(MetricsSnapshot& out) {
+    sampleHeap();
+    memset(&out, 0, sizeof(out));
+    out.heapFree = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+    out.heapMinFree = heap_caps_get_minimum_free_size(MALLOC_CAP_8BIT);
+    out.heapLargest = heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+
+    // Stack marks are read outside the lock; tasks are only ever added
+    uint8_t tasks = _taskCount;
+    for (uint8_t i = 0; i < tasks; i++) {
+        out.taskName[i] = _taskName[i];
+        out.stackFree[i] = uxTaskGetStackHighWaterMark(_tasks[i]);   // Bytes on ESP-IDF
+    }
+    out.taskCount = tasks;
+
+    portENTER_CRITICAL(&_mux);
+    out.windowMs = millis() - _windowStartMs;
+    out.heapLargestMin = _heapLargestMin;
+    memcpy(out.counters, _counters, sizeof(out.counters));
+    memcpy(out.bootMs, _bootMs, sizeof(out.bootMs));
+    for (uint8_t m = 0; m < METRIC_HISTOGRAMS; m++) {
+        const Histogram& h = _hist[m];
+        HistogramSummary& s = out.hist[m];
+        s.count = h.count;
+        s.min = h.min;
+        s.max = h.max;
+        s.mean = h.count > 0 ? (uint32_t)(h.sum / h.count) : 0;
+        s.p50 = _percentile(h, 500);
+        s.p90 = _percentile(h, 900);
+        s.p99 = _percentile(h, 990);
+    }
+    portEXIT_CRITICAL(&_mux);
+}
+
+void Metrics::resetWindow() {
+    portENTER_CRITICAL(&_mux);
+    memset(_hist, 0, sizeof(_hist));
+    _windowStartMs = millis();
+    portEXIT_CRITICAL(&_mux);
+}
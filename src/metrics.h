@@ -0,0 +1,185 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <Arduino.h>
+#include "config.h"
+
+/**
+ * @brief Distributions recorded per run
+ */
+enum MetricHistogram : uint8_t {
+    METRIC_TRIGGER_LATENCY_US = 0,  // Trigger edge to capture start
+    METRIC_CAPTURE_RATIO_PM,        // Capture duration, per mille of nominal
+    METRIC_DSP_AXIS_US,             // Filter, features and FFT of one axis
+    METRIC_UPLOAD_MS,               // Live upload of one run
+    METRIC_UPLOAD_BYTES,            // Body bytes sent for one run (after gzip)
+    METRIC_HISTOGRAMS
+};
+
+/**
+ * @brief Event counters, cumulative since boot
+ */
+enum MetricCounter : uint8_t {
+    METRIC_RUNS = 0,                // Runs processed
+    METRIC_DROPPED_TRIGGERS,        // Triggers rejected while the ring was busy
+    METRIC_ZERO_FILLED_FRAMES,      // Frames replaced by zeros after a sensor stall
+    METRIC_FIFO_OVERRUNS,           // Sensor FIFO full events
+    METRIC_UPLOAD_RETRIES,          // Write requests repeated after a failure
+    METRIC_UPLOAD_FAILURES,         // Write requests dropped after all retries
+    METRIC_COUNTERS
+};
+
+/**
+ * @brief Startup milestones, in the order they are normally reached
+ *
+ * Everything up to BOOT_READY happens in setup(); the WiFi and time
+ * milestones follow asynchronously while runs are already captured.
+ */
+enum BootPhase : uint8_t {
+    BOOT_CONFIG = 0,                // Configuration loaded
+    BOOT_ARMED,                     // Sensors, buffers and trigger input live
+    BOOT_STORAGE,                   // Journal and baseline ready, processing task running
+    BOOT_NETWORK,                   // WiFi connection started, web server up
+    BOOT_READY,                     // setup() done
+    BOOT_WIFI,                      // First station connection
+    BOOT_TIME,                      // First valid clock (SNTP)
+    BOOT_PHASES
+};
+
+/**
+ * @brief Statistics of one histogram
+ *
+ * Percentiles are the upper edge of the bucket they fall in, so they
+ * overstate by at most a quarter octave (about 19 %).
+ */
+struct HistogramSummary {
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint32_t mean;
+    uint32_t p50;
+    uint32_t p90;
+    uint32_t p99;
+};
+
+/**
+ * @brief Point-in-time copy of all metrics
+ */
+struct MetricsSnapshot {
+    uint32_t windowMs;                          // Time the histograms cover
+    HistogramSummary hist[METRIC_HISTOGRAMS];
+    uint32_t counters[METRIC_COUNTERS];
+    uint32_t heapFree;                          // Bytes, 8-bit capable heap
+    uint32_t heapMinFree;                       // Lowest free heap since boot
+    uint32_t heapLargest;                       // Largest free block now
+    uint32_t heapLargestMin;                    // Smallest largest block seen
+    uint8_t taskCount;
+    const char* taskName[METRICS_MAX_TASKS];
+    uint32_t stackFree[METRICS_MAX_TASKS];      // Bytes never used (high-water mark)
+    uint32_t bootMs[BOOT_PHASES];               // Milliseconds since start, 0 if not reached
+};
+
+/**
+ * @brief Runtime metrics shared by the acquisition, processing and web tasks
+ *
+ * Histograms use log2 buckets split into four sub-buckets, so recording
+ * is a few instructions and memory stays fixed. They cover a window that
+ * restarts whenever a devicehealth point has been uploaded (since boot
+ * if that is off); counters and heap low marks cover the whole boot.
+ * All methods are safe to call from any task.
+ */
+class Metrics {
+public:
+    /**
+     * @brief Add one value to a histogram
+     */
+    void record(MetricHistogram metric, uint32_t value);
+
+    /**
+     * @brief Increment a counter
+     */
+    void count(MetricCounter counter, uint32_t n = 1);
+
+    /**
+     * @brief Track the stack high-water mark of a task
+     * @param name Static name used in reports
+     * @param task Task handle
+     */
+    void watchTask(const char* name, TaskHandle_t task);
+
+    /**
+     * @brief Sample the largest free heap block
+     *
+     * Called at points of peak allocation; the smallest value seen is
+     * reported as heapLargestMin.
+     */
+    void sampleHeap();
+
+    /**
+     * @brief Record the time a startup milestone was reached
+     *
+     * Only the first call per phase counts, so reconnects do not move it.
+     */
+    void markBoot(BootPhase phase);
+
+    /**
+     * @brief Time a startup milestone was reached
+     * @return Milliseconds since start, 0 if not reached yet
+     */
+    uint32_t bootMs(BootPhase phase) const;
+
+    /**
+     * @brief Copy the current metrics
+     */
+    void snapshot(MetricsSnapshot& out);
+
+    /**
+     * @brief Clear the histograms and start a new window
+     */
+    void resetWindow();
+
+    /**
+     * @brief Report name of a histogram
+     */
+    static const char* histogramName(uint8_t metric);
+
+    /**
+     * @brief Report name of a counter
+     */
+    static const char* counterName(uint8_t counter);
+
+    /**
+     * @brief Report name of a startup milestone
+     */
+    static const char* bootPhaseName(uint8_t phase);
+
+private:
+    struct Histogram {
+        uint32_t count;
+        uint64_t sum;
+        uint32_t min;
+        uint32_t max;
+        uint32_t buckets[METRICS_BUCKETS];
+    };
+
+    Histogram _hist[METRIC_HISTOGRAMS] = {};
+    uint32_t _counters[METRIC_COUNTERS] = {};
+    uint32_t _windowStartMs = 0;
+    uint32_t _heapLargestMin = 0;
+    uint32_t _bootMs[BOOT_PHASES] = {};
+
+    const char* _taskName[METRICS_MAX_TASKS] = {};
+    TaskHandle_t _tasks[METRICS_MAX_TASKS] = {};
+    uint8_t _taskCount = 0;
+
+    portMUX_TYPE _mux = portMUX_INITIALIZER_UNLOCKED;
+
+    static uint8_t _bucket(uint32_t value);
+    static uint32_t _bucketTop(uint8_t bucket);
+    static uint32_t _percentile(const Histogram& h, uint32_t permille);
+};
+
+// Global instance
+extern Metrics metrics;
+
+#endif // METRICS_H
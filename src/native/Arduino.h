@@ -0,0 +1,48 @@
+#ifndef NATIVE_ARDUINO_H
+#define NATIVE_ARDUINO_H
+
+/**
+ * @brief Host stand-in for the parts of the Arduino core the DSP and
+ *        encoder sources use (native environment only)
+ *
+ * Serial goes to stderr, keeping stdout for program output;
+ * millis()/micros() count from program start.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+
+#define IRAM_ATTR
+#define PI      3.1415926535897932384626433832795
+#define TWO_PI  6.283185307179586476925286766559
+
+using std::min;
+using std::max;
+
+template <typename T, typename L, typename H>
+static inline T constrain(T x, L lo, H hi) {
+    return x < lo ? lo : (x > hi ? hi : x);
+}
+
+unsigned long millis();
+unsigned long micros();
+void delay(uint32_t ms);
+
+class HardwareSerial {
+public:
+    void begin(unsigned long) {}
+    // No format attribute: the sources print size_t with %d, which is
+    // exact on the 32-bit target and reads the low word on 64-bit hosts
+    int printf(const char* fmt, ...);
+    size_t print(const char* s) { return fputs(s, stderr) >= 0 ? strlen(s) : 0; }
+    size_t println(const char* s = "") { return print(s) + print("\n"); }
+};
+
+extern HardwareSerial Serial;
+
+#endif // NATIVE_ARDUINO_H
@@ -0,0 +1,380 @@
+/**
+ * ESP32 Vibration Monitoring System - Host micro-benchmarks
+ *
+ * Entry point of the native environment. A small harness in the style of
+ * Google Benchmark: each benchmark is a function taking a State, looping
+ * on state.keepRunning(), registered with BENCHMARK() and an optional
+ * size range. Iterations are raised until a run takes --min_time seconds.
+ *
+ *   program [--filter=<substring>] [--min_time=<s>] [--format=json]
+ *
+ * The DSP runs on the reference ESP-DSP shims, so absolute numbers are
+ * for comparing revisions of dsp.cpp and the encoders on one host, and
+ * the binary is a convenient target for perf, valgrind and sanitizers.
+ */
+
+#include <Arduino.h>
+#include "dsp.h"
+#include "line_protocol.h"
+#include "gzip_stream.h"
+#include <time.h>
+#include <string>
+#include <vector>
+
+// ============================================================================
+// Harness
+// ============================================================================
+class State {
+public:
+    State(int64_t arg, int64_t iterations) : _arg(arg), _left(iterations), _iterations(iterations) {}
+
+    // Argument of this run (the size from the range)
+    int64_t range() const { return _arg; }
+
+    // True while iterations remain; the timer covers the loop only
+    bool keepRunning() {
+        if (!_started) {
+            _started = true;
+            _wallStart = _now(CLOCK_MONOTONIC);
+            _cpuStart = _now(CLOCK_PROCESS_CPUTIME_ID);
+        }
+        if (_left-- > 0) return true;
+        _wallNs = _now(CLOCK_MONOTONIC) - _wallStart;
+        _cpuNs = _now(CLOCK_PROCESS_CPUTIME_ID) - _cpuStart;
+        return false;
+    }
+
+    void setItemsProcessed(int64_t items) { _items = items; }
+    void setBytesProcessed(int64_t bytes) { _bytes = bytes; }
+
+    int64_t iterations() const { return _iterations; }
+    double wallNs() const { return _wallNs; }
+    double cpuNs() const { return _cpuNs; }
+    int64_t items() const { return _items; }
+    int64_t bytes() const { return _bytes; }
+
+private:
+    int64_t _arg;
+    int64_t _left;
+    int64_t _iterations;
+    bool _started = false;
+    double _wallStart = 0, _cpuStart = 0;
+    double _wallNs = 0, _cpuNs = 0;
+    int64_t _items = 0;
+    int64_t _bytes = 0;
+
+    static double _now(clockid_t clock) {
+        timespec ts;
+        clock_gettime(clock, &ts);
+        return ts.tv_sec * 1e9 + ts.tv_nsec;
+    }
+};
+
+// Keeps the compiler from dropping a result
+template <typename T>
+static inline void doNotOptimize(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+struct Benchmark {
+    const char* name;
+    void (*fn)(State&);
+    std::vector<int64_t> args;
+
+    // Powers of two from lo to hi
+    Benchmark* range(int64_t lo, int64_t hi) {
+        for (int64_t n = lo; n <= hi; n *= 2) args.push_back(n);
+        return this;
+    }
+    Benchmark* arg(int64_t n) {
+        args.push_back(n);
+        return this;
+    }
+};
+
+static std::vector<Benchmark*>& registry() {
+    static std::vector<Benchmark*> benchmarks;
+    return benchmarks;
+}
+
+static Benchmark* registerBenchmark(const char* name, void (*fn)(State&)) {
+    Benchmark* b = new Benchmark{ name, fn, {} };
+    registry().push_back(b);
+    return b;
+}
+
+#define BENCH_CONCAT2(a, b) a##b
+#define BENCH_CONCAT(a, b) BENCH_CONCAT2(a, b)
+#define BENCHMARK(fn) \
+    static Benchmark* BENCH_CONCAT(bench_, __LINE__) = registerBenchmark(#fn, fn)
+
+// ============================================================================
+// Test data
+// ============================================================================
+static constexpr float SAMPLE_RATE_HZ = 3200.0f;
+static constexpr size_t MAX_SIZE = 8192;
+
+static std::vector<float> signal_;
+static std::vector<int16_t> raw;        // Interleaved X/Y/Z counts
+static std::vector<float> work;
+static std::vector<float> spectrum[3];
+static std::vector<float> freqs;
+
+// 80 Hz and 733 Hz tones plus white noise, in g (as on the device)
+static void makeData() {
+    srand(1);
+    signal_.resize(MAX_SIZE);
+    raw.resize(MAX_SIZE * 3);
+    work.resize(MAX_SIZE);
+    for (size_t i = 0; i < MAX_SIZE; i++) {
+        float t = i / SAMPLE_RATE_HZ;
+        float noise = ((rand() % 2001) - 1000) / 1000.0f * 0.01f;
+        signal_[i] = 0.1f * sinf(2.0f * (float)M_PI * 80.0f * t) +
+                     0.03f * sinf(2.0f * (float)M_PI * 733.0f * t) + noise;
+        for (int a = 0; a < 3; a++) {
+            raw[i * 3 + a] = (int16_t)(signal_[i] / 0.0039f);
+        }
+    }
+
+    size_t numBins = MAX_SIZE / 2 + 1;
+    freqs.resize(numBins);
+    for (int a = 0; a < 3; a++) {
+        spectrum[a].resize(numBins);
+        dsp.computeFFT(signal_.data(), spectrum[a].data(), MAX_SIZE);
+    }
+    for (size_t i = 0; i < numBins; i++) {
+        freqs[i] = DSP::binToFrequency(i, MAX_SIZE, SAMPLE_RATE_HZ);
+    }
+}
+
+// ============================================================================
+// DSP
+// ============================================================================
+static void BM_FiltFilt(State& state) {
+    size_t n = state.range();
+    dsp.designButterworth(1000.0f, SAMPLE_RATE_HZ, 4);
+    while (state.keepRunning()) {
+        memcpy(work.data(), signal_.data(), n * sizeof(float));
+        dsp.applyFiltFilt(work.data(), n);
+        doNotOptimize(work[n - 1]);
+    }
+    state.setItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_FiltFilt)->range(512, 8192);
+
+static void BM_FiltFiltRaw(State& state) {
+    size_t n = state.range();
+    dsp.designButterworth(1000.0f, SAMPLE_RATE_HZ, 4);
+    while (state.keepRunning()) {
+        dsp.applyFiltFilt(raw.data(), 3, 0.0039f, work.data(), n);
+        doNotOptimize(work[n - 1]);
+    }
+    state.setItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_FiltFiltRaw)->range(512, 8192);
+
+static void BM_ComputeFFT(State& state) {
+    size_t n = state.range();
+    while (state.keepRunning()) {
+        dsp.computeFFT(signal_.data(), spectrum[0].data(), n);
+        doNotOptimize(spectrum[0][1]);
+    }
+    state.setItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_ComputeFFT)->range(512, 8192);
+
+static void BM_ZoomFFT(State& state) {
+    size_t factor = state.range();
+    while (state.keepRunning()) {
+        dsp.computeZoomFFT(signal_.data(), work.data(), MAX_SIZE, SAMPLE_RATE_HZ, SAMPLE_RATE_HZ,
+                           733.0f, factor);
+        doNotOptimize(work[0]);
+    }
+    state.setItemsProcessed(state.iterations() * MAX_SIZE);
+}
+BENCHMARK(BM_ZoomFFT)->arg(8)->arg(64);
+
+// ============================================================================
+// Encoders
+// ============================================================================
+static LineProtocolEncoder encoder;
+static GzipStream gzip;
+
+static bool countSink(void* ctx, const char*, size_t len) {
+    *(size_t*)ctx += len;
+    return true;
+}
+
+static bool gzipOutSink(void* ctx, const uint8_t*, size_t len) {
+    *(size_t*)ctx += len;
+    return true;
+}
+
+static bool gzipInSink(void*, const char* data, size_t len) {
+    return gzip.write((const uint8_t*)data, len);
+}
+
+// accelfreq lines as InfluxDBClient::writeFrequencyData() encodes them
+static void encodeSpectrum(size_t numBins) {
+    encoder.setMeasurement("accelfreq");
+    encoder.addTag("operation", "BENCH");
+    encoder.addTag("device_id", "BENCH");
+    encoder.addTag("run_id", "BENCH-1739356800-1");
+    for (size_t i = 1; i < numBins; i++) {
+        encoder.beginLine();
+        encoder.field("frequencies", freqs[i]);
+        encoder.field("x_freq", spectrum[0][i]);
+        encoder.field("y_freq", spectrum[1][i]);
+        encoder.field("z_freq", spectrum[2][i]);
+        encoder.endLine(1739356800000000000ULL + i * 1000000ULL);
+    }
+    encoder.flush();
+}
+
+static void BM_EncodeFreqLines(State& state) {
+    size_t numBins = state.range() / 2 + 1;
+    size_t bytes = 0;
+    while (state.keepRunning()) {
+        encoder.begin(countSink, &bytes);
+        encodeSpectrum(numBins);
+    }
+    state.setItemsProcessed(state.iterations() * (numBins - 1));
+    state.setBytesProcessed(bytes);
+}
+BENCHMARK(BM_EncodeFreqLines)->range(512, 8192);
+
+static void BM_EncodeFreqLinesGzip(State& state) {
+    size_t numBins = state.range() / 2 + 1;
+    size_t packed = 0;
+    gzip.allocate();
+    int64_t bytesIn = 0;
+    while (state.keepRunning()) {
+        gzip.begin(gzipOutSink, &packed);
+        encoder.begin(gzipInSink, nullptr);
+        encodeSpectrum(numBins);
+        gzip.finish();
+        bytesIn += gzip.bytesIn();
+    }
+    state.setItemsProcessed(state.iterations() * (numBins - 1));
+    state.setBytesProcessed(bytesIn);
+}
+BENCHMARK(BM_EncodeFreqLinesGzip)->range(512, 8192);
+
+static void BM_FormatFloat(State& state) {
+    char out[32];
+    size_t i = 0;
+    while (state.keepRunning()) {
+        doNotOptimize(LineProtocolEncoder::formatFloat(out, spectrum[0][i], 6));
+        i = (i + 1) % spectrum[0].size();
+    }
+    state.setItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_FormatFloat);
+
+static void BM_Base64(State& state) {
+    size_t len = state.range();
+    size_t bytes = 0;
+    while (state.keepRunning()) {
+        encoder.begin(countSink, &bytes);
+        encoder.base64((const uint8_t*)raw.data(), len);
+        encoder.flush();
+    }
+    state.setBytesProcessed(state.iterations() * len);
+}
+BENCHMARK(BM_Base64)->arg(8192);
+
+// ============================================================================
+// Runner
+// ============================================================================
+struct Result {
+    std::string name;
+    int64_t iterations;
+    double wallNs;
+    double cpuNs;
+    double itemsPerSecond;
+    double bytesPerSecond;
+};
+
+static Result runOne(const Benchmark& b, int64_t arg, double minTimeS) {
+    int64_t iterations = 1;
+    while (true) {
+        State state(arg, iterations);
+        b.fn(state);
+        double seconds = state.wallNs() / 1e9;
+        if (seconds >= minTimeS || iterations >= 1000000000) {
+            std::string name = b.name;
+            if (!b.args.empty()) name += "/" + std::to_string(arg);
+            double cpuS = state.cpuNs() / 1e9;
+            return Result{
+                name, iterations,
+                state.wallNs() / iterations, state.cpuNs() / iterations,
+                cpuS > 0 ? state.items() / cpuS : 0.0,
+                cpuS > 0 ? state.bytes() / cpuS : 0.0
+            };
+        }
+        // Aim a little past the minimum time, at most 10x per step
+        double scale = seconds > 0 ? 1.4 * minTimeS / seconds : 10.0;
+        if (scale > 10.0) scale = 10.0;
+        int64_t next = (int64_t)(iterations * scale);
+        iterations = next > iterations ? next : iterations + 1;
+    }
+}
+
+int main(int argc, char** argv) {
+    std::string filter;
+    double minTimeS = 0.5;
+    bool json = false;
+    for (int i = 1; i < argc; i++) {
+        std::string opt = argv[i];
+        if (opt.rfind("--filter=", 0) == 0) filter = opt.substr(9);
+        else if (opt.rfind("--min_time=", 0) == 0) minTimeS = atof(opt.c_str() + 11);
+        else if (opt == "--format=json") json = true;
+        else {
+            fprintf(stderr, "usage: %s [--filter=<substring>] [--min_time=<s>] [--format=json]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    if (!dsp.begin() || !dsp.allocateWorkspace(MAX_SIZE)) {
+        fprintf(stderr, "DSP init failed\n");
+        return 1;
+    }
+    makeData();
+
+    std::vector<Result> results;
+    if (!json) {
+        printf("\n%-32s %14s %14s %12s %14s %12s\n",
+               "Benchmark", "Time (ns)", "CPU (ns)", "Iterations", "Items/s", "MB/s");
+    }
+    for (const Benchmark* b : registry()) {
+        std::vector<int64_t> args = b->args.empty() ? std::vector<int64_t>{ 0 } : b->args;
+        for (int64_t arg : args) {
+            std::string name = b->name;
+            if (!b->args.empty()) name += "/" + std::to_string(arg);
+            if (!filter.empty() && name.find(filter) == std::string::npos) continue;
+
+            Result r = runOne(*b, arg, minTimeS);
+            results.push_back(r);
+            if (!json) {
+                printf("%-32s %14.0f %14.0f %12lld %14.4g %12.1f\n",
+                       r.name.c_str(), r.wallNs, r.cpuNs, (long long)r.iterations,
+                       r.itemsPerSecond, r.bytesPerSecond / 1e6);
+            }
+        }
+    }
+
+    if (json) {
+        // Same top-level shape as Google Benchmark's JSON output
+        printf("{\n  \"benchmarks\": [\n");
+        for (size_t i = 0; i < results.size(); i++) {
+            const Result& r = results[i];
+            printf("    {\"name\": \"%s\", \"iterations\": %lld, \"real_time\": %.1f, "
+                   "\"cpu_time\": %.1f, \"time_unit\": \"ns\", \"items_per_second\": %.1f, "
+                   "\"bytes_per_second\": %.1f}%s\n",
+                   r.name.c_str(), (long long)r.iterations, r.wallNs, r.cpuNs,
+                   r.itemsPerSecond, r.bytesPerSecond, i + 1 < results.size() ? "," : "");
+        }
+        printf("  ]\n}\n");
+    }
+    return 0;
+}
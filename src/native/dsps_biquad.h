@@ -0,0 +1,8 @@
+#ifndef NATIVE_DSPS_BIQUAD_H
+#define NATIVE_DSPS_BIQUAD_H
+
+#include "esp_err.h"
+
+esp_err_t dsps_biquad_f32(const float* input, float* output, int len, float* coef, float* w);
+
+#endif // NATIVE_DSPS_BIQUAD_H
@@ -0,0 +1,16 @@
+#ifndef NATIVE_DSPS_FFT2R_H
+#define NATIVE_DSPS_FFT2R_H
+
+#include "esp_err.h"
+
+// ESP-DSP Kconfig default
+#ifndef CONFIG_DSP_MAX_FFT_SIZE
+#define CONFIG_DSP_MAX_FFT_SIZE 4096
+#endif
+
+esp_err_t dsps_fft2r_init_fc32(float* fft_table_buff, int table_size);
+void dsps_fft2r_deinit_fc32();
+esp_err_t dsps_fft2r_fc32(float* data, int N);
+esp_err_t dsps_bit_rev_fc32(float* data, int N);
+
+#endif // NATIVE_DSPS_FFT2R_H
@@ -0,0 +1,13 @@
+#ifndef NATIVE_DSPS_FFT4R_H
+#define NATIVE_DSPS_FFT4R_H
+
+#include "esp_err.h"
+
+// Same transform as the radix-2 reference, so DSP_FFT_RADIX4 builds
+// and compares on the host, but without a radix-4 speedup
+esp_err_t dsps_fft4r_init_fc32(float* fft_table_buff, int max_fft_size);
+void dsps_fft4r_deinit_fc32();
+esp_err_t dsps_fft4r_fc32(float* data, int N);
+esp_err_t dsps_bit_rev4r_fc32(float* data, int N);
+
+#endif // NATIVE_DSPS_FFT4R_H
@@ -0,0 +1,6 @@
+#ifndef NATIVE_DSPS_WIND_FLAT_TOP_H
+#define NATIVE_DSPS_WIND_FLAT_TOP_H
+
+void dsps_wind_flat_top_f32(float* window, int len);
+
+#endif // NATIVE_DSPS_WIND_FLAT_TOP_H
@@ -0,0 +1,6 @@
+#ifndef NATIVE_DSPS_WIND_HANN_H
+#define NATIVE_DSPS_WIND_HANN_H
+
+void dsps_wind_hann_f32(float* window, int len);
+
+#endif // NATIVE_DSPS_WIND_HANN_H
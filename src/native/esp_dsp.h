@@ -0,0 +1,22 @@
+#ifndef NATIVE_ESP_DSP_H
+#define NATIVE_ESP_DSP_H
+
+/**
+ * @brief Reference (plain C) replacements for the ESP-DSP functions the
+ *        firmware uses (native environment only)
+ *
+ * Same signatures, data layouts and conventions as ESP-DSP: complex data
+ * is interleaved re/im, the FFTs leave their output in bit-reversed order
+ * for the matching dsps_bit_rev*_fc32() call, and the biquad is Direct
+ * Form II with coefficients {b0, b1, b2, a1, a2}. Implemented in
+ * esp_dsp_ref.cpp.
+ */
+
+#include "esp_err.h"
+#include "dsps_fft2r.h"
+#include "dsps_fft4r.h"
+#include "dsps_wind_hann.h"
+#include "dsps_wind_flat_top.h"
+#include "dsps_biquad.h"
+
+#endif // NATIVE_ESP_DSP_H
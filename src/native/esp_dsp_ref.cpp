@@ -0,0 +1,121 @@
+#include "esp_dsp.h"
+#include <math.h>
+#include <stdlib.h>
+
+// Twiddles exp(-j 2 pi k / size) for k < size / 2, interleaved re/im
+static float* twiddle = nullptr;
+static int twiddleSize = 0;
+
+// The caller's table buffer is not used: the shim keeps its own twiddles
+esp_err_t dsps_fft2r_init_fc32(float*, int table_size) {
+    if (table_size < 2 || (table_size & (table_size - 1)) != 0) {
+        return ESP_ERR_DSP_INVALID_LENGTH;
+    }
+    if (twiddle && twiddleSize >= table_size) {
+        return ESP_OK;
+    }
+    free(twiddle);
+    twiddle = (float*)malloc(table_size * sizeof(float));
+    if (!twiddle) {
+        twiddleSize = 0;
+        return ESP_ERR_NO_MEM;
+    }
+    for (int k = 0; k < table_size / 2; k++) {
+        double phase = -2.0 * M_PI * k / table_size;
+        twiddle[2 * k] = (float)cos(phase);
+        twiddle[2 * k + 1] = (float)sin(phase);
+    }
+    twiddleSize = table_size;
+    return ESP_OK;
+}
+
+void dsps_fft2r_deinit_fc32() {
+    free(twiddle);
+    twiddle = nullptr;
+    twiddleSize = 0;
+}
+
+esp_err_t dsps_fft2r_fc32(float* data, int N) {
+    if (!twiddle) return ESP_ERR_DSP_UNINITIALIZED;
+    if (N > twiddleSize || (N & (N - 1)) != 0) return ESP_ERR_DSP_INVALID_LENGTH;
+
+    // Decimation in frequency: natural order in, bit-reversed order out
+    for (int len = N; len >= 2; len >>= 1) {
+        int half = len / 2;
+        int step = twiddleSize / len;
+        for (int start = 0; start < N; start += len) {
+            for (int k = 0; k < half; k++) {
+                float* a = data + 2 * (start + k);
+                float* b = data + 2 * (start + k + half);
+                float wr = twiddle[2 * k * step];
+                float wi = twiddle[2 * k * step + 1];
+                float dr = a[0] - b[0];
+                float di = a[1] - b[1];
+                a[0] += b[0];
+                a[1] += b[1];
+                b[0] = dr * wr - di * wi;
+                b[1] = dr * wi + di * wr;
+            }
+        }
+    }
+    return ESP_OK;
+}
+
+esp_err_t dsps_bit_rev_fc32(float* data, int N) {
+    if ((N & (N - 1)) != 0) return ESP_ERR_DSP_INVALID_LENGTH;
+    for (int i = 1, j = 0; i < N; i++) {
+        int bit = N >> 1;
+        for (; j & bit; bit >>= 1) j ^= bit;
+        j ^= bit;
+        if (i < j) {
+            float re = data[2 * i], im = data[2 * i + 1];
+            data[2 * i] = data[2 * j];
+            data[2 * i + 1] = data[2 * j + 1];
+            data[2 * j] = re;
+            data[2 * j + 1] = im;
+        }
+    }
+    return ESP_OK;
+}
+
+esp_err_t dsps_fft4r_init_fc32(float* fft_table_buff, int max_fft_size) {
+    return dsps_fft2r_init_fc32(fft_table_buff, max_fft_size);
+}
+
+void dsps_fft4r_deinit_fc32() {
+    dsps_fft2r_deinit_fc32();
+}
+
+esp_err_t dsps_fft4r_fc32(float* data, int N) {
+    return dsps_fft2r_fc32(data, N);
+}
+
+esp_err_t dsps_bit_rev4r_fc32(float* data, int N) {
+    return dsps_bit_rev_fc32(data, N);
+}
+
+void dsps_wind_hann_f32(float* window, int len) {
+    float scale = 1.0f / (float)(len - 1);
+    for (int i = 0; i < len; i++) {
+        window[i] = 0.5f * (1.0f - cosf(i * 2.0f * (float)M_PI * scale));
+    }
+}
+
+void dsps_wind_flat_top_f32(float* window, int len) {
+    const float a0 = 1.0f, a1 = 1.93f, a2 = 1.29f, a3 = 0.388f, a4 = 0.028f;
+    float scale = 1.0f / (float)(len - 1);
+    for (int i = 0; i < len; i++) {
+        float x = i * 2.0f * (float)M_PI * scale;
+        window[i] = a0 - a1 * cosf(x) + a2 * cosf(2.0f * x) - a3 * cosf(3.0f * x) + a4 * cosf(4.0f * x);
+    }
+}
+
+esp_err_t dsps_biquad_f32(const float* input, float* output, int len, float* coef, float* w) {
+    for (int i = 0; i < len; i++) {
+        float d0 = input[i] - coef[3] * w[0] - coef[4] * w[1];
+        output[i] = coef[0] * d0 + coef[1] * w[0] + coef[2] * w[1];
+        w[1] = w[0];
+        w[0] = d0;
+    }
+    return ESP_OK;
+}
@@ -0,0 +1,15 @@
+#ifndef NATIVE_ESP_ERR_H
+#define NATIVE_ESP_ERR_H
+
+// ESP-IDF error codes used by the ESP-DSP shims (native environment only)
+typedef int esp_err_t;
+
+#define ESP_OK                  0
+#define ESP_FAIL                -1
+#define ESP_ERR_NO_MEM          0x101
+#define ESP_ERR_INVALID_ARG     0x102
+#define ESP_ERR_DSP_BASE        0x70000
+#define ESP_ERR_DSP_INVALID_LENGTH  (ESP_ERR_DSP_BASE + 1)
+#define ESP_ERR_DSP_UNINITIALIZED   (ESP_ERR_DSP_BASE + 4)
+
+#endif // NATIVE_ESP_ERR_H
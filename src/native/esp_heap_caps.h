@@ -0,0 +1,31 @@
+#ifndef NATIVE_ESP_HEAP_CAPS_H
+#define NATIVE_ESP_HEAP_CAPS_H
+
+#include <stdlib.h>
+#include <stddef.h>
+
+// ESP-IDF capability allocator on top of the host heap (native
+// environment only); capabilities are ignored and no totals are kept
+#define MALLOC_CAP_8BIT     (1 << 2)
+#define MALLOC_CAP_DMA      (1 << 3)
+#define MALLOC_CAP_INTERNAL (1 << 11)
+
+static inline void* heap_caps_malloc(size_t size, unsigned) {
+    return malloc(size);
+}
+
+static inline void* heap_caps_aligned_alloc(size_t alignment, size_t size, unsigned) {
+    void* p = nullptr;
+    return posix_memalign(&p, alignment < sizeof(void*) ? sizeof(void*) : alignment, size) == 0
+           ? p : nullptr;
+}
+
+static inline void heap_caps_free(void* p) {
+    free(p);
+}
+
+static inline size_t heap_caps_get_free_size(unsigned) { return 0; }
+static inline size_t heap_caps_get_largest_free_block(unsigned) { return 0; }
+static inline size_t heap_caps_get_minimum_free_size(unsigned) { return 0; }
+
+#endif // NATIVE_ESP_HEAP_CAPS_H
@@ -0,0 +1,184 @@
+#ifndef RING_BUFFER_H
+#define RING_BUFFER_H
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+
+/**
+ * @brief Single-producer/single-consumer lock-free ring buffer
+ *
+ * One task writes, one task reads; no locks are taken. The producer owns
+ * the head index and the consumer owns the tail, each published with
+ * release/acquire ordering so element data is visible before the index
+ * that covers it. One slot is kept empty to tell full from empty.
+ *
+ * Both sides can work in place through contiguous regions
+ * (writeRegion/commit, readRegion/consume) to avoid extra copies.
+ */
+template <typename T>
+class SpscRing {
+public:
+    SpscRing() = default;
+    ~SpscRing() { release(); }
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    /**
+     * @brief Allocate storage; not safe while either side is active
+     * @param capacity Number of elements the ring can hold
+     * @return true if allocation succeeded
+     */
+    bool allocate(size_t capacity) {
+        release();
+        _buffer = (T*)malloc((capacity + 1) * sizeof(T));
+        if (!_buffer) {
+            return false;
+        }
+        _slots = capacity + 1;
+        reset();
+        return true;
+    }
+
+    /**
+     * @brief Free storage
+     */
+    void release() {
+        if (_buffer) {
+            free(_buffer);
+            _buffer = nullptr;
+        }
+        _slots = 0;
+        reset();
+    }
+
+    /**
+     * @brief Discard all contents; not safe while either side is active
+     */
+    void reset() {
+        _head.store(0, std::memory_order_relaxed);
+        _tail.store(0, std::memory_order_relaxed);
+    }
+
+    size_t capacity() const { return _slots ? _slots - 1 : 0; }
+
+    /**
+     * @brief Elements ready for the consumer
+     */
+    size_t available() const {
+        size_t head = _head.load(std::memory_order_acquire);
+        size_t tail = _tail.load(std::memory_order_relaxed);
+        return head >= tail ? head - tail : head + _slots - tail;
+    }
+
+    /**
+     * @brief Free slots for the producer
+     */
+    size_t freeSpace() const {
+        size_t head = _head.load(std::memory_order_relaxed);
+        size_t tail = _tail.load(std::memory_order_acquire);
+        return tail > head ? tail - head - 1 : tail + _slots - head - 1;
+    }
+
+    // ------------------------------------------------------------------------
+    // Producer side
+    // ------------------------------------------------------------------------
+
+    /**
+     * @brief Get the contiguous free region at the write position
+     * @param region Output: pointer to the first free slot
+     * @return Number of contiguous free slots
+     */
+    size_t writeRegion(T** region) {
+        if (!_buffer) return 0;
+        size_t head = _head.load(std::memory_order_relaxed);
+        size_t tail = _tail.load(std::memory_order_acquire);
+        size_t n = tail > head ? tail - head - 1 : _slots - head - (tail == 0 ? 1 : 0);
+        *region = _buffer + head;
+        return n;
+    }
+
+    /**
+     * @brief Publish elements written into the write region
+     * @param n Number of elements written (<= writeRegion() result)
+     */
+    void commit(size_t n) {
+        size_t head = _head.load(std::memory_order_relaxed) + n;
+        if (head >= _slots) head -= _slots;
+        _head.store(head, std::memory_order_release);
+    }
+
+    /**
+     * @brief Copy elements in
+     * @return Number of elements written (less than n if full)
+     */
+    size_t push(const T* src, size_t n) {
+        size_t written = 0;
+        while (written < n) {
+            T* region;
+            size_t room = writeRegion(&region);
+            if (room == 0) break;
+            if (room > n - written) room = n - written;
+            memcpy(region, src + written, room * sizeof(T));
+            commit(room);
+            written += room;
+        }
+        return written;
+    }
+
+    // ------------------------------------------------------------------------
+    // Consumer side
+    // ------------------------------------------------------------------------
+
+    /**
+     * @brief Get the contiguous filled region at the read position
+     * @param region Output: pointer to the oldest element
+     * @return Number of contiguous elements
+     */
+    size_t readRegion(const T** region) const {
+        if (!_buffer) return 0;
+        size_t head = _head.load(std::memory_order_acquire);
+        size_t tail = _tail.load(std::memory_order_relaxed);
+        size_t n = head >= tail ? head - tail : _slots - tail;
+        *region = _buffer + tail;
+        return n;
+    }
+
+    /**
+     * @brief Release elements read from the read region
+     * @param n Number of elements consumed (<= readRegion() result)
+     */
+    void consume(size_t n) {
+        size_t tail = _tail.load(std::memory_order_relaxed) + n;
+        if (tail >= _slots) tail -= _slots;
+        _tail.store(tail, std::memory_order_release);
+    }
+
+    /**
+     * @brief Copy elements out
+     * @return Number of elements read (less than n if empty)
+     */
+    size_t pop(T* dst, size_t n) {
+        size_t read = 0;
+        while (read < n) {
+            const T* region;
+            size_t count = readRegion(&region);
+            if (count == 0) break;
+            if (count > n - read) count = n - read;
+            memcpy(dst + read, region, count * sizeof(T));
+            consume(count);
+            read += count;
+        }
+        return read;
+    }
+
+private:
+    T* _buffer = nullptr;
+    size_t _slots = 0;
+    std::atomic<size_t> _head{0};   // Next slot to write (producer)
+    std::atomic<size_t> _tail{0};   // Next slot to read (consumer)
+};
+
+#endif // RING_BUFFER_H
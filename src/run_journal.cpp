@@ -0,0 +1,321 @@
+#include "run_journal.h"
+#include <LittleFS.h>
+
+// Global instance
+RunJournal runJournal;
+
+static const char* TEMP_PATH = JOURNAL_DIR "/pending.tmp";
+
+void RunJournal::_path(char* out, size_t size, uint32_t seq) const {
+    snprintf(out, size, JOURNAL_DIR "/%08lu.run", (unsigned long)seq);
+}
+
+size_t RunJournal::_recordBytes(const JournalRecord& rec) const {
+    return sizeof(JournalRecord) +
+           3 * (size_t)rec.numBins * sizeof(float) +
+           3 * (size_t)rec.timeFrames * sizeof(int16_t);
+}
+
+size_t RunJournal::_fileSize(uint32_t seq) const {
+    char path[32];
+    _path(path, sizeof(path), seq);
+    File f = LittleFS.open(path, FILE_READ);
+    if (!f) return 0;
+    size_t size = f.size();
+    f.close();
+    return size;
+}
+
+bool RunJournal::begin() {
+    _bootId = esp_random();
+
+    if (!LittleFS.begin(true)) {
+        Serial.println("[Journal] LittleFS mount failed!");
+        return false;
+    }
+    if (!LittleFS.exists(JOURNAL_DIR)) {
+        LittleFS.mkdir(JOURNAL_DIR);
+    }
+
+    // A record interrupted by a reset is discarded
+    if (LittleFS.exists(TEMP_PATH)) {
+        LittleFS.remove(TEMP_PATH);
+    }
+
+    // Index existing records
+    uint32_t minSeq = UINT32_MAX;
+    uint32_t maxSeq = 0;
+    _count = 0;
+    _bytes = 0;
+
+    File dir = LittleFS.open(JOURNAL_DIR);
+    if (dir && dir.isDirectory()) {
+        for (File f = dir.openNextFile(); f; f = dir.openNextFile()) {
+            const char* name = strrchr(f.name(), '/');
+            name = name ? name + 1 : f.name();
+
+            unsigned long seq;
+            char ext[5] = {0};
+            if (sscanf(name, "%8lu.%4s", &seq, ext) == 2 && strcmp(ext, "run") == 0) {
+                if (seq < minSeq) minSeq = seq;
+                if (seq > maxSeq) maxSeq = seq;
+                _count++;
+                _bytes += f.size();
+            }
+            f.close();
+        }
+    }
+
+    _firstSeq = _count > 0 ? minSeq : 0;
+    _nextSeq = _count > 0 ? maxSeq + 1 : 0;
+    _ready = true;
+
+    // The baselines and web files share the partition
+    size_t total = LittleFS.totalBytes();
+    size_t others = JOURNAL_FS_RESERVE + BASELINE_MAX_BYTES;
+    size_t fits = total > others ? total - others : 0;
+    _maxBytes = fits < JOURNAL_MAX_BYTES ? fits : JOURNAL_MAX_BYTES;
+
+    Serial.printf("[Journal] %d record(s) pending, %d of %d bytes\n", _count, _bytes, _maxBytes);
+    return true;
+}
+
+void RunJournal::_removeOldest() {
+    // Sequence numbers are contiguous unless a file was removed by hand
+    while (_firstSeq < _nextSeq) {
+        char path[32];
+        _path(path, sizeof(path), _firstSeq++);
+        if (LittleFS.exists(path)) {
+            size_t size = _fileSize(_firstSeq - 1);
+            _removeFile(_firstSeq - 1);
+            _bytes = _bytes > size ? _bytes - size : 0;
+            if (_count > 0) _count--;
+            return;
+        }
+    }
+    _count = 0;
+    _bytes = 0;
+}
+
+void RunJournal::_removeFile(uint32_t seq) {
+    // A record being downloaded is deleted when the download closes it
+    portENTER_CRITICAL(&_pinMux);
+    bool pinned = _pinned && _pinnedSeq == seq;
+    if (pinned) _pinnedRemoved = true;
+    portEXIT_CRITICAL(&_pinMux);
+
+    if (!pinned) {
+        char path[32];
+        _path(path, sizeof(path), seq);
+        LittleFS.remove(path);
+    }
+}
+
+bool RunJournal::_write(const uint8_t* data, size_t len) {
+    // A short write means the partition is full (the baselines or web
+    // files took more than budgeted): make room and write the rest
+    while (_writeFile) {
+        size_t n = _writeFile.write(data, len);
+        _written += n;
+        data += n;
+        len -= n;
+        if (len == 0) {
+            return true;
+        }
+        if (_count == 0) {
+            Serial.println("[Journal] Filesystem full");
+            return false;
+        }
+        Serial.println("[Journal] Filesystem full, evicting oldest record");
+        _removeOldest();
+        // Drops anything left in the write buffer past what reached flash
+        _writeFile.seek(_written);
+    }
+    return false;
+}
+
+bool RunJournal::beginRecord(const JournalRecord& rec) {
+    if (!_ready) return false;
+
+    size_t needed = _recordBytes(rec);
+    if (needed > _maxBytes) {
+        Serial.printf("[Journal] Record of %d bytes exceeds journal size\n", needed);
+        return false;
+    }
+
+    // Oldest-first eviction
+    while (_count > 0 && (_bytes + needed > _maxBytes || _count >= JOURNAL_MAX_RECORDS)) {
+        Serial.println("[Journal] Full, evicting oldest record");
+        _removeOldest();
+    }
+
+    _writeFile = LittleFS.open(TEMP_PATH, FILE_WRITE);
+    if (!_writeFile) {
+        Serial.println("[Journal] Failed to create record");
+        return false;
+    }
+
+    _pending = rec;
+    _pending.magic = RECORD_MAGIC;
+    _written = 0;
+    if (!_write((const uint8_t*)&_pending, sizeof(_pending))) {
+        _writeFile.close();
+        LittleFS.remove(TEMP_PATH);
+        return false;
+    }
+    return true;
+}
+
+bool RunJournal::writeSpectra(const float* x, const float* y, const float* z) {
+    size_t bytes = _pending.numBins * sizeof(float);
+    return _write((const uint8_t*)x, bytes) &&
+           _write((const uint8_t*)y, bytes) &&
+           _write((const uint8_t*)z, bytes);
+}
+
+bool RunJournal::writeTime(const int16_t* xyz, size_t frames) {
+    size_t bytes = frames * 3 * sizeof(int16_t);
+    return _write((const uint8_t*)xyz, bytes);
+}
+
+bool RunJournal::commitRecord() {
+    if (!_writeFile) return false;
+
+    size_t size = _writeFile.size();
+    _writeFile.close();
+
+    if (size != _recordBytes(_pending)) {
+        Serial.printf("[Journal] Incomplete record (%d of %d bytes), discarded\n",
+                      size, _recordBytes(_pending));
+        LittleFS.remove(TEMP_PATH);
+        return false;
+    }
+
+    char path[32];
+    _path(path, sizeof(path), _nextSeq);
+    if (!LittleFS.rename(TEMP_PATH, path)) {
+        LittleFS.remove(TEMP_PATH);
+        return false;
+    }
+
+    if (_count == 0) _firstSeq = _nextSeq;
+    _nextSeq++;
+    _count++;
+    _bytes += size;
+
+    Serial.printf("[Journal] Stored run %lu (%d bytes, %d pending)\n",
+                  (unsigned long)_pending.sequence, size, _count);
+    return true;
+}
+
+bool RunJournal::openOldest(JournalRecord& rec) {
+    while (_ready && _count > 0 && _firstSeq < _nextSeq) {
+        char path[32];
+        _path(path, sizeof(path), _firstSeq);
+        if (!LittleFS.exists(path)) {
+            _firstSeq++;
+            continue;
+        }
+
+        _readFile = LittleFS.open(path, FILE_READ);
+        bool valid = _readFile &&
+                     _readFile.read((uint8_t*)&_current, sizeof(_current)) == sizeof(_current) &&
+                     _current.magic == RECORD_MAGIC &&
+                     _readFile.size() == _recordBytes(_current);
+        if (valid) {
+            _timeLeft = _current.timeFrames;
+            rec = _current;
+            return true;
+        }
+
+        Serial.printf("[Journal] Dropping invalid record %lu\n", (unsigned long)_firstSeq);
+        closeRecord(true);
+    }
+    return false;
+}
+
+bool RunJournal::readSpectra(float* x, float* y, float* z, size_t maxBins) {
+    if (!_readFile || _current.numBins > maxBins) {
+        return false;
+    }
+    size_t bytes = _current.numBins * sizeof(float);
+    return _readFile.read((uint8_t*)x, bytes) == bytes &&
+           _readFile.read((uint8_t*)y, bytes) == bytes &&
+           _readFile.read((uint8_t*)z, bytes) == bytes;
+}
+
+size_t RunJournal::readTime(int16_t* xyz, size_t maxFrames) {
+    if (!_readFile) return 0;
+
+    size_t frames = _timeLeft < maxFrames ? _timeLeft : maxFrames;
+    size_t bytes = frames * 3 * sizeof(int16_t);
+    if (frames == 0 || _readFile.read((uint8_t*)xyz, bytes) != bytes) {
+        return 0;
+    }
+    _timeLeft -= frames;
+    return frames;
+}
+
+void RunJournal::closeRecord(bool remove) {
+    if (_readFile) {
+        _readFile.close();
+    }
+
+    // The open record is always the oldest one
+    if (remove) {
+        _removeOldest();
+    }
+}
+
+bool RunJournal::openNewest(File& file, JournalRecord& rec) {
+    uint32_t seq = _nextSeq;
+    if (!_ready || _count == 0 || seq == 0) {
+        return false;
+    }
+    seq--;
+
+    portENTER_CRITICAL(&_pinMux);
+    bool busy = _pinned;
+    if (!busy) {
+        _pinned = true;
+        _pinnedRemoved = false;
+        _pinnedSeq = seq;
+    }
+    portEXIT_CRITICAL(&_pinMux);
+    if (busy) {
+        return false;
+    }
+
+    char path[32];
+    _path(path, sizeof(path), seq);
+    file = LittleFS.open(path, FILE_READ);
+    bool valid = file &&
+                 file.read((uint8_t*)&rec, sizeof(rec)) == sizeof(rec) &&
+                 rec.magic == RECORD_MAGIC &&
+                 file.size() == _recordBytes(rec) &&
+                 file.seek(sizeof(rec) + 3 * (size_t)rec.numBins * sizeof(float));
+    if (!valid) {
+        closeNewest(file);
+        return false;
+    }
+    return true;
+}
+
+void RunJournal::closeNewest(File& file) {
+    if (file) {
+        file.close();
+    }
+
+    portENTER_CRITICAL(&_pinMux);
+    bool removed = _pinnedRemoved;
+    uint32_t seq = _pinnedSeq;
+    _pinned = false;
+    _pinnedRemoved = false;
+    portEXIT_CRITICAL(&_pinMux);
+
+    if (removed) {
+        char path[32];
+        _path(path, sizeof(path), seq);
+        LittleFS.remove(path);
+    }
+}
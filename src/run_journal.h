@@ -0,0 +1,202 @@
+#ifndef RUN_JOURNAL_H
+#define RUN_JOURNAL_H
+
+#include <Arduino.h>
+#include <FS.h>
+#include "config.h"
+#include "feature_extraction.h"
+#include "spectral_baseline.h"
+
+/**
+ * @brief Fixed-size header of one journaled run
+ *
+ * Followed in the file by numBins float magnitudes per axis (X, Y, Z)
+ * and timeFrames interleaved int16 X/Y/Z frames in sensor counts.
+ */
+struct JournalRecord {
+    uint32_t magic;
+    uint32_t bootId;            // RunJournal::bootId() when captured
+    uint32_t uptimeMs;          // millis() at trigger
+    uint32_t sequence;          // Run counter since that boot
+    uint8_t sensor;             // Sensor index on the SPI bus
+    uint64_t epochNs;           // Capture time, 0 if the clock was not set
+    char runId[48];             // Run ID if one was assigned, else empty
+    char operationId[32];
+    char firmware[16];
+    uint16_t sampleRateHz;
+    uint16_t sampleCount;
+    uint16_t filterCutoffHz;
+    uint16_t numBins;
+    uint32_t fftSize;
+    float rangeG;
+    float scale;                // g per LSB of the time-domain frames
+    uint32_t timeFrames;        // 0 if time-domain data was not kept
+    uint32_t averages;          // Welch segments averaged, 1 for one FFT
+    float zoomCenterHz;         // Zoomed band center (zoomFactor > 0)
+    uint16_t zoomFactor;        // Zoom decimation, 0 for a full spectrum
+    uint8_t decimation;         // Sensor frames per stored frame
+    uint8_t triggerReason;      // TriggerReason
+    uint32_t preTriggerFrames;  // Frames before the trigger edge
+    int64_t startUs;            // esp_timer time of the first frame
+    float odrHz;                // Measured sample rate
+    int32_t triggerOffsetUs;    // First frame relative to the trigger edge
+    uint32_t timingJitterUs;    // Largest chunk stamp deviation
+    RunFeatures features;
+    SpectralDiff diff;          // Deviation from the baseline, baselineRuns 0 if none
+};
+
+/**
+ * @brief LittleFS store-and-forward queue for runs that failed to upload
+ *
+ * Each run is one file under JOURNAL_DIR, written to a temporary name and
+ * renamed when complete so a reset never leaves a half record behind.
+ * File names carry an increasing sequence number; the oldest record is
+ * replayed first and evicted first when the journal is over its size or
+ * record limit, or when a write finds the filesystem full. The size
+ * limit leaves room on the partition for the web files and the largest
+ * set of spectral baselines.
+ *
+ * Writing: beginRecord(), writeSpectra(), writeTime() (any number of
+ * times), commitRecord(). Reading: openOldest(), readSpectra(),
+ * readTime() until it returns 0, closeRecord().
+ */
+class RunJournal {
+public:
+    /**
+     * @brief Mount LittleFS and index existing records
+     * @return true if the journal is usable
+     */
+    bool begin();
+
+    /**
+     * @brief Random id of this boot, used to date records without a clock
+     */
+    uint32_t bootId() const { return _bootId; }
+
+    /**
+     * @brief Number of records waiting
+     */
+    size_t count() const { return _count; }
+
+    /**
+     * @brief Bytes used by committed records
+     */
+    size_t bytesUsed() const { return _bytes; }
+
+    // ------------------------------------------------------------------------
+    // Writing
+    // ------------------------------------------------------------------------
+    
+
+    /**
+     * @brief Start a new record and write its header
+     * 
+     * Evicts the oldest records first if the new one would not fit.
+     * @param rec Record header; numBins and timeFrames must be final
+     * @return true if the temporary file was created
+     */
+    bool beginRecord(const JournalRecord& rec);
+
+    /**
+     * @brief Write the three spectra (numBins each)
+     */
+    bool writeSpectra(const float* x, const float* y, const float* z);
+
+    /**
+     * @brief Append interleaved X/Y/Z frames in counts
+     */
+    bool writeTime(const int16_t* xyz, size_t frames);
+
+    /**
+     * @brief Finish the record and make it visible to the reader
+     * @return true if the record was stored
+     */
+    bool commitRecord();
+
+    // ------------------------------------------------------------------------
+    // Reading
+    // ------------------------------------------------------------------------
+
+    /**
+     * @brief Open the oldest record
+     * @param rec Output: record header
+     * @return true if a valid record was opened (invalid ones are deleted)
+     */
+    bool openOldest(JournalRecord& rec);
+
+    /**
+     * @brief Read the spectra of the open record
+     * @param maxBins Capacity of each output array
+     * @return false if the record does not fit or is truncated
+     */
+    bool readSpectra(float* x, float* y, float* z, size_t maxBins);
+
+    /**
+     * @brief Read the next block of time-domain frames
+     * @return Frames read (0 at the end)
+     */
+    size_t readTime(int16_t* xyz, size_t maxFrames);
+
+    /**
+     * @brief Close the open record
+     * @param remove true to delete it (replayed or unusable)
+     */
+    void closeRecord(bool remove);
+
+    // ------------------------------------------------------------------------
+    // Download (any task)
+    // ------------------------------------------------------------------------
+
+    /**
+     * @brief Open the newest record's time-domain frames for a download
+     *
+     * Independent of the replay reader. The record stays pinned until
+     * closeNewest(); if replay or eviction removes it meanwhile, the
+     * file is deleted on close. One download at a time.
+     * @param file Output: positioned at the first frame
+     * @param rec Output: record header
+     * @return false if there is no record, it is invalid or already pinned
+     */
+    bool openNewest(File& file, JournalRecord& rec);
+
+    /**
+     * @brief Close a file from openNewest() and release the pin
+     */
+    void closeNewest(File& file);
+
+private:
+    static constexpr uint32_t RECORD_MAGIC = 0x524A4E41;   // "RJNA"
+
+    bool _ready = false;
+    uint32_t _bootId = 0;
+    uint32_t _firstSeq = 0;     // Oldest record
+    uint32_t _nextSeq = 0;      // Next record to write
+    size_t _count = 0;
+    size_t _bytes = 0;
+    size_t _maxBytes = JOURNAL_MAX_BYTES;   // Fitted to the partition by begin()
+
+    File _writeFile;
+    File _readFile;
+    JournalRecord _pending;
+    JournalRecord _current;
+    uint32_t _timeLeft = 0;
+    size_t _written = 0;        // Bytes of the pending record on flash
+
+    // Download pin
+    portMUX_TYPE _pinMux = portMUX_INITIALIZER_UNLOCKED;
+    bool _pinned = false;
+    bool _pinnedRemoved = false;
+    uint32_t _pinnedSeq = 0;
+
+    void _path(char* out, size_t size, uint32_t seq) const;
+    size_t _recordBytes(const JournalRecord& rec) const;
+    size_t _fileSize(uint32_t seq) const;
+    void _removeOldest();
+    bool _write(const uint8_t* data, size_t len);
+    void _removeFile(uint32_t seq);
+};
+
+// Global instance
+extern RunJournal runJournal;
+
+#endif // RUN_JOURNAL_H
@@ -0,0 +1,161 @@
+#include "spectral_baseline.h"
+#include <LittleFS.h>
+#include <math.h>
+
+// Global instance
+SpectralBaseline spectralBaseline;
+
+static const char* TEMP_PATH = BASELINE_DIR "/update.tmp";
+
+void SpectralBaseline::_path(char* out, size_t size, uint8_t sensor) const {
+    snprintf(out, size, BASELINE_DIR "/sensor%u.bin", sensor);
+}
+
+bool SpectralBaseline::_sameLayout(const Layout& a, const Layout& b) {
+    return a.numBins == b.numBins && a.fftSize == b.fftSize &&
+           a.sampleRateHz == b.sampleRateHz && a.zoomCenterHz == b.zoomCenterHz &&
+           a.zoomFactor == b.zoomFactor && a.filterCutoffHz == b.filterCutoffHz;
+}
+
+float SpectralBaseline::maxScore(const SpectralDiff& diff) {
+    float best = 0.0f;
+    for (int a = 0; a < 3; a++) {
+        if (diff.score[a] > best) best = diff.score[a];
+    }
+    return best;
+}
+
+bool SpectralBaseline::begin() {
+    if (!LittleFS.exists(BASELINE_DIR) && !LittleFS.mkdir(BASELINE_DIR)) {
+        Serial.println("[Baseline] Cannot create " BASELINE_DIR);
+        return false;
+    }
+
+    // An update interrupted by a reset leaves the previous baseline in place
+    if (LittleFS.exists(TEMP_PATH)) {
+        LittleFS.remove(TEMP_PATH);
+    }
+    _ready = true;
+    return true;
+}
+
+void SpectralBaseline::_rank(SpectralDiff& diff, const ChangedBin& bin) {
+    // Insertion into the short sorted list
+    float delta = fabsf(bin.amplitude - bin.baseline);
+    int pos = diff.topCount;
+    while (pos > 0 && fabsf(diff.top[pos - 1].amplitude - diff.top[pos - 1].baseline) < delta) {
+        pos--;
+    }
+    if (pos >= BASELINE_TOP_K) return;
+
+    int last = diff.topCount < BASELINE_TOP_K ? diff.topCount : BASELINE_TOP_K - 1;
+    for (int i = last; i > pos; i--) {
+        diff.top[i] = diff.top[i - 1];
+    }
+    diff.top[pos] = bin;
+    if (diff.topCount < BASELINE_TOP_K) diff.topCount++;
+}
+
+bool SpectralBaseline::update(uint8_t sensor, const Layout& layout, const float* const spectra[3],
+                              const float* freqHz, float alpha, SpectralDiff& diff) {
+    memset(&diff, 0, sizeof(diff));
+    if (!_ready || layout.numBins == 0) return false;
+
+    unsigned long startTime = millis();
+    char path[32];
+    _path(path, sizeof(path), sensor);
+
+    Header header = {};
+    File in = LittleFS.open(path, FILE_READ);
+    bool seeded = in &&
+                  in.read((uint8_t*)&header, sizeof(header)) == sizeof(header) &&
+                  header.magic == FILE_MAGIC && header.runs > 0 &&
+                  _sameLayout(header.layout, layout) &&
+                  in.size() == sizeof(Header) + 3 * layout.numBins * sizeof(float);
+    if (!seeded) {
+        if (in) in.close();
+        header.runs = 0;
+    }
+
+    File out = LittleFS.open(TEMP_PATH, FILE_WRITE);
+    if (!out) {
+        if (in) in.close();
+        Serial.println("[Baseline] Failed to create update file");
+        return false;
+    }
+
+    // Until 1 / runs drops below alpha the baseline is a plain mean, so a
+    // small alpha does not leave the first run dominating for long
+    float weight = 1.0f / (float)(header.runs + 1);
+    if (weight < alpha) weight = alpha;
+
+    Header next = { FILE_MAGIC, layout, header.runs + 1 };
+    bool ok = out.write((const uint8_t*)&next, sizeof(next)) == sizeof(next);
+
+    double devSq[3] = { 0.0, 0.0, 0.0 };
+    double baseSq[3] = { 0.0, 0.0, 0.0 };
+
+    for (size_t start = 0; ok && start < layout.numBins; start += BASELINE_BLOCK_BINS) {
+        size_t n = layout.numBins - start;
+        if (n > BASELINE_BLOCK_BINS) n = BASELINE_BLOCK_BINS;
+        size_t bytes = n * 3 * sizeof(float);
+
+        if (seeded && in.read((uint8_t*)_block, bytes) != bytes) {
+            ok = false;
+            break;
+        }
+
+        for (size_t i = 0; i < n; i++) {
+            size_t bin = start + i;
+            for (int a = 0; a < 3; a++) {
+                float current = spectra[a][bin];
+                float& base = _block[i * 3 + a];
+                if (!seeded) {
+                    base = current;
+                    continue;
+                }
+                if (bin > 0) {
+                    float d = current - base;
+                    devSq[a] += (double)d * d;
+                    baseSq[a] += (double)base * base;
+                    ChangedBin changed = { freqHz[bin], current, base, (uint8_t)a };
+                    _rank(diff, changed);
+                }
+                base += weight * (current - base);
+            }
+        }
+        ok = out.write((const uint8_t*)_block, bytes) == bytes;
+    }
+
+    if (in) in.close();
+    out.close();
+
+    if (!ok) {
+        Serial.printf("[Baseline] Update of sensor %d failed, baseline kept\n", sensor);
+        LittleFS.remove(TEMP_PATH);
+        memset(&diff, 0, sizeof(diff));
+        return false;
+    }
+
+    LittleFS.remove(path);
+    if (!LittleFS.rename(TEMP_PATH, path)) {
+        Serial.printf("[Baseline] Failed to store baseline of sensor %d\n", sensor);
+        LittleFS.remove(TEMP_PATH);
+        return false;
+    }
+
+    if (!seeded) {
+        Serial.printf("[Baseline] Sensor %d: new baseline, %d bins\n", sensor, layout.numBins);
+        memset(&diff, 0, sizeof(diff));
+        return true;
+    }
+
+    diff.baselineRuns = header.runs;
+    for (int a = 0; a < 3; a++) {
+        diff.score[a] = baseSq[a] > 0.0 ? (float)sqrt(devSq[a] / baseSq[a]) : 0.0f;
+    }
+    Serial.printf("[Baseline] Sensor %d: score X %.3f Y %.3f Z %.3f over %lu run(s), %lu ms\n",
+                  sensor, diff.score[0], diff.score[1], diff.score[2],
+                  (unsigned long)header.runs, millis() - startTime);
+    return true;
+}
@@ -0,0 +1,99 @@
+#ifndef SPECTRAL_BASELINE_H
+#define SPECTRAL_BASELINE_H
+
+#include <Arduino.h>
+#include "config.h"
+
+/**
+ * @brief One bin that moved away from the baseline
+ */
+struct ChangedBin {
+    float freqHz;
+    float amplitude;        // g, this run
+    float baseline;         // g, baseline before this run
+    uint8_t axis;           // 0 = X, 1 = Y, 2 = Z
+};
+
+/**
+ * @brief Deviation of one run from the baseline, as uploaded in accelbaseline
+ */
+struct SpectralDiff {
+    uint32_t baselineRuns;              // Runs in the baseline, 0 = just seeded (no scores)
+    float score[3];                     // RMS(run - baseline) / RMS(baseline) per axis
+    uint8_t topCount;                   // Valid entries in top
+    ChangedBin top[BASELINE_TOP_K];     // Largest |run - baseline|, descending
+};
+
+/**
+ * @brief Exponentially averaged baseline spectrum per sensor on LittleFS
+ *
+ * Each sensor has one file under BASELINE_DIR holding the spectrum shape
+ * it was built with and the X/Y/Z magnitudes interleaved per bin. A run
+ * is compared and folded in one block at a time, so only
+ * BASELINE_BLOCK_BINS bins are ever in RAM. The updated baseline goes to
+ * a temporary file that replaces the old one when complete.
+ *
+ * A run whose shape (bins, FFT size, rate, zoom, filter) differs from the
+ * stored one seeds a new baseline instead. DC is left out of the scores
+ * and the changed bins.
+ */
+class SpectralBaseline {
+public:
+    /**
+     * @brief Spectrum parameters a baseline is only valid for
+     */
+    struct Layout {
+        uint32_t numBins;
+        uint32_t fftSize;
+        float sampleRateHz;
+        float zoomCenterHz;
+        uint16_t zoomFactor;
+        uint16_t filterCutoffHz;
+    };
+
+    /**
+     * @brief Create BASELINE_DIR; LittleFS must already be mounted
+     * @return true if baselines can be stored
+     */
+    bool begin();
+
+    /**
+     * @brief Compare a run with the baseline of its sensor and fold it in
+     * @param sensor Sensor index
+     * @param layout Shape of the spectra
+     * @param spectra X, Y, Z magnitudes (layout.numBins each)
+     * @param freqHz Bin frequencies, for the changed bins
+     * @param alpha Weight of this run, 0..1; the first runs are averaged
+     *              evenly until 1 / runs drops below it
+     * @param diff Output; baselineRuns is 0 if the baseline was (re)seeded
+     * @return true if the baseline file was updated
+     */
+    bool update(uint8_t sensor, const Layout& layout, const float* const spectra[3],
+                const float* freqHz, float alpha, SpectralDiff& diff);
+
+    /**
+     * @brief Largest per-axis score of a diff
+     */
+    static float maxScore(const SpectralDiff& diff);
+
+private:
+    static constexpr uint32_t FILE_MAGIC = 0x53424C31;   // "SBL1"
+
+    struct Header {
+        uint32_t magic;
+        Layout layout;
+        uint32_t runs;
+    };
+
+    bool _ready = false;
+    float _block[BASELINE_BLOCK_BINS * 3];
+
+    void _path(char* out, size_t size, uint8_t sensor) const;
+    static bool _sameLayout(const Layout& a, const Layout& b);
+    static void _rank(SpectralDiff& diff, const ChangedBin& bin);
+};
+
+// Global instance
+extern SpectralBaseline spectralBaseline;
+
+#endif // SPECTRAL_BASELINE_H
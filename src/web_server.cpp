@@ -2,18 +2,158 @@
 #include "config_manager.h"
 #include "wifi_manager.h"
 #include "influxdb_client.h"
+#include "metrics.h"
+#include "latest_run.h"
+#include "run_journal.h"
+#include "fallback_page.h"
+#include "adxl313.h"
 #include <ArduinoJson.h>
 #include <LittleFS.h>
+#include <memory>
 
 // Global instance
 WebServer webServer;
 
+// ============================================================================
+// Run Download
+// ============================================================================
+static const char CSV_HEADER[] = "t_s,x_g,y_g,z_g\n";
+
+// One streaming download. Owned by the response's filler, so the sample
+// buffers or the journal pin are released when the response completes
+// or the client goes away.
+struct RunDownload {
+    enum Source : uint8_t { SOURCE_NONE, SOURCE_BUFFER, SOURCE_JOURNAL };
+    
+    Source source = SOURCE_NONE;
+    uint32_t generation = 0;    // latestRun token (buffer source)
+    RetainedRun run = {};       // Layout; counts/axes only for the buffer source
+    File file;                  // Journal source, at the next unread frame
+    
+    // CSV formatting
+    size_t next = 0;            // Next frame to format
+    char line[72];
+    size_t lineLen = 0;
+    size_t lineSent = 0;
+    int16_t block[RUN_DOWNLOAD_BLOCK_FRAMES * 3];
+    size_t blockFrames = 0;
+    size_t blockPos = 0;
+    
+    ~RunDownload() {
+        if (source == SOURCE_JOURNAL) {
+            runJournal.closeNewest(file);
+        } else if (source == SOURCE_BUFFER) {
+            latestRun.release();
+        }
+    }
+    
+    bool stale() {
+        if (source == SOURCE_BUFFER && !latestRun.isCurrent(generation)) {
+            Serial.printf("[WebServer] Run %lu replaced during download, response cut\n",
+                          (unsigned long)run.sequence);
+            return true;
+        }
+        return false;
+    }
+    
+    // Counts of a buffered frame; float buffers are quantized as in the journal
+    void countsAt(size_t frame, int16_t xyz[3]) const {
+        for (int a = 0; a < 3; a++) {
+            float counts = roundf(run.axes[a][frame] / run.scale);
+            xyz[a] = (int16_t)constrain(counts, -32768.0f, 32767.0f);
+        }
+    }
+    
+    // Interleaved int16 X/Y/Z, copied straight from the source
+    size_t fillBinary(uint8_t* out, size_t maxLen, size_t index) {
+        size_t total = run.frames * 3 * sizeof(int16_t);
+        if (index >= total || stale()) return 0;
+        size_t len = total - index < maxLen ? total - index : maxLen;
+        
+        if (source == SOURCE_JOURNAL) {
+            return file.read(out, len);
+        }
+        if (run.counts) {
+            memcpy(out, reinterpret_cast<const uint8_t*>(run.counts) + index, len);
+            return len;
+        }
+        
+        // Frames may straddle two calls
+        size_t written = 0;
+        while (written < len) {
+            size_t pos = index + written;
+            int16_t xyz[3];
+            countsAt(pos / sizeof(xyz), xyz);
+            size_t offset = pos % sizeof(xyz);
+            size_t n = sizeof(xyz) - offset;
+            if (n > len - written) n = len - written;
+            memcpy(out + written, reinterpret_cast<const uint8_t*>(xyz) + offset, n);
+            written += n;
+        }
+        return written;
+    }
+    
+    // Next frame in g; false at the end or on a read error
+    bool nextSample(float g[3]) {
+        if (next >= run.frames) return false;
+        
+        if (source == SOURCE_JOURNAL) {
+            if (blockPos >= blockFrames) {
+                size_t n = run.frames - next;
+                if (n > RUN_DOWNLOAD_BLOCK_FRAMES) n = RUN_DOWNLOAD_BLOCK_FRAMES;
+                size_t bytes = n * 3 * sizeof(int16_t);
+                if (file.read(reinterpret_cast<uint8_t*>(block), bytes) != bytes) return false;
+                blockFrames = n;
+                blockPos = 0;
+            }
+            const int16_t* xyz = block + 3 * blockPos++;
+            for (int a = 0; a < 3; a++) g[a] = xyz[a] * run.scale;
+        } else if (run.counts) {
+            const int16_t* xyz = run.counts + 3 * next;
+            for (int a = 0; a < 3; a++) g[a] = xyz[a] * run.scale;
+        } else {
+            for (int a = 0; a < 3; a++) g[a] = run.axes[a][next];
+        }
+        next++;
+        return true;
+    }
+    
+    // One line per frame, carried over when it does not fit
+    size_t fillCsv(uint8_t* out, size_t maxLen) {
+        if (stale()) return 0;
+        
+        size_t written = 0;
+        while (written < maxLen) {
+            if (lineSent == lineLen) {
+                float g[3];
+                if (!nextSample(g)) break;
+                double t = run.odrHz > 0.0f ? (next - 1) / (double)run.odrHz : 0.0;
+                lineLen = snprintf(line, sizeof(line), "%.6f,%.6f,%.6f,%.6f\n", t, g[0], g[1], g[2]);
+                lineSent = 0;
+            }
+            size_t n = lineLen - lineSent;
+            if (n > maxLen - written) n = maxLen - written;
+            memcpy(out + written, line + lineSent, n);
+            lineSent += n;
+            written += n;
+        }
+        return written;
+    }
+};
+
 void WebServer::begin(uint16_t port) {
     if (_server) {
         delete _server;
     }
     
     _server = new AsyncWebServer(port);
+    _live = new AsyncWebSocket(LIVE_WS_PATH);
+    if (!_liveQueue) {
+        _liveQueue = xQueueCreate(1, sizeof(LiveFrame));
+        if (!_liveQueue) {
+            Serial.println("[WebServer] Live queue allocation failed, live view off");
+        }
+    }
     
     // Initialize LittleFS for static files
     if (!LittleFS.begin(true)) {
@@ -34,6 +174,10 @@ void WebServer::stop() {
         delete _server;
         _server = nullptr;
     }
+    if (_live) {
+        delete _live;
+        _live = nullptr;
+    }
 }
 
 void WebServer::setTriggerCallback(void (*callback)()) {
@@ -47,10 +191,176 @@ void WebServer::updateStatus(unsigned long lastTriggerTime, size_t sampleCount,
     if (lastTriggerTime > 0) _triggerCount++;
 }
 
+void WebServer::loop() {
+    if (!_live) {
+        return;
+    }
+    _live->cleanupClients(LIVE_MAX_CLIENTS);
+    _liveClients = _live->count();
+    
+    if (!_liveQueue || xQueueReceive(_liveQueue, &_liveSend, 0) != pdTRUE ||
+        _liveClients == 0) {
+        return;
+    }
+    if (!_live->availableForWriteAll()) {
+        Serial.println("[WebServer] Live client still busy, frame skipped");
+        return;
+    }
+    AsyncWebSocketMessageBuffer* buffer = _live->makeBuffer(_liveSend.len);
+    if (!buffer) {
+        Serial.println("[WebServer] No memory for live frame");
+        return;
+    }
+    memcpy(buffer->get(), _liveSend.data, _liveSend.len);
+    _live->binaryAll(buffer);
+}
+
+void WebServer::_handleLiveEvent(AsyncWebSocket* server, AsyncWebSocketClient* client,
+                                 AwsEventType type) {
+    if (type == WS_EVT_CONNECT) {
+        if (server->count() > LIVE_MAX_CLIENTS) {
+            Serial.printf("[WebServer] Live client %u refused, %d connected\n",
+                          client->id(), LIVE_MAX_CLIENTS);
+            client->close();
+            return;
+        }
+        Serial.printf("[WebServer] Live client %u connected from %s\n",
+                      client->id(), client->remoteIP().toString().c_str());
+    } else if (type == WS_EVT_DISCONNECT) {
+        Serial.printf("[WebServer] Live client %u disconnected\n", client->id());
+    }
+}
+
+void WebServer::publishRun(const RunInfo& run, const RunFeatures& features,
+                           const float* const spectra[3], const float* freqHz,
+                           size_t numBins, float odrHz) {
+    // The client list belongs to the loop and async_tcp tasks; only the
+    // count loop() last saw is read here
+    if (!_liveQueue || _liveClients == 0 || numBins < 2) {
+        return;
+    }
+    
+    // Merge neighbouring bins (keeping the largest) down to the frame size
+    size_t usable = numBins - 1;
+    size_t group = (usable + LIVE_SPECTRUM_BINS - 1) / LIVE_SPECTRUM_BINS;
+    size_t bins = (usable + group - 1) / group;
+    _liveBuild.len = sizeof(LiveFrameHeader) + 3 * bins * sizeof(uint16_t);
+    uint8_t* out = _liveBuild.data;
+    
+    LiveFrameHeader header = {};
+    header.magic = LIVE_FRAME_MAGIC;
+    header.sequence = run.sequence;
+    header.sensor = run.sensor;
+    header.reason = run.reason;
+    header.bins = (uint16_t)bins;
+    header.startHz = freqHz[1];
+    header.binHz = numBins > 2 ? group * (freqHz[numBins - 1] - freqHz[1]) / (numBins - 2) : 0.0f;
+    header.odrHz = odrHz;
+    
+    uint8_t* values = out + sizeof(header);
+    for (int a = 0; a < 3; a++) {
+        const AxisFeatures& f = features.axis[a];
+        header.features[a][0] = f.rms;
+        header.features[a][1] = f.peak;
+        header.features[a][2] = f.crest;
+        header.features[a][3] = f.kurtosis;
+        header.features[a][4] = f.velocityRms;
+        
+        float peak = 0.0f;
+        for (size_t i = 1; i < numBins; i++) {
+            if (spectra[a][i] > peak) peak = spectra[a][i];
+        }
+        header.scale[a] = peak / 65535.0f;
+        float inv = peak > 0.0f ? 65535.0f / peak : 0.0f;
+        
+        for (size_t j = 0; j < bins; j++) {
+            size_t first = 1 + j * group;
+            size_t last = first + group < numBins ? first + group : numBins;
+            float m = 0.0f;
+            for (size_t i = first; i < last; i++) {
+                if (spectra[a][i] > m) m = spectra[a][i];
+            }
+            float q = m * inv + 0.5f;
+            uint16_t v = q >= 65535.0f ? 65535 : (uint16_t)q;
+            values[0] = (uint8_t)v;
+            values[1] = (uint8_t)(v >> 8);
+            values += 2;
+        }
+    }
+    memcpy(out, &header, sizeof(header));
+    
+    xQueueOverwrite(_liveQueue, &_liveBuild);
+}
+
+void WebServer::_loadAssets() {
+    _assetCount = 0;
+    File file = LittleFS.open(WEB_ETAG_FILE, FILE_READ);
+    if (!file) {
+        Serial.println("[WebServer] No " WEB_ETAG_FILE ", web files served as uploaded");
+        return;
+    }
+    
+    // One "<path> <hash>" line per gzipped file
+    while (file.available() && _assetCount < WEB_MAX_ASSETS) {
+        String line = file.readStringUntil('\n');
+        Asset& asset = _assets[_assetCount];
+        char hash[9];
+        if (sscanf(line.c_str(), "%31s %8s", asset.path, hash) != 2 || asset.path[0] != '/') {
+            continue;
+        }
+        snprintf(asset.etag, sizeof(asset.etag), "\"%s\"", hash);
+        _assetCount++;
+    }
+    file.close();
+    Serial.printf("[WebServer] %d gzipped web file(s)\n", _assetCount);
+}
+
+void WebServer::_serveAsset(AsyncWebServerRequest* request, const Asset& asset) {
+    // Pages are revalidated; what they reference carries its hash in the URL
+    bool page = strstr(asset.path, ".html") != nullptr;
+    const char* cacheControl = page ? "no-cache" : WEB_ASSET_CACHE_CONTROL;
+    
+    if (request->hasHeader("If-None-Match") &&
+        request->getHeader("If-None-Match")->value() == asset.etag) {
+        AsyncWebServerResponse* response = request->beginResponse(304);
+        response->addHeader("Cache-Control", cacheControl);
+        response->addHeader("ETag", asset.etag);
+        request->send(response);
+        return;
+    }
+    
+    // The file response picks path + ".gz" and sets Content-Encoding
+    AsyncWebServerResponse* response = request->beginResponse(LittleFS, asset.path);
+    response->addHeader("Cache-Control", cacheControl);
+    response->addHeader("ETag", asset.etag);
+    request->send(response);
+}
+
 void WebServer::_setupRoutes() {
-    // Serve static files from LittleFS
+    // Gzipped web files with cache headers, ahead of the plain file handler
+    _loadAssets();
+    for (size_t i = 0; i < _assetCount; i++) {
+        const Asset* asset = &_assets[i];
+        _server->on(asset->path, HTTP_GET, [this, asset](AsyncWebServerRequest* request) {
+            _serveAsset(request, *asset);
+        });
+        if (strcmp(asset->path, "/index.html") == 0) {
+            _server->on("/", HTTP_GET, [this, asset](AsyncWebServerRequest* request) {
+                _serveAsset(request, *asset);
+            });
+        }
+    }
+    
+    // Anything else from LittleFS, as uploaded
     _server->serveStatic("/", LittleFS, "/").setDefaultFile("index.html");
     
+    // Live view: runs are pushed, clients never send
+    _live->onEvent([this](AsyncWebSocket* server, AsyncWebSocketClient* client,
+                          AwsEventType type, void* arg, uint8_t* data, size_t len) {
+        _handleLiveEvent(server, client, type);
+    });
+    _server->addHandler(_live);
+    
     // API endpoints
     _server->on("/api/config", HTTP_GET, [this](AsyncWebServerRequest* request) {
         _handleGetConfig(request);
@@ -69,6 +379,17 @@ void WebServer::_setupRoutes() {
         _handleGetStatus(request);
     });
     
+    _server->on("/api/metrics", HTTP_GET, [this](AsyncWebServerRequest* request) {
+        _handleGetMetrics(request);
+    });
+    
+    _server->on("/api/run/latest.bin", HTTP_GET, [this](AsyncWebServerRequest* request) {
+        _handleRunDownload(request, false);
+    });
+    _server->on("/api/run/latest.csv", HTTP_GET, [this](AsyncWebServerRequest* request) {
+        _handleRunDownload(request, true);
+    });
+    
     _server->on("/api/reset", HTTP_POST, [this](AsyncWebServerRequest* request) {
         _handleReset(request);
     });
@@ -108,107 +429,19 @@ void WebServer::_setupRoutes() {
         _handleCaptivePortal(request);
     });
     
-    // Fallback root handler if LittleFS fails
-    _server->on("/", HTTP_GET, [this](AsyncWebServerRequest* request) {
-        if (LittleFS.exists("/index.html")) {
-            request->send(LittleFS, "/index.html", "text/html");
-        } else {
-            // Inline fallback HTML if filesystem not uploaded
-            String html = R"rawliteral(
-<!DOCTYPE html>
-<html>
-<head>
-    <meta charset="UTF-8">
-    <meta name="viewport" content="width=device-width, initial-scale=1.0">
-    <title>Vibration Sensor Setup</title>
-    <style>
-        body { font-family: -apple-system, sans-serif; background: #1a1a2e; color: #f1f5f9; 
-               padding: 20px; max-width: 500px; margin: 0 auto; }
-        h1 { color: #3b82f6; }
-        .card { background: #1e293b; padding: 20px; border-radius: 12px; margin: 20px 0; }
-        label { display: block; margin: 10px 0 5px; color: #94a3b8; }
-        input { width: 100%; padding: 12px; border-radius: 8px; border: 1px solid #334155;
-                background: #0f172a; color: #f1f5f9; box-sizing: border-box; }
-        button { width: 100%; padding: 14px; border-radius: 8px; border: none; margin-top: 20px;
-                 background: linear-gradient(135deg, #3b82f6, #2563eb); color: white; 
-                 font-weight: bold; cursor: pointer; }
-        .warn { background: #7c2d12; padding: 10px; border-radius: 8px; margin-bottom: 20px; }
-    </style>
-</head>
-<body>
-    <h1>🔧 Vibration Sensor</h1>
-    
-    <form id="setupForm">
-        <div class="card">
-            <h2>📶 WiFi</h2>
-            <label>SSID</label>
-            <input type="text" id="wifi_ssid" required>
-            <label>Password</label>
-            <input type="password" id="wifi_password">
-        </div>
-        
-        <div class="card">
-            <h2>📈 InfluxDB</h2>
-            <label>URL</label>
-            <input type="text" id="influx_url" placeholder="http://192.168.1.100:8086">
-            <label>Token</label>
-            <input type="password" id="influx_token">
-            <label>Org</label>
-            <input type="text" id="influx_org" value="expertise">
-            <label>Bucket</label>
-            <input type="text" id="influx_bucket" value="expertise">
-        </div>
-        
-        <div class="card">
-            <h2>🏭 Operation</h2>
-            <label>Operation ID</label>
-            <input type="text" id="operation_id" placeholder="L9OP600">
-        </div>
-        
-        <div class="card">
-            <h2>📐 Sensor</h2>
-            <label>Sensitivity Range</label>
-            <select id="sensitivity" style="width:100%;padding:12px;border-radius:8px;border:1px solid #334155;background:#0f172a;color:#f1f5f9;">
-                <option value="0">±0.5g (High resolution)</option>
-                <option value="1">±1g</option>
-                <option value="2" selected>±2g (Default)</option>
-                <option value="3">±4g (High amplitude)</option>
-            </select>
-        </div>
-        
-        <button type="submit">💾 Save & Reboot</button>
-    </form>
-    
-    <script>
-        document.getElementById('setupForm').onsubmit = async (e) => {
-            e.preventDefault();
-            const config = {
-                wifi_ssid: document.getElementById('wifi_ssid').value,
-                wifi_password: document.getElementById('wifi_password').value,
-                influx_url: document.getElementById('influx_url').value,
-                influx_token: document.getElementById('influx_token').value,
-                influx_org: document.getElementById('influx_org').value,
-                influx_bucket: document.getElementById('influx_bucket').value,
-                operation_id: document.getElementById('operation_id').value,
-                sensitivity: parseInt(document.getElementById('sensitivity').value)
-            };
-            try {
-                const resp = await fetch('/api/config', {
-                    method: 'POST',
-                    headers: {'Content-Type': 'application/json'},
-                    body: JSON.stringify(config)
-                });
-                alert('Saved! Device will reboot...');
-            } catch(err) {
-                alert('Error: ' + err);
-            }
-        };
-    </script>
-</body>
-</html>
-)rawliteral";
-            request->send(200, "text/html", html);
+    // Setup page compiled in, for devices without a filesystem image
+    _server->on("/", HTTP_GET, [](AsyncWebServerRequest* request) {
+        if (request->hasHeader("If-None-Match") &&
+            request->getHeader("If-None-Match")->value() == "\"" FALLBACK_PAGE_ETAG "\"") {
+            request->send(304);
+            return;
         }
+        AsyncWebServerResponse* response = request->beginResponse_P(
+            200, "text/html", FALLBACK_PAGE_GZ, sizeof(FALLBACK_PAGE_GZ));
+        response->addHeader("Content-Encoding", "gzip");
+        response->addHeader("Cache-Control", "no-cache");
+        response->addHeader("ETag", "\"" FALLBACK_PAGE_ETAG "\"");
+        request->send(response);
     });
     
     // 404 handler - serve fallback or 404
@@ -239,7 +472,7 @@ void WebServer::_handleGetConfig(AsyncWebServerRequest* request) {
 
 String WebServer::_generateConfigJson() {
     DeviceConfig& cfg = configManager.getConfig();
-    StaticJsonDocument<1024> doc;
+    StaticJsonDocument<1536> doc;
     
     // WiFi
     doc["wifi_ssid"] = cfg.wifi_ssid;
@@ -250,6 +483,8 @@ String WebServer::_generateConfigJson() {
     doc["influx_token"] = "";  // Don't send token back
     doc["influx_org"] = cfg.influx_org;
     doc["influx_bucket"] = cfg.influx_bucket;
+    doc["influx_gzip"] = cfg.influx_gzip;
+    doc["spectrum_format"] = cfg.spectrum_format;
     
     // Operation
     doc["operation_id"] = cfg.operation_id;
@@ -257,6 +492,13 @@ String WebServer::_generateConfigJson() {
     // Hardware
     doc["plc_trigger_pin"] = cfg.plc_trigger_pin;
     doc["spi_cs_pin"] = cfg.spi_cs_pin;
+    doc["adxl_int_pin"] = cfg.adxl_int_pin;
+    doc["sensor_count"] = cfg.sensor_count;
+    doc["max_sensors"] = SPI_MAX_SENSORS;
+    JsonArray auxCs = doc.createNestedArray("aux_cs_pins");
+    for (int i = 0; i < MAX_SENSORS - 1; i++) {
+        auxCs.add(cfg.aux_cs_pins[i]);
+    }
     
     // Sensor
     doc["sensitivity"] = cfg.sensitivity;
@@ -264,8 +506,35 @@ String WebServer::_generateConfigJson() {
     // Sampling
     doc["sample_count"] = cfg.sample_count;
     doc["sample_rate_hz"] = cfg.sample_rate_hz;
+    doc["decimation"] = cfg.decimation;
     doc["filter_cutoff_hz"] = cfg.filter_cutoff_hz;
+    doc["filter_mode"] = cfg.filter_mode;
+    doc["pretrigger_pct"] = cfg.pretrigger_pct;
     doc["send_time_domain"] = cfg.send_time_domain;
+    doc["use_fifo"] = cfg.use_fifo;
+    doc["raw_capture"] = cfg.raw_capture;
+    
+    // Feature extraction
+    doc["send_features"] = cfg.send_features;
+    doc["send_spectrum"] = cfg.send_spectrum;
+    doc["welch_segment"] = cfg.welch_segment;
+    doc["welch_overlap_pct"] = cfg.welch_overlap_pct;
+    doc["zoom_center_hz"] = cfg.zoom_center_hz;
+    doc["zoom_factor"] = cfg.zoom_factor;
+    doc["baseline_alpha_pct"] = cfg.baseline_alpha_pct;
+    doc["changes_only"] = cfg.changes_only;
+    doc["change_threshold_pct"] = cfg.change_threshold_pct;
+    JsonArray edges = doc.createNestedArray("band_edges_hz");
+    for (int i = 0; i <= FEATURE_BANDS; i++) {
+        edges.add(cfg.band_edges_hz[i]);
+    }
+    
+    // Monitoring
+    doc["continuous_mode"] = cfg.continuous_mode;
+    doc["event_rms_mg"] = cfg.event_rms_mg;
+    doc["event_change_pct"] = cfg.event_change_pct;
+    doc["heartbeat_s"] = cfg.heartbeat_s;
+    doc["health_s"] = cfg.health_s;
     
     // Device info
     doc["device_id"] = configManager.getDeviceId();
@@ -294,7 +563,7 @@ void WebServer::_handlePostConfig(AsyncWebServerRequest* request, uint8_t* data,
 }
 
 bool WebServer::_parseConfigJson(const String& json) {
-    StaticJsonDocument<1024> doc;
+    StaticJsonDocument<1536> doc;
     DeserializationError error = deserializeJson(doc, json);
     
     if (error) {
@@ -325,6 +594,14 @@ bool WebServer::_parseConfigJson(const String& json) {
     if (doc.containsKey("influx_bucket")) {
         strlcpy(cfg.influx_bucket, doc["influx_bucket"], sizeof(cfg.influx_bucket));
     }
+    if (doc.containsKey("influx_gzip")) {
+        cfg.influx_gzip = doc["influx_gzip"];
+    }
+    if (doc.containsKey("spectrum_format")) {
+        uint8_t format = doc["spectrum_format"];
+        cfg.spectrum_format = format == SPECTRUM_FORMAT_PACKED ? SPECTRUM_FORMAT_PACKED
+                                                               : SPECTRUM_FORMAT_LINES;
+    }
     
     // Operation
     if (doc.containsKey("operation_id")) {
@@ -338,6 +615,20 @@ bool WebServer::_parseConfigJson(const String& json) {
     if (doc.containsKey("spi_cs_pin")) {
         cfg.spi_cs_pin = doc["spi_cs_pin"];
     }
+    if (doc.containsKey("adxl_int_pin")) {
+        cfg.adxl_int_pin = doc["adxl_int_pin"];
+    }
+    if (doc.containsKey("sensor_count")) {
+        uint8_t count = doc["sensor_count"];
+        cfg.sensor_count = constrain(count, 1, SPI_MAX_SENSORS);
+    }
+    if (doc.containsKey("aux_cs_pins")) {
+        // Missing entries keep their pin
+        JsonArray pins = doc["aux_cs_pins"];
+        for (int i = 0; i < MAX_SENSORS - 1 && i < (int)pins.size(); i++) {
+            cfg.aux_cs_pins[i] = pins[i];
+        }
+    }
     
     // Sensor
     if (doc.containsKey("sensitivity")) {
@@ -346,19 +637,119 @@ bool WebServer::_parseConfigJson(const String& json) {
     }
     
     // Sampling
+    if (doc.containsKey("raw_capture")) {
+        cfg.raw_capture = doc["raw_capture"];
+    }
     if (doc.containsKey("sample_count")) {
         cfg.sample_count = doc["sample_count"];
-        if (cfg.sample_count > MAX_SAMPLE_COUNT) cfg.sample_count = MAX_SAMPLE_COUNT;
+        size_t maxCount = cfg.raw_capture ? MAX_RAW_SAMPLE_COUNT : MAX_SAMPLE_COUNT;
+        if (cfg.sample_count > maxCount) cfg.sample_count = maxCount;
     }
     if (doc.containsKey("sample_rate_hz")) {
-        cfg.sample_rate_hz = doc["sample_rate_hz"];
+        // Snapped to the BW_RATE step the sensor will run at; rounded up,
+        // so 6.25 and 12.5 Hz map back to their own step
+        uint16_t requested = doc["sample_rate_hz"];
+        float odrHz = ADXL313::rateHzForCode(ADXL313::rateCodeForHz(requested));
+        cfg.sample_rate_hz = (uint16_t)ceilf(odrHz);
+        if (cfg.sample_rate_hz != requested) {
+            Serial.printf("[WebServer] Sample rate %u Hz is not an ODR step, using %.2f Hz\n",
+                          (unsigned)requested, odrHz);
+        }
+    }
+    if (doc.containsKey("decimation")) {
+        // Keep the stored rate at 1 Hz or more
+        uint8_t factor = doc["decimation"];
+        float odrHz = ADXL313::rateHzForCode(ADXL313::rateCodeForHz(cfg.sample_rate_hz));
+        uint8_t limit = odrHz < DECIMATION_MAX ? (uint8_t)odrHz : DECIMATION_MAX;
+        cfg.decimation = constrain(factor, 1, limit);
+        if (cfg.decimation != factor) {
+            Serial.printf("[WebServer] Decimation %u not supported, using %u\n",
+                          (unsigned)factor, (unsigned)cfg.decimation);
+        }
     }
     if (doc.containsKey("filter_cutoff_hz")) {
         cfg.filter_cutoff_hz = doc["filter_cutoff_hz"];
     }
+    if (doc.containsKey("filter_mode")) {
+        uint8_t mode = doc["filter_mode"];
+        cfg.filter_mode = mode == FILTER_MODE_STREAMING ? FILTER_MODE_STREAMING
+                                                        : FILTER_MODE_ZERO_PHASE;
+    }
+    if (doc.containsKey("pretrigger_pct")) {
+        uint8_t pct = doc["pretrigger_pct"];
+        cfg.pretrigger_pct = pct > PRETRIGGER_MAX_PCT ? PRETRIGGER_MAX_PCT : pct;
+    }
     if (doc.containsKey("send_time_domain")) {
         cfg.send_time_domain = doc["send_time_domain"];
     }
+    if (doc.containsKey("use_fifo")) {
+        cfg.use_fifo = doc["use_fifo"];
+    }
+    
+    // Feature extraction
+    if (doc.containsKey("send_features")) {
+        cfg.send_features = doc["send_features"];
+    }
+    if (doc.containsKey("send_spectrum")) {
+        cfg.send_spectrum = doc["send_spectrum"];
+    }
+    if (doc.containsKey("welch_segment")) {
+        // Anything but a power of 2 >= WELCH_MIN_SEGMENT turns Welch off
+        uint16_t seg = doc["welch_segment"];
+        bool valid = seg >= WELCH_MIN_SEGMENT && (seg & (seg - 1)) == 0;
+        cfg.welch_segment = valid ? seg : 0;
+    }
+    if (doc.containsKey("welch_overlap_pct")) {
+        uint8_t overlap = doc["welch_overlap_pct"];
+        cfg.welch_overlap_pct = overlap > WELCH_MAX_OVERLAP_PCT ? WELCH_MAX_OVERLAP_PCT : overlap;
+    }
+    if (doc.containsKey("zoom_center_hz")) {
+        cfg.zoom_center_hz = doc["zoom_center_hz"];
+    }
+    if (doc.containsKey("zoom_factor")) {
+        // Anything but a power of 2 in 2..ZOOM_MAX_FACTOR turns zoom off
+        uint8_t factor = doc["zoom_factor"];
+        bool valid = factor >= 2 && factor <= ZOOM_MAX_FACTOR && (factor & (factor - 1)) == 0;
+        cfg.zoom_factor = valid ? factor : 0;
+    }
+    if (doc.containsKey("baseline_alpha_pct")) {
+        uint8_t alpha = doc["baseline_alpha_pct"];
+        cfg.baseline_alpha_pct = alpha > 100 ? 100 : alpha;
+    }
+    if (doc.containsKey("changes_only")) {
+        cfg.changes_only = doc["changes_only"];
+    }
+    if (doc.containsKey("change_threshold_pct")) {
+        cfg.change_threshold_pct = doc["change_threshold_pct"];
+    }
+    if (doc.containsKey("band_edges_hz")) {
+        // Missing or out-of-order edges close the bands after them
+        JsonArray edges = doc["band_edges_hz"];
+        uint16_t prev = 0;
+        for (int i = 0; i <= FEATURE_BANDS; i++) {
+            uint16_t edge = i < (int)edges.size() ? edges[i].as<uint16_t>() : 0;
+            if (edge < prev) edge = prev;
+            cfg.band_edges_hz[i] = edge;
+            prev = edge;
+        }
+    }
+    
+    // Monitoring
+    if (doc.containsKey("continuous_mode")) {
+        cfg.continuous_mode = doc["continuous_mode"];
+    }
+    if (doc.containsKey("event_rms_mg")) {
+        cfg.event_rms_mg = doc["event_rms_mg"];
+    }
+    if (doc.containsKey("event_change_pct")) {
+        cfg.event_change_pct = doc["event_change_pct"];
+    }
+    if (doc.containsKey("heartbeat_s")) {
+        cfg.heartbeat_s = doc["heartbeat_s"];
+    }
+    if (doc.containsKey("health_s")) {
+        cfg.health_s = doc["health_s"];
+    }
     
     return true;
 }
@@ -390,6 +781,124 @@ void WebServer::_handleGetStatus(AsyncWebServerRequest* request) {
     request->send(200, "application/json", response);
 }
 
+void WebServer::_handleGetMetrics(AsyncWebServerRequest* request) {
+    MetricsSnapshot snap;
+    metrics.snapshot(snap);
+    StaticJsonDocument<2048> doc;
+    
+    doc["uptime_seconds"] = millis() / 1000;
+    doc["window_ms"] = snap.windowMs;
+    
+    JsonObject hist = doc.createNestedObject("histograms");
+    for (uint8_t m = 0; m < METRIC_HISTOGRAMS; m++) {
+        const HistogramSummary& s = snap.hist[m];
+        JsonObject h = hist.createNestedObject(Metrics::histogramName(m));
+        h["count"] = s.count;
+        h["min"] = s.min;
+        h["mean"] = s.mean;
+        h["p50"] = s.p50;
+        h["p90"] = s.p90;
+        h["p99"] = s.p99;
+        h["max"] = s.max;
+    }
+    
+    JsonObject counters = doc.createNestedObject("counters");
+    for (uint8_t c = 0; c < METRIC_COUNTERS; c++) {
+        counters[Metrics::counterName(c)] = snap.counters[c];
+    }
+    
+    JsonObject heap = doc.createNestedObject("heap");
+    heap["free"] = snap.heapFree;
+    heap["min_free"] = snap.heapMinFree;
+    heap["largest_block"] = snap.heapLargest;
+    heap["largest_block_min"] = snap.heapLargestMin;
+    
+    JsonObject stacks = doc.createNestedObject("stack_free");
+    for (uint8_t i = 0; i < snap.taskCount; i++) {
+        stacks[snap.taskName[i]] = snap.stackFree[i];
+    }
+    
+    // Milestones not reached yet are null
+    JsonObject boot = doc.createNestedObject("boot_ms");
+    for (uint8_t p = 0; p < BOOT_PHASES; p++) {
+        if (snap.bootMs[p] > 0) {
+            boot[Metrics::bootPhaseName(p)] = snap.bootMs[p];
+        } else {
+            boot[Metrics::bootPhaseName(p)] = nullptr;
+        }
+    }
+    
+    String response;
+    serializeJson(doc, response);
+    request->send(200, "application/json", response);
+}
+
+void WebServer::_handleRunDownload(AsyncWebServerRequest* request, bool csv) {
+    RunDownload* state = new (std::nothrow) RunDownload();
+    if (!state) {
+        request->send(503, "application/json", "{\"success\":false,\"message\":\"Out of memory\"}");
+        return;
+    }
+    std::shared_ptr<RunDownload> download(state);
+    
+    // The sample buffers hold the last processed run; ?source=journal
+    // (or no run this boot) takes the newest journaled one instead
+    bool journalOnly = request->hasParam("source") &&
+                       request->getParam("source")->value() == "journal";
+    if (!journalOnly && latestRun.acquire(download->run, download->generation)) {
+        download->source = RunDownload::SOURCE_BUFFER;
+    } else {
+        JournalRecord rec;
+        if (!runJournal.openNewest(download->file, rec)) {
+            request->send(404, "application/json", "{\"success\":false,\"message\":\"No run available\"}");
+            return;
+        }
+        download->source = RunDownload::SOURCE_JOURNAL;
+        download->run.sequence = rec.sequence;
+        download->run.sensor = rec.sensor;
+        download->run.epochNs = rec.epochNs;
+        download->run.odrHz = rec.odrHz;
+        download->run.scale = rec.scale;
+        download->run.frames = rec.timeFrames;
+        if (rec.timeFrames == 0) {
+            request->send(404, "application/json",
+                          "{\"success\":false,\"message\":\"Journaled run has no time-domain data\"}");
+            return;
+        }
+    }
+    
+    if (csv) {
+        download->lineLen = strlcpy(download->line, CSV_HEADER, sizeof(download->line));
+    }
+    
+    AsyncWebServerResponse* response = request->beginChunkedResponse(
+        csv ? "text/csv" : "application/octet-stream",
+        [download, csv](uint8_t* buffer, size_t maxLen, size_t index) -> size_t {
+            return csv ? download->fillCsv(buffer, maxLen)
+                       : download->fillBinary(buffer, maxLen, index);
+        });
+    
+    const RetainedRun& run = download->run;
+    char value[64];
+    snprintf(value, sizeof(value), "attachment; filename=\"run-%lu-%u.%s\"",
+             (unsigned long)run.sequence, run.sensor, csv ? "csv" : "bin");
+    response->addHeader("Content-Disposition", value);
+    response->addHeader("X-Source", download->source == RunDownload::SOURCE_JOURNAL ? "journal" : "buffer");
+    response->addHeader("X-Run-Sequence", String(run.sequence));
+    response->addHeader("X-Sensor", String(run.sensor));
+    response->addHeader("X-Frames", String((unsigned long)run.frames));
+    response->addHeader("X-Odr-Hz", String(run.odrHz, 3));
+    snprintf(value, sizeof(value), "%.9e", run.scale);
+    response->addHeader("X-Scale-G", value);
+    snprintf(value, sizeof(value), "%llu", (unsigned long long)run.epochNs);
+    response->addHeader("X-Start-Ns", value);
+    request->send(response);
+    
+    Serial.printf("[WebServer] Streaming run %lu (%d frames) as %s from the %s\n",
+                  (unsigned long)run.sequence, run.frames, csv ? "CSV" : "binary",
+                  download->source == RunDownload::SOURCE_JOURNAL ? "journal" : "sample buffer");
+}
+
 void WebServer::_handleReset(AsyncWebServerRequest* request) {
     configManager.resetToDefaults();
     configManager.save();
@@ -3,6 +3,39 @@
 
 #include <Arduino.h>
 #include <ESPAsyncWebServer.h>
+#include "config.h"
+#include "acquisition.h"
+#include "feature_extraction.h"
+
+/**
+ * @brief Header of one binary live-view frame, little-endian
+ *
+ * Followed by bins uint16 magnitudes for X, then Y, then Z; magnitude
+ * of value v on axis a is v * scale[a]. Output bin j covers the
+ * spectrum from startHz + j * binHz, each the largest of the bins it
+ * merges, and DC is left out as in the packed upload format.
+ */
+struct LiveFrameHeader {
+    uint32_t magic;             // LIVE_FRAME_MAGIC
+    uint32_t sequence;          // RunInfo::sequence
+    uint8_t sensor;             // RunInfo::sensor
+    uint8_t reason;             // TriggerReason
+    uint16_t bins;              // Magnitudes per axis
+    float startHz;              // Frequency of the first output bin
+    float binHz;                // Spacing of the output bins
+    float odrHz;                // Measured sample rate
+    float features[3][5];       // Per axis: rms, peak, crest, kurtosis, velocity RMS
+    float scale[3];             // Magnitude per LSB
+};
+static_assert(sizeof(LiveFrameHeader) == 96, "Live frame layout is shared with script.js");
+
+/**
+ * @brief A live-view frame as handed from the processing task to loop()
+ */
+struct LiveFrame {
+    size_t len;                 // Bytes of data in use
+    uint8_t data[sizeof(LiveFrameHeader) + 3 * LIVE_SPECTRUM_BINS * sizeof(uint16_t)];
+};
 
 /**
  * @brief Async web server for device configuration
@@ -37,10 +70,50 @@ public:
      */
     void updateStatus(unsigned long lastTriggerTime, size_t sampleCount, bool influxOk);
     
+    /**
+     * @brief Queue a processed run for the live-view WebSocket clients
+     *
+     * Builds the frame only; loop() sends it, so every WebSocket call
+     * stays on one task. Does nothing without clients, and a frame not
+     * sent yet is replaced by the newer one.
+     * @param run Run descriptor
+     * @param features Features of the run
+     * @param spectra Magnitudes per axis (X, Y, Z)
+     * @param freqHz Frequency of each bin
+     * @param numBins Bins per axis
+     * @param odrHz Measured sample rate
+     */
+    void publishRun(const RunInfo& run, const RunFeatures& features,
+                    const float* const spectra[3], const float* freqHz,
+                    size_t numBins, float odrHz);
+    
+    /**
+     * @brief Send the queued live frame and release closed WebSocket
+     *        clients (call in loop)
+     *
+     * A frame is skipped if any client is still sending the previous one.
+     */
+    void loop();
+    
 private:
     AsyncWebServer* _server = nullptr;
+    AsyncWebSocket* _live = nullptr;
+    
+    // Live frames, built by the processing task and sent from loop()
+    QueueHandle_t _liveQueue = nullptr;     // One slot, overwritten
+    volatile uint32_t _liveClients = 0;     // Client count as of the last loop()
+    LiveFrame _liveBuild;                   // Processing task side
+    LiveFrame _liveSend;                    // loop() side
     void (*_triggerCallback)() = nullptr;
     
+    // Gzipped UI files with their content hashes, from WEB_ETAG_FILE
+    struct Asset {
+        char path[32];          // URL path; the file is path + ".gz"
+        char etag[12];          // Quoted hash
+    };
+    Asset _assets[WEB_MAX_ASSETS];
+    size_t _assetCount = 0;
+    
     // Status tracking
     unsigned long _lastTriggerTime = 0;
     size_t _lastSampleCount = 0;
@@ -53,11 +126,17 @@ private:
     void _handleGetConfig(AsyncWebServerRequest* request);
     void _handlePostConfig(AsyncWebServerRequest* request, uint8_t* data, size_t len);
     void _handleGetStatus(AsyncWebServerRequest* request);
+    void _handleGetMetrics(AsyncWebServerRequest* request);
     void _handleReset(AsyncWebServerRequest* request);
     void _handleTrigger(AsyncWebServerRequest* request);
     void _handleCaptivePortal(AsyncWebServerRequest* request);
+    void _handleRunDownload(AsyncWebServerRequest* request, bool csv);
+    void _handleLiveEvent(AsyncWebSocket* server, AsyncWebSocketClient* client,
+                          AwsEventType type);
     
     // Helpers
+    void _loadAssets();
+    void _serveAsset(AsyncWebServerRequest* request, const Asset& asset);
     String _generateConfigJson();
     bool _parseConfigJson(const String& json);
 };
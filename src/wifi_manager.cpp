@@ -1,11 +1,12 @@
 #include "wifi_manager.h"
 #include "config_manager.h"
+#include "metrics.h"
 #include <time.h>
 
 // DNS server port
 static const uint16_t DNS_PORT = 53;
 static const time_t MIN_VALID_EPOCH = 1700000000;   // Approx. 2023-11-14 UTC
-static const uint32_t TIME_SYNC_RETRY_MS = 30000;
+static const uint32_t TIME_SYNC_REPORT_MS = 30000;  // "not ready" log interval
 
 static bool isSystemTimeValid() {
     return time(nullptr) >= MIN_VALID_EPOCH;
@@ -15,12 +16,14 @@ static bool isSystemTimeValid() {
 WiFiManager wifiManager;
 
 void WiFiManager::begin() {
-    WiFi.mode(WIFI_OFF);
-    delay(100);
-    
+    // Returns right away; connecting, the AP fallback and SNTP all
+    // proceed from loop()
     Serial.println("[WiFi] Initializing...");
     
     _timeSynced = isSystemTimeValid();
+    if (_timeSynced) {
+        metrics.markBoot(BOOT_TIME);
+    }
 
     // Check if WiFi is configured
     if (configManager.isWifiConfigured()) {
@@ -90,6 +93,7 @@ void WiFiManager::_handleConnection() {
                 Serial.printf("[WiFi] Connected! IP: %s\n", WiFi.localIP().toString().c_str());
                 Serial.printf("[WiFi] RSSI: %d dBm\n", WiFi.RSSI());
                 _state = State::CONNECTED_STATION;
+                metrics.markBoot(BOOT_WIFI);
                 _syncTimeIfNeeded();
             } else if (millis() - _connectStartTime > WIFI_CONNECT_TIMEOUT_MS) {
                 _connectAttempts++;
@@ -116,7 +120,7 @@ void WiFiManager::_handleConnection() {
                 _connectStartTime = millis();
                 _connectAttempts = 0;
                 WiFi.reconnect();
-            } else if (!hasValidTime() && (millis() - _lastTimeSyncAttemptMs) > TIME_SYNC_RETRY_MS) {
+            } else if (!_timeSynced) {
                 _syncTimeIfNeeded();
             }
             break;
@@ -180,41 +184,59 @@ bool WiFiManager::syncTime(uint32_t timeoutMs) {
     }
 
     if (hasValidTime()) {
-        _timeSynced = true;
+        _onTimeValid();
+        return true;
+    }
+
+    _configureSntp();
+
+    struct tm timeinfo;
+    if (getLocalTime(&timeinfo, timeoutMs)) {
+        _onTimeValid();
         return true;
     }
 
+    Serial.println("[WiFi] SNTP sync not ready yet");
+    return false;
+}
+
+void WiFiManager::_configureSntp() {
     if (!_ntpConfigured) {
+        // The SNTP client keeps polling the servers in the background
         configTzTime("UTC0", "pool.ntp.org", "time.google.com", "time.windows.com");
         _ntpConfigured = true;
+        _lastTimeSyncAttemptMs = millis();
         Serial.println("[WiFi] SNTP configured");
     }
+}
 
-    _lastTimeSyncAttemptMs = millis();
+void WiFiManager::_onTimeValid() {
+    if (_timeSynced) return;
+    _timeSynced = true;
+    metrics.markBoot(BOOT_TIME);
 
     struct tm timeinfo;
-    if (getLocalTime(&timeinfo, timeoutMs)) {
-        _timeSynced = true;
+    if (getLocalTime(&timeinfo, 0)) {
         Serial.printf("[WiFi] Time synchronized: %04d-%02d-%02d %02d:%02d:%02d UTC\n",
                       timeinfo.tm_year + 1900, timeinfo.tm_mon + 1, timeinfo.tm_mday,
                       timeinfo.tm_hour, timeinfo.tm_min, timeinfo.tm_sec);
-        return true;
-    }
-
-    _timeSynced = hasValidTime();
-    if (!_timeSynced) {
-        Serial.println("[WiFi] SNTP sync not ready yet");
     }
-    return _timeSynced;
 }
 
 void WiFiManager::_syncTimeIfNeeded() {
-    if (_state != State::CONNECTED_STATION) {
+    if (_state != State::CONNECTED_STATION || _timeSynced) {
         return;
     }
     if (hasValidTime()) {
-        _timeSynced = true;
+        _onTimeValid();
         return;
     }
-    syncTime();
+    
+    // Polled from loop() instead of waiting for the reply, so the loop
+    // (DNS, web clients) keeps running while the servers answer
+    _configureSntp();
+    if (millis() - _lastTimeSyncAttemptMs > TIME_SYNC_REPORT_MS) {
+        _lastTimeSyncAttemptMs = millis();
+        Serial.println("[WiFi] SNTP sync not ready yet");
+    }
 }
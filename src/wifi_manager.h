@@ -88,7 +88,10 @@ public:
 
     /**
      * @brief Attempt SNTP time synchronization
-     * @param timeoutMs Timeout waiting for sync
+     *
+     * loop() already syncs in the background once connected; this only
+     * adds a wait for the result.
+     * @param timeoutMs Timeout waiting for sync, 0 to just check
      * @return true if valid time is available after sync attempt
      */
     bool syncTime(uint32_t timeoutMs = 8000);
@@ -109,6 +112,8 @@ private:
     void _startDNS();
     void _stopDNS();
     void _syncTimeIfNeeded();
+    void _configureSntp();
+    void _onTimeValid();
 };
 
 // Global instance